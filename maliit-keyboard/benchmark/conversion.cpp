@@ -0,0 +1,164 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+// Types input through Logic::ConversionLattice, one input unit per keystroke,
+// and reports conversion latency percentiles per keystroke. Inputs are
+// synthesized by concatenating random input codes of the compiled lexicon.
+// For comparison, the same input is also converted with a fresh lattice on
+// every keystroke.
+//
+// Usage: maliit-keyboard-conversion-benchmark lexicon.lexicon [inputs] [codes per input]
+
+#include "logic/chineselexicon.h"
+#include "logic/conversionlattice.h"
+
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const int MaxCandidates = 7;
+// Per keystroke budget of the conversion engine:
+const qint64 KeystrokeBudget = 5000000;
+
+qreal percentile(const QVector<qint64> &sorted,
+                 int percent)
+{
+    return sorted.at(qMin(sorted.count() - 1, sorted.count() * percent / 100)) / 1e3;
+}
+
+//! Types every input, one unit at a time, and records the latency of each
+//! keystroke. An incremental lattice is kept per input, otherwise each
+//! keystroke starts from scratch.
+QVector<qint64> typeInputs(const Logic::ChineseLexiconReader &reader,
+                           const QStringList &inputs,
+                           bool incremental)
+{
+    QVector<qint64> latencies;
+    QElapsedTimer timer;
+
+    Q_FOREACH (const QString &input, inputs) {
+        Logic::ConversionLattice lattice;
+
+        for (int length(1); length <= input.length(); ++length) {
+            timer.start();
+
+            if (not incremental) {
+                lattice.reset();
+            }
+
+            lattice.setInput(&reader, input.left(length));
+            (void) lattice.candidates(MaxCandidates);
+            latencies.append(timer.nsecsElapsed());
+        }
+    }
+
+    qSort(latencies);
+    return latencies;
+}
+
+void report(const char *title,
+            const QVector<qint64> &latencies)
+{
+    int over_budget(0);
+    Q_FOREACH (qint64 latency, latencies) {
+        over_budget += (latency > KeystrokeBudget) ? 1 : 0;
+    }
+
+    qDebug("%s: p50 %f us, p90 %f us, p99 %f us, max %f us, over 5 ms: %d of %d",
+           title, percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99),
+           latencies.last() / 1e3, over_budget, latencies.count());
+}
+
+} // anonymous namespace
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        qDebug("Usage: %s lexicon.lexicon [inputs] [codes per input]", argv[0]);
+        return 1;
+    }
+
+    int input_count(200);
+    int codes_per_input(6);
+
+    if (argc > 2) {
+        input_count = qMax(1, std::atoi(argv[2]));
+    }
+
+    if (argc > 3) {
+        codes_per_input = qMax(1, std::atoi(argv[3]));
+    }
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    uchar *data(file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : 0);
+
+    if (not data) {
+        qDebug("Could not map lexicon '%s'.", argv[1]);
+        return 1;
+    }
+
+    const Logic::ChineseLexiconReader reader(data, file.size());
+
+    if (not reader.isValid() or reader.codeCount() == 0) {
+        qDebug("Invalid or empty lexicon: %s", qPrintable(reader.errorString()));
+        return 1;
+    }
+
+    QStringList inputs;
+    int keystrokes(0);
+    qsrand(1);
+
+    for (int index(0); index < input_count; ++index) {
+        QString input;
+
+        for (int code(0); code < codes_per_input; ++code) {
+            input.append(reader.codeText(qrand() % reader.codeCount()));
+        }
+
+        inputs.append(input);
+        keystrokes += input.length();
+    }
+
+    qDebug("Typed %d inputs, %d keystrokes.", inputs.count(), keystrokes);
+    report("Incremental lattice", typeInputs(reader, inputs, true));
+    report("Fresh lattice", typeInputs(reader, inputs, false));
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compares spelling correction through the compiled word list and key
+// proximity ranking (Logic::DawgReader, Logic::ProximityCorrector) against
+// Hunspell suggestions. Typos replace one character of 5 to 8 letter words
+// from the word list by the character of a neighbouring key on the en_gb
+// layout. The spell checker cache is cleared each round.
+//
+// Usage: maliit-keyboard-correction-benchmark dictionary.dawg [rounds] [style profile]
+
+#include "logic/dawg.h"
+#include "logic/keyareaconverter.h"
+#include "logic/keyboardloader.h"
+#include "logic/proximitycorrector.h"
+#include "logic/spellchecker.h"
+#include "logic/style.h"
+#include "models/keyarea.h"
+
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const int MaxWords = 1000;
+const int MaxPool = 64;
+const int MaxSuggestions = 5;
+
+//! @returns a lower case character whose key is next to the key of character.
+QChar neighbour(const Logic::ProximityCorrector &corrector,
+                const QString &alphabet,
+                const QChar &character)
+{
+    QChar result(character);
+    int best(Logic::ProximityCorrector::EditCost + 1);
+
+    Q_FOREACH (const QChar &other, alphabet) {
+        const int cost(corrector.substitutionCost(character, other));
+
+        if (other != character && cost < best) {
+            best = cost;
+            result = other;
+        }
+    }
+
+    return result;
+}
+
+//! Corrects typo the way DawgWordEngine does.
+QStringList correct(const Logic::DawgReader &reader,
+                    const Logic::ProximityCorrector &corrector,
+                    const QString &typo)
+{
+    const Logic::DawgMatchList &matches(reader.lookup(typo, 2, MaxPool));
+    QStringList words;
+
+    Q_FOREACH (const Logic::DawgMatch &match, matches) {
+        words.append(match.word);
+    }
+
+    const QVector<int> &distances(corrector.distances(typo, words));
+    QMultiMap<int, QString> ranked;
+
+    for (int index(0); index < words.count(); ++index) {
+        ranked.insert(distances.at(index), words.at(index));
+    }
+
+    return ranked.values().mid(0, MaxSuggestions);
+}
+
+} // anonymous namespace
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        qDebug("Usage: %s dictionary.dawg [rounds] [style profile]", argv[0]);
+        return 1;
+    }
+
+    int rounds(5);
+    QString profile("nokia-n9");
+
+    if (argc > 2) {
+        rounds = qMax(1, std::atoi(argv[2]));
+    }
+
+    if (argc > 3) {
+        profile = QString::fromLocal8Bit(argv[3]);
+    }
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    uchar *data(file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : 0);
+
+    if (not data) {
+        qDebug("Could not map dictionary '%s'.", argv[1]);
+        return 1;
+    }
+
+    const Logic::DawgReader reader(data, file.size());
+
+    if (not reader.isValid()) {
+        qDebug("Invalid dictionary: %s", qPrintable(reader.errorString()));
+        return 1;
+    }
+
+    Style style;
+    style.setProfile(profile);
+
+    KeyboardLoader loader;
+    loader.setActiveId("en_gb");
+
+    Logic::KeyAreaConverter converter(style.attributes(), &loader);
+    converter.setLayoutOrientation(Logic::LayoutHelper::Portrait);
+
+    const KeyArea key_area(converter.keyArea());
+
+    if (key_area.keys().isEmpty()) {
+        qDebug("No key area found, is the style profile '%s' installed?", qPrintable(profile));
+        return 1;
+    }
+
+    Logic::ProximityCorrector corrector;
+    corrector.setKeyArea(key_area);
+
+    const QString alphabet("abcdefghijklmnopqrstuvwxyz");
+    QStringList typos;
+    qsrand(1);
+
+    Q_FOREACH (const Logic::DawgMatch &match, reader.complete(QString(), MaxWords * 10)) {
+        const QString &word(match.word);
+
+        if (word.length() < 5 || word.length() > 8 || word.toLower() != word) {
+            continue;
+        }
+
+        QString typo(word);
+        const int position(qrand() % word.length());
+        typo[position] = neighbour(corrector, alphabet, word.at(position));
+        typos.append(typo);
+
+        if (typos.count() >= MaxWords) {
+            break;
+        }
+    }
+
+    if (typos.isEmpty()) {
+        qDebug("No 5 to 8 letter words found in dictionary.");
+        return 1;
+    }
+
+    Logic::SpellChecker spell_checker;
+
+    qint64 proximity_time(0);
+    qint64 hunspell_time(0);
+    int proximity_suggestions(0);
+    int hunspell_suggestions(0);
+    QElapsedTimer timer;
+
+    for (int round(0); round < rounds; ++round) {
+        timer.start();
+        Q_FOREACH (const QString &typo, typos) {
+            proximity_suggestions += correct(reader, corrector, typo).count();
+        }
+        proximity_time += timer.nsecsElapsed();
+
+        spell_checker.clearCache();
+
+        timer.start();
+        Q_FOREACH (const QString &typo, typos) {
+            hunspell_suggestions += spell_checker.suggest(typo, MaxSuggestions).count();
+        }
+        hunspell_time += timer.nsecsElapsed();
+    }
+
+    const double corrections(double(rounds) * typos.count());
+
+    qDebug("Corrected %d typos, %d rounds.", typos.count(), rounds);
+    qDebug("Proximity: average %f us per typo, %f suggestions, total time %f ms",
+           proximity_time / corrections / 1e3, proximity_suggestions / corrections, proximity_time / 1e6);
+    qDebug("Hunspell:  average %f us per typo, %f suggestions, total time %f ms",
+           hunspell_time / corrections / 1e3, hunspell_suggestions / corrections, hunspell_time / 1e6);
+    qDebug("Speedup: %f", proximity_time > 0 ? double(hunspell_time) / proximity_time : 0.0);
+
+    return 0;
+}
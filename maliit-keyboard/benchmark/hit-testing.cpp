@@ -0,0 +1,182 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compares hit testing through the spatial index of Logic::keyHit against a
+// linear scan over all keys. Uses the symbols views of the zhuyin layout,
+// which hold the most keys of all shipped layouts.
+//
+// Usage: maliit-keyboard-hit-benchmark [rounds] [style profile]
+
+#include "logic/hitlogic.h"
+#include "logic/keyareaconverter.h"
+#include "logic/keyboardloader.h"
+#include "logic/style.h"
+#include "models/keyarea.h"
+
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const int PointsPerKeyArea = 10000;
+const int MaxSymbolPages = 8;
+
+Key linearKeyHit(const QVector<Key> &keys,
+                 const QRect &geometry,
+                 const QPoint &pos)
+{
+    if (geometry.contains(pos)) {
+        Q_FOREACH (const Key &current, keys) {
+            if (current.rect().translated(geometry.topLeft()).contains(pos)) {
+                return current;
+            }
+        }
+    }
+
+    return Key();
+}
+
+} // anonymous namespace
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+    int rounds(20);
+    QString profile("nokia-n9");
+
+    if (argc > 1) {
+        rounds = qMax(1, std::atoi(argv[1]));
+    }
+
+    if (argc > 2) {
+        profile = QString::fromLocal8Bit(argv[2]);
+    }
+
+    Style style;
+    style.setProfile(profile);
+
+    KeyboardLoader loader;
+    loader.setActiveId("zh_cn_zhuyin");
+
+    Logic::KeyAreaConverter converter(style.attributes(), &loader);
+    converter.setLayoutOrientation(Logic::LayoutHelper::Portrait);
+
+    QList<KeyArea> key_areas;
+    int key_count(0);
+
+    // Symbol pages wrap around, stop at the first repeated page.
+    for (int page(0); page < MaxSymbolPages; ++page) {
+        const KeyArea key_area(converter.symbolsKeyArea(page));
+
+        if (key_area.keys().isEmpty() || key_area.rect().isEmpty()
+            || (page > 0 && key_area == key_areas.first())) {
+            break;
+        }
+
+        key_areas.append(key_area);
+        key_count += key_area.keys().count();
+    }
+
+    if (key_areas.isEmpty()) {
+        qDebug("No key areas found, is the style profile '%s' installed?", qPrintable(profile));
+        return 1;
+    }
+
+    QList<QVector<QPoint> > points;
+    qsrand(1);
+
+    Q_FOREACH (const KeyArea &key_area, key_areas) {
+        const QRect geometry(QPoint(), key_area.rect().size());
+        QVector<QPoint> area_points;
+
+        for (int index(0); index < PointsPerKeyArea; ++index) {
+            area_points.append(QPoint(qrand() % qMax(1, geometry.width()),
+                                      qrand() % qMax(1, geometry.height())));
+        }
+
+        points.append(area_points);
+    }
+
+    qint64 linear_time(0);
+    qint64 indexed_time(0);
+    int mismatches(0);
+    QElapsedTimer timer;
+
+    for (int round(0); round < rounds; ++round) {
+        for (int area(0); area < key_areas.count(); ++area) {
+            const QVector<Key> &keys(key_areas.at(area).keys());
+            const QRect geometry(QPoint(), key_areas.at(area).rect().size());
+            const QVector<QPoint> &area_points(points.at(area));
+
+            timer.start();
+            Q_FOREACH (const QPoint &pos, area_points) {
+                linearKeyHit(keys, geometry, pos);
+            }
+            linear_time += timer.nsecsElapsed();
+
+            timer.start();
+            Q_FOREACH (const QPoint &pos, area_points) {
+                Logic::keyHit(keys, geometry, pos);
+            }
+            indexed_time += timer.nsecsElapsed();
+
+            if (round == 0) {
+                Q_FOREACH (const QPoint &pos, area_points) {
+                    if (Logic::keyHit(keys, geometry, pos) != linearKeyHit(keys, geometry, pos)) {
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+    }
+
+    const double lookups(double(rounds) * key_areas.count() * PointsPerKeyArea);
+
+    qDebug("Hit tested %d key areas with %d keys in total, %d rounds.",
+           key_areas.count(), key_count, rounds);
+    qDebug("Linear:  average %f us per lookup, total time %f ms",
+           linear_time / lookups / 1e3, linear_time / 1e6);
+    qDebug("Indexed: average %f us per lookup, total time %f ms",
+           indexed_time / lookups / 1e3, indexed_time / 1e6);
+    qDebug("Speedup: %f", indexed_time > 0 ? double(linear_time) / indexed_time : 0.0);
+
+    if (mismatches > 0) {
+        qDebug("Indexed and linear lookup disagreed %d times!", mismatches);
+        return 1;
+    }
+
+    return 0;
+}
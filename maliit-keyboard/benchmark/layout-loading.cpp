@@ -0,0 +1,169 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compares loading language layouts from XML files against loading their
+// compiled, memory mapped form. Every round loads each layout from scratch,
+// bypassing the layout cache of KeyboardLoader.
+//
+// Usage: maliit-keyboard-layout-benchmark [rounds]
+
+#include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
+#include "coreutils.h"
+
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+bool loadXml(const QString &path)
+{
+    QFile file(path);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    LayoutParser parser(&file);
+    return parser.parse();
+}
+
+bool loadBlob(const QString &path)
+{
+    QFile file(path);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    const qint64 size(file.size());
+    uchar *data(file.map(0, size));
+
+    if (not data) {
+        return false;
+    }
+
+    LayoutBlobReader reader(data, size);
+    const bool result(reader.read());
+
+    file.unmap(data);
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+    int rounds(20);
+
+    if (argc > 1) {
+        rounds = qMax(1, std::atoi(argv[1]));
+    }
+
+    const QDir languages_dir(CoreUtils::pluginDataDirectory() + "/languages",
+                             "*.xml", QDir::Name, QDir::Files | QDir::Readable);
+    const QFileInfoList xml_files(languages_dir.entryInfoList());
+    QTemporaryDir blob_dir;
+    QStringList xml_paths;
+    QStringList blob_paths;
+
+    if (not blob_dir.isValid()) {
+        qDebug("Could not create temporary directory.");
+        return 1;
+    }
+
+    Q_FOREACH (const QFileInfo &file_info, xml_files) {
+        QFile file(file_info.filePath());
+
+        if (not file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        LayoutParser parser(&file);
+
+        if (not parser.parse()) {
+            continue;
+        }
+
+        QFile blob(blob_dir.path() + "/" + file_info.completeBaseName() + LayoutBlob::fileSuffix());
+
+        if (blob.open(QIODevice::WriteOnly)) {
+            blob.write(LayoutBlob::compile(parser));
+            xml_paths.append(file_info.filePath());
+            blob_paths.append(blob.fileName());
+        }
+    }
+
+    const int count(xml_paths.size());
+
+    if (count == 0) {
+        qDebug("No language files found.");
+        return 1;
+    }
+
+    qint64 xml_time(0);
+    qint64 blob_time(0);
+    QElapsedTimer timer;
+
+    for (int round(0); round < rounds; ++round) {
+        timer.start();
+        Q_FOREACH (const QString &path, xml_paths) {
+            loadXml(path);
+        }
+        xml_time += timer.nsecsElapsed();
+
+        timer.start();
+        Q_FOREACH (const QString &path, blob_paths) {
+            loadBlob(path);
+        }
+        blob_time += timer.nsecsElapsed();
+    }
+
+    const double loads(double(rounds) * count);
+
+    qDebug("Loaded %d layouts %d times.", count, rounds);
+    qDebug("XML:      average %f ms per layout, total time %f ms",
+           xml_time / loads / 1e6, xml_time / 1e6);
+    qDebug("Compiled: average %f ms per layout, total time %f ms",
+           blob_time / loads / 1e6, blob_time / 1e6);
+    qDebug("Speedup: %f", blob_time > 0 ? double(xml_time) / blob_time : 0.0);
+
+    return 0;
+}
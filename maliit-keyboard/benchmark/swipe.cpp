@@ -0,0 +1,222 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Replays swipe paths through Logic::SwipeDecoder and reports decode latency
+// percentiles. Paths are synthesized from the most frequent words of the
+// compiled word list: they connect the key centers of the en_gb layout, with
+// every corner displaced randomly by up to a quarter key.
+//
+// Usage: maliit-keyboard-swipe-benchmark dictionary.dawg [rounds] [style profile]
+
+#include "logic/dawg.h"
+#include "logic/keyareaconverter.h"
+#include "logic/keyboardloader.h"
+#include "logic/style.h"
+#include "logic/swipedecoder.h"
+#include "models/keyarea.h"
+
+#include <cstdlib>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+
+using namespace MaliitKeyboard;
+
+namespace {
+
+const int MaxWords = 500;
+const int PointsPerStroke = 10;
+const int MaxCandidates = 7;
+// One frame at 60 Hz:
+const qint64 FrameBudget = 16666667;
+
+//! @returns a swipe path over the keys of word, or an empty path if a
+//!          character has no key.
+QVector<QPointF> pathOf(const QString &word,
+                        const QHash<QChar, QPointF> &centers,
+                        qreal key_width)
+{
+    QVector<QPointF> corners;
+    QVector<QPointF> result;
+
+    Q_FOREACH (const QChar &character, word) {
+        if (not centers.contains(character)) {
+            return result;
+        }
+
+        const qreal jitter(key_width / 4);
+        corners.append(centers.value(character)
+                       + QPointF(jitter * (qrand() % 201 - 100) / 100,
+                                 jitter * (qrand() % 201 - 100) / 100));
+    }
+
+    for (int index(1); index < corners.count(); ++index) {
+        for (int point(0); point < PointsPerStroke; ++point) {
+            const qreal t(qreal(point) / PointsPerStroke);
+            result.append(corners.at(index - 1) * (1 - t) + corners.at(index) * t);
+        }
+    }
+
+    result.append(corners.last());
+    return result;
+}
+
+qreal percentile(const QVector<qint64> &sorted,
+                 int percent)
+{
+    return sorted.at(qMin(sorted.count() - 1, sorted.count() * percent / 100)) / 1e3;
+}
+
+} // anonymous namespace
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc < 2) {
+        qDebug("Usage: %s dictionary.dawg [rounds] [style profile]", argv[0]);
+        return 1;
+    }
+
+    int rounds(5);
+    QString profile("nokia-n9");
+
+    if (argc > 2) {
+        rounds = qMax(1, std::atoi(argv[2]));
+    }
+
+    if (argc > 3) {
+        profile = QString::fromLocal8Bit(argv[3]);
+    }
+
+    QFile file(QString::fromLocal8Bit(argv[1]));
+    uchar *data(file.open(QIODevice::ReadOnly) ? file.map(0, file.size()) : 0);
+
+    if (not data) {
+        qDebug("Could not map dictionary '%s'.", argv[1]);
+        return 1;
+    }
+
+    const Logic::DawgReader reader(data, file.size());
+
+    if (not reader.isValid()) {
+        qDebug("Invalid dictionary: %s", qPrintable(reader.errorString()));
+        return 1;
+    }
+
+    Style style;
+    style.setProfile(profile);
+
+    KeyboardLoader loader;
+    loader.setActiveId("en_gb");
+
+    Logic::KeyAreaConverter converter(style.attributes(), &loader);
+    converter.setLayoutOrientation(Logic::LayoutHelper::Portrait);
+
+    const KeyArea key_area(converter.keyArea());
+    QHash<QChar, QPointF> centers;
+    qreal key_width(0);
+
+    Q_FOREACH (const Key &key, key_area.keys()) {
+        if (key.action() == Key::ActionInsert && key.label().text().length() == 1) {
+            centers.insert(key.label().text().at(0), QRectF(key.rect()).center());
+            key_width = qMax<qreal>(key_width, key.rect().width());
+        }
+    }
+
+    if (centers.isEmpty()) {
+        qDebug("No key area found, is the style profile '%s' installed?", qPrintable(profile));
+        return 1;
+    }
+
+    Logic::SwipeDecoder decoder;
+    decoder.setKeyArea(key_area);
+
+    QStringList words;
+    QList<QVector<QPointF> > paths;
+    qsrand(1);
+
+    Q_FOREACH (const Logic::DawgMatch &match, reader.complete(QString(), MaxWords * 4)) {
+        const QVector<QPointF> path(match.word.length() > 1 ? pathOf(match.word, centers, key_width)
+                                                            : QVector<QPointF>());
+
+        if (not path.isEmpty()) {
+            words.append(match.word);
+            paths.append(path);
+        }
+
+        if (words.count() >= MaxWords) {
+            break;
+        }
+    }
+
+    if (words.isEmpty()) {
+        qDebug("No words found that can be swiped on en_gb.");
+        return 1;
+    }
+
+    QVector<qint64> latencies;
+    int first_hits(0);
+    int hits(0);
+    QElapsedTimer timer;
+
+    for (int round(0); round < rounds; ++round) {
+        for (int index(0); index < paths.count(); ++index) {
+            timer.start();
+            const QStringList &candidates(decoder.decode(reader, paths.at(index), MaxCandidates));
+            latencies.append(timer.nsecsElapsed());
+
+            if (round == 0) {
+                first_hits += (not candidates.isEmpty() && candidates.first() == words.at(index)) ? 1 : 0;
+                hits += candidates.contains(words.at(index)) ? 1 : 0;
+            }
+        }
+    }
+
+    qSort(latencies);
+
+    int over_budget(0);
+    Q_FOREACH (qint64 latency, latencies) {
+        over_budget += (latency > FrameBudget) ? 1 : 0;
+    }
+
+    qDebug("Decoded %d swipes, %d rounds.", words.count(), rounds);
+    qDebug("Latency: p50 %f us, p90 %f us, p99 %f us, max %f us",
+           percentile(latencies, 50), percentile(latencies, 90), percentile(latencies, 99),
+           latencies.last() / 1e3);
+    qDebug("Over one frame: %d of %d", over_budget, latencies.count());
+    qDebug("Word found first: %f%%, among candidates: %f%%",
+           100.0 * first_hits / words.count(), 100.0 * hits / words.count());
+
+    return 0;
+}
@@ -83,4 +83,18 @@ QString idFromKey(const Key &key)
     }
 }
 
+//! Returns word with its first letter upper cased, if capitalize is set, so
+//! that candidates follow a capitalized preedit.
+QString capitalized(const QString &word,
+                    bool capitalize)
+{
+    QString result(word);
+
+    if (not result.isEmpty() && capitalize) {
+        result[0] = result.at(0).toUpper();
+    }
+
+    return result;
+}
+
 }} // namespace CoreUtils, MaliitKeyboard
@@ -43,6 +43,8 @@ const QString &pluginDataDirectory();
 const QString &maliitKeyboardDataDirectory();
 const QString &maliitKeyboardStyleProfilesDirectory();
 QString idFromKey(const Key &key);
+QString capitalized(const QString &word,
+                    bool capitalize);
 }} // namespace MaliitKeyboard, CoreUtils
 
 #endif // UTILS_H
@@ -120,6 +120,11 @@ namespace Logic {
 //! Note that the list might be empty as well to indicate that there
 //! should be no word candidates.
 
+//! \fn void AbstractTextEditor::wordEngineEnabledChanged(bool enabled)
+//! \brief Emitted when the active word engine toggles word candidate
+//! updates on/off, or when another word engine becomes active.
+//! \param enabled Whether the active word engine is enabled.
+
 //! \fn void AbstractTextEditor::keyboardClosed()
 //! \brief Emitted when keyboard close is requested.
 
@@ -278,6 +283,9 @@ void connectEventHandlerToTextEditor(EventHandler *event_handler,
 
     QObject::connect(event_handler, SIGNAL(keyExited(Key)),
                      editor,        SLOT(onKeyExited(Key)));
+
+    QObject::connect(event_handler, SIGNAL(swipeFinished(QVector<QPointF>)),
+                     editor,        SLOT(onSwipeFinished(QVector<QPointF>)));
 }
 
 //! \brief Connects layout updater to editor.
@@ -301,8 +309,8 @@ void connectLayoutUpdaterToTextEditor(LayoutUpdater *updater,
     QObject::connect(editor,  SIGNAL(autoCapsActivated()),
                      updater, SIGNAL(autoCapsActivated()));
 
-    QObject::connect(editor->wordEngine(), SIGNAL(enabledChanged(bool)),
-                     updater,              SLOT(setWordRibbonVisible(bool)));
+    QObject::connect(editor,  SIGNAL(wordEngineEnabledChanged(bool)),
+                     updater, SLOT(setWordRibbonVisible(bool)));
     }
 
 
@@ -329,6 +337,7 @@ public:
 
     QScopedPointer<Model::Text> text;
     QScopedPointer<Logic::AbstractWordEngine> word_engine;
+    Logic::AbstractWordEngine *active_word_engine; //!< word_engine, unless replaced by setWordEngine().
     QScopedPointer<Logic::AbstractLanguageFeatures> language_features;
     bool preedit_enabled;
     bool auto_correct_enabled;
@@ -348,6 +357,7 @@ AbstractTextEditorPrivate::AbstractTextEditorPrivate(Model::Text *new_text,
     : auto_repeat()
     , text(new_text)
     , word_engine(new_word_engine)
+    , active_word_engine(new_word_engine)
     , language_features(new_language_features)
     , preedit_enabled(false)
     , auto_correct_enabled(false)
@@ -387,8 +397,7 @@ AbstractTextEditor::AbstractTextEditor(Model::Text *text,
     connect(&d_ptr->auto_repeat.timer, SIGNAL(timeout()),
             this,                      SLOT(autoRepeatKey()));
 
-    connect(word_engine, SIGNAL(candidatesChanged(WordCandidateList)),
-            this,        SIGNAL(wordCandidatesChanged(WordCandidateList)));
+    connectWordEngine(word_engine);
 }
 
 //! \brief Destructor.
@@ -406,7 +415,36 @@ Model::Text * AbstractTextEditor::text() const
 Logic::AbstractWordEngine * AbstractTextEditor::wordEngine() const
 {
     Q_D(const AbstractTextEditor);
-    return d->word_engine.data();
+    return d->active_word_engine;
+}
+
+//! \brief Routes candidate requests to another word engine, for instance to
+//! a conversion engine while a Chinese layout is active.
+//! \param word_engine The word engine, or 0 to restore the word engine given
+//!                    to the constructor. Does not take ownership.
+//!
+//! Commits the preedit, which belongs to the previous word engine. Emits
+//! wordEngineEnabledChanged().
+void AbstractTextEditor::setWordEngine(Logic::AbstractWordEngine *word_engine)
+{
+    Q_D(AbstractTextEditor);
+
+    if (not word_engine) {
+        word_engine = d->word_engine.data();
+    }
+
+    if (not word_engine or word_engine == d->active_word_engine) {
+        return;
+    }
+
+    commitPreedit();
+    d->active_word_engine->clearCandidates();
+    disconnect(d->active_word_engine, 0, this, 0);
+
+    d->active_word_engine = word_engine;
+    connectWordEngine(word_engine);
+
+    Q_EMIT wordEngineEnabledChanged(word_engine->isEnabled());
 }
 
 //! \brief Sets auto-repeat behavior for pressed keys.
@@ -481,7 +519,7 @@ void AbstractTextEditor::onKeyReleased(const Key &key)
         // computeCandidates can change preedit face, so needs to happen
         // before sending preedit:
         if (d->preedit_enabled) {
-            d->word_engine->computeCandidates(d->text.data());
+            d->active_word_engine->computeCandidates(d->text.data());
         }
 
         sendPreeditString(d->text->preedit(), d->text->preeditFace(),
@@ -515,6 +553,7 @@ void AbstractTextEditor::onKeyReleased(const Key &key)
             d->text->appendToPreedit(" ");
         }
         commitPreedit();
+        predictNextWord();
 
         if (auto_caps_activated && d->auto_caps_enabled) {
             Q_EMIT autoCapsActivated();
@@ -611,6 +650,44 @@ void AbstractTextEditor::onKeyExited(const Key &key)
     }
 }
 
+//! \brief Reacts to a finished swipe.
+//! \param path The touch points of the swipe, in key area coordinates.
+//!
+//! The word fitting the swipe best replaces the preedit, the other
+//! candidates are shown in the word ribbon. A previous word in preedit gets
+//! committed first, separated by a space.
+void AbstractTextEditor::onSwipeFinished(const QVector<QPointF> &path)
+{
+    Q_D(AbstractTextEditor);
+
+    if (not d->valid()) {
+        return;
+    }
+
+    const QString &preedit(d->text->preedit());
+
+    if (not preedit.isEmpty()) {
+        if (preedit.at(preedit.length() - 1).isLetterOrNumber()) {
+            d->text->appendToPreedit(" ");
+        }
+
+        commitPreedit();
+    }
+
+    d->active_word_engine->computeSwipeCandidates(d->text.data(), path);
+
+    if (d->text->preedit().isEmpty()) {
+        return;
+    }
+
+    sendPreeditString(d->text->preedit(), d->text->preeditFace(),
+                      Replacement(d->text->cursorPosition()));
+
+    if (not d->preedit_enabled) {
+        commitPreedit();
+    }
+}
+
 //! \brief Replaces current preedit with given replacement
 //! \param replacement New preedit.
 void AbstractTextEditor::replacePreedit(const QString &replacement)
@@ -624,7 +701,7 @@ void AbstractTextEditor::replacePreedit(const QString &replacement)
     d->text->setPreedit(replacement);
     // computeCandidates can change preedit face, so needs to happen
     // before sending preedit:
-    d->word_engine->computeCandidates(d->text.data());
+    d->active_word_engine->computeCandidates(d->text.data());
     sendPreeditString(d->text->preedit(), d->text->preeditFace());
 }
 
@@ -644,6 +721,7 @@ void AbstractTextEditor::replaceAndCommitPreedit(const QString &replacement)
     d->text->setPreedit(replacement);
     d->text->appendToPreedit(appendix);
     commitPreedit();
+    predictNextWord();
 
     if (auto_caps_activated && d->auto_caps_enabled) {
         Q_EMIT autoCapsActivated();
@@ -660,7 +738,7 @@ void AbstractTextEditor::clearPreedit()
     }
 
     d->text->setPreedit("");
-    d->word_engine->computeCandidates(d->text.data());
+    d->active_word_engine->computeCandidates(d->text.data());
 }
 
 //! \brief Returns whether preedit functionality is enabled.
@@ -721,6 +799,31 @@ void AbstractTextEditor::setAutoCapsEnabled(bool enabled)
     }
 }
 
+//! \brief Returns the content type of the edited field.
+Model::Text::ContentType AbstractTextEditor::contentType() const
+{
+    Q_D(const AbstractTextEditor);
+    return (d->text ? d->text->contentType() : Model::Text::FreeTextContent);
+}
+
+//! \brief Sets the content type of the edited field, which decides how the
+//! word engine completes the preedit.
+//! \param content_type The content type, as reported by the application.
+void AbstractTextEditor::setContentType(Model::Text::ContentType content_type)
+{
+    Q_D(AbstractTextEditor);
+
+    if (not d->valid() || d->text->contentType() == content_type) {
+        return;
+    }
+
+    // The preedit belongs to the previous field, which lost focus already,
+    // so it must not get committed into the new one:
+    d->text->setPreedit("");
+    d->active_word_engine->clearCandidates();
+    d->text->setContentType(content_type);
+}
+
 //! \brief Commits current preedit.
 void AbstractTextEditor::commitPreedit()
 {
@@ -730,9 +833,61 @@ void AbstractTextEditor::commitPreedit()
         return;
     }
 
+    // Single characters, committed right away, are not worth learning:
+    if (d->preedit_enabled) {
+        d->active_word_engine->learnWord(d->text.data());
+    }
+
     sendCommitString(d->text->preedit());
     d->text->commitPreedit();
-    d->word_engine->clearCandidates();
+    d->active_word_engine->clearCandidates();
+}
+
+//! \brief Lets the word engine predict the word following a committed word,
+//! which replaces the word candidates once available.
+void AbstractTextEditor::predictNextWord()
+{
+    Q_D(AbstractTextEditor);
+
+    if (d->preedit_enabled) {
+        d->active_word_engine->predictNextWord(d->text.data());
+    }
+}
+
+//! \brief Forwards candidates and enabled state of a word engine.
+void AbstractTextEditor::connectWordEngine(Logic::AbstractWordEngine *word_engine)
+{
+    connect(word_engine, SIGNAL(candidatesChanged(WordCandidateList)),
+            this,        SIGNAL(wordCandidatesChanged(WordCandidateList)));
+
+    connect(word_engine, SIGNAL(preeditFaceChanged(QString,Model::Text::PreeditFace,QString)),
+            this,        SLOT(onPreeditFaceChanged(QString,Model::Text::PreeditFace,QString)));
+
+    connect(word_engine, SIGNAL(enabledChanged(bool)),
+            this,        SIGNAL(wordEngineEnabledChanged(bool)));
+}
+
+//! \brief Applies preedit face and primary candidate that were computed
+//! asynchronously by the word engine, and sends the updated preedit.
+//! \param preedit The preedit the word engine computed candidates for.
+//! \param face The new preedit face.
+//! \param primary_candidate The new primary candidate.
+//!
+//! Ignored if the preedit changed in the meantime.
+void AbstractTextEditor::onPreeditFaceChanged(const QString &preedit,
+                                              Model::Text::PreeditFace face,
+                                              const QString &primary_candidate)
+{
+    Q_D(AbstractTextEditor);
+
+    if (not d->valid() || d->text->preedit() != preedit) {
+        return;
+    }
+
+    d->text->setPreeditFace(face);
+    d->text->setPrimaryCandidate(primary_candidate);
+    sendPreeditString(d->text->preedit(), d->text->preeditFace(),
+                      Replacement(d->text->cursorPosition()));
 }
 
 // TODO: this implementation does not take into account following features:
@@ -785,7 +940,7 @@ void AbstractTextEditor::addToUserDictionary(const QString &word)
 {
     Q_D(AbstractTextEditor);
 
-    d->word_engine->addToUserDictionary(word);
+    d->active_word_engine->addToUserDictionary(word);
     d->text->setPrimaryCandidate(word);
 
     Q_EMIT wordCandidatesChanged(WordCandidateList());
@@ -806,7 +961,8 @@ void AbstractTextEditor::sendPreeditString(const QString &preedit,
 //! \param surrounding_text surrounding text of a preedit
 //!
 //! Extract words with the cursor inside and replaces it with a preedit.
-//! This is called preedit activation.
+//! This is called preedit activation. Also updates the context of the
+//! text model from the words left of the cursor.
 void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
                                                  const QString &surrounding_text)
 {
@@ -814,9 +970,13 @@ void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
     Replacement r;
 
     if (not extractWordBoundariesAtCursor(surrounding_text, cursor_position, &r)) {
+        d->text->setContext(QString());
         return;
     }
 
+    // The prediction context ends before the word that becomes the preedit:
+    d->text->setContext(surrounding_text, r.start >= 0 ? r.start : r.cursor_position);
+
     if (r.start < 0 or r.length < 0) {
         if (d->ignore_next_surrounding_text == surrounding_text and
             d->ignore_next_cursor_position == cursor_position) {
@@ -836,7 +996,7 @@ void AbstractTextEditor::onCursorPositionChanged(int cursor_position,
         d->text->setPreedit(word, word_begin_relative_cursor_pos);
         // computeCandidates can change preedit face, so needs to happen
         // before sending preedit:
-        d->word_engine->computeCandidates(d->text.data());
+        d->active_word_engine->computeCandidates(d->text.data());
         sendPreeditString(d->text->preedit(), d->text->preeditFace(), word_r);
         // Qt is going to send us an event with cursor position places
         // at the beginning of replaced word and surrounding text
@@ -113,6 +113,7 @@ public:
 
     Model::Text * text() const;
     Logic::AbstractWordEngine * wordEngine() const;
+    void setWordEngine(Logic::AbstractWordEngine *word_engine);
     Logic::AbstractLanguageFeatures * languageFeatures() const;
 
     void setAutoRepeatBehaviour(int auto_repeat_delay,
@@ -122,6 +123,7 @@ public:
     Q_SLOT void onKeyReleased(const Key &key);
     Q_SLOT void onKeyEntered(const Key &key);
     Q_SLOT void onKeyExited(const Key &key);
+    Q_SLOT void onSwipeFinished(const QVector<QPointF> &path);
     Q_SLOT void onCursorPositionChanged(int cursor_position,
                                         const QString &surrounding_text);
     Q_SLOT void replacePreedit(const QString &replacement);
@@ -140,10 +142,14 @@ public:
     Q_SLOT void setAutoCapsEnabled(bool enabled);
     Q_SIGNAL void autoCapsEnabledChanged(bool enabled);
 
+    Model::Text::ContentType contentType() const;
+    Q_SLOT void setContentType(Model::Text::ContentType content_type);
+
     Q_SIGNAL void keyboardClosed();
     Q_SIGNAL void leftLayoutSelected();
     Q_SIGNAL void rightLayoutSelected();
     Q_SIGNAL void wordCandidatesChanged(const WordCandidateList &word_candidates);
+    Q_SIGNAL void wordEngineEnabledChanged(bool enabled);
     Q_SIGNAL void autoCapsActivated();
 
     Q_SLOT void showUserCandidate();
@@ -163,7 +169,12 @@ private:
     virtual void invokeAction(const QString &action, const QString &key_sequence) = 0;
 
     void commitPreedit();
+    void predictNextWord();
+    void connectWordEngine(Logic::AbstractWordEngine *word_engine);
     Q_SLOT void autoRepeatKey();
+    Q_SLOT void onPreeditFaceChanged(const QString &preedit,
+                                     Model::Text::PreeditFace face,
+                                     const QString &primary_candidate);
 };
 
 }} // namespace Logic, MaliitKeyboard
@@ -30,15 +30,129 @@
  */
 
 #include "abstractwordengine.h"
+#include "candidateranker.h"
+#include "wordenginebackend.h"
 
 namespace MaliitKeyboard {
 namespace Logic {
+namespace {
+
+//! Generation of synchronous requests, whose results are not posted.
+const int NoGeneration = -1;
+
+QEvent::Type candidatesEventType()
+{
+    static const QEvent::Type type(static_cast<QEvent::Type>(QEvent::registerEventType()));
+    return type;
+}
+
+//! Carries the result of an asynchronous candidate computation back to the
+//! thread of the word engine.
+class CandidatesEvent
+    : public QEvent
+{
+public:
+    const int generation;
+    const bool is_next_word; //!< Whether candidates predict the next word.
+    const Model::Text text;
+    const WordCandidateList candidates;
+
+    explicit CandidatesEvent(int new_generation,
+                             bool new_is_next_word,
+                             const Model::Text &new_text,
+                             const WordCandidateList &new_candidates)
+        : QEvent(candidatesEventType())
+        , generation(new_generation)
+        , is_next_word(new_is_next_word)
+        , text(new_text)
+        , candidates(new_candidates)
+    {}
+};
+
+//! State shared by the backend jobs of one request.
+struct BackendRequest
+{
+    const Model::Text &text;
+    const bool is_next_word;
+    CandidateRanker ranker;
+    QSemaphore cheap_finished;
+    QSemaphore expensive_finished;
+    QAtomicInt known_word; //!< Whether any backend knows the preedit.
+    QAtomicInt unknown_word; //!< Whether any backend considers it misspelled.
+
+    explicit BackendRequest(const Model::Text &new_text,
+                            bool new_is_next_word,
+                            int max_candidates)
+        : text(new_text)
+        , is_next_word(new_is_next_word)
+        , ranker(max_candidates)
+        , cheap_finished()
+        , expensive_finished()
+        , known_word(0)
+        , unknown_word(0)
+    {}
+};
+
+//! Runs one backend for a request, on the backend pool.
+class BackendJob
+    : public QRunnable
+{
+private:
+    BackendRequest *const m_request;
+    WordEngineBackend *const m_backend;
+
+public:
+    explicit BackendJob(BackendRequest *request,
+                        WordEngineBackend *backend)
+        : m_request(request)
+        , m_backend(backend)
+    {}
+
+    void run()
+    {
+        if (m_request->is_next_word) {
+            m_backend->fetchNextWordCandidates(m_request->text, &m_request->ranker);
+        } else {
+            switch (m_backend->fetchCandidates(m_request->text, &m_request->ranker)) {
+            case WordEngineBackend::KnownWord: m_request->known_word.store(1); break;
+            case WordEngineBackend::UnknownWord: m_request->unknown_word.store(1); break;
+            case WordEngineBackend::NoVerdict: break;
+            }
+        }
+
+        if (m_backend->costClass() == WordEngineBackend::Cheap) {
+            m_request->cheap_finished.release();
+        } else {
+            m_request->expensive_finished.release();
+        }
+    }
+};
+
+} // namespace
 
 //! \class AbstractWordEngine
 //! \brief Provides word candidates based on text model.
 //!
-//! Derived classes need to provide an implementation for
-//! fetchCandidates() and, optionally, addToUserDictionary().
+//! Derived classes either register backends (see WordEngineBackend) or
+//! reimplement fetchCandidates() and, optionally, addToUserDictionary(),
+//! setActiveLanguage() and fetchNextWordCandidates(). They can also
+//! reimplement setKeyArea() and fetchSwipeCandidates().
+//!
+//! Backends run in parallel, on a thread pool of their own, and feed one
+//! CandidateRanker. In asynchronous mode, the candidates of the cheap
+//! backends are delivered as soon as these finish, and are then replaced by
+//! the merged candidates of all backends. The word ribbon thus updates as
+//! fast as the fastest backend with candidates allows.
+//!
+//! In asynchronous mode, fetchCandidates() runs on a worker thread, on a
+//! copy of the text model. Each request gets a new generation number; results
+//! of requests that were superseded in the meantime are dropped. Derived
+//! classes therefore need to guard their backends against concurrent access,
+//! and must call waitForCandidates() in their destructor.
+//!
+//! With coalescing, requests are held back until typing pauses for the quiet
+//! period, or until the oldest held back request reaches the maximum latency.
+//! Only the latest request is then computed.
 //! \sa Model::Text, computeCandidates().
 
 //! \fn void AbstractWordEngine::enabledChanged(bool enabled)
@@ -49,27 +163,155 @@ namespace Logic {
 //! \brief Emitted when new candidates have been computed.
 //! \param candidates The list of updated candidates.
 
+//! \fn void AbstractWordEngine::asynchronousChanged(bool asynchronous)
+//! \brief Emitted when word engine toggles asynchronous candidate updates.
+//! \param asynchronous Whether candidates are computed on a worker thread.
+
+//! \fn void AbstractWordEngine::preeditFaceChanged(const QString &preedit, Model::Text::PreeditFace face, const QString &primary_candidate)
+//! \brief Emitted in asynchronous mode, right before candidatesChanged(),
+//! with the preedit face and primary candidate computed by fetchCandidates().
+//! \param preedit The preedit the candidates were computed for.
+//! \param face The new preedit face.
+//! \param primary_candidate The new primary candidate.
+
 //! \fn WordCandidateList AbstractWordEngine::fetchCandidates(Model::Text *text)
 //! \brief Returns a list of candidates.
 //! \param text The text model.
 //!
-//! Needs to be implemented by derived classes. Will not be called if engine
-//! is disabled or text model has no preedit.
+//! The default implementation runs the registered backends. Derived classes
+//! without backends need to reimplement it. Will not be called if engine is
+//! disabled or text model has no preedit.
+
+//! \fn WordCandidateList AbstractWordEngine::fetchNextWordCandidates(Model::Text *text)
+//! \brief Returns predictions for the word following the context of text,
+//! best first.
+//! \param text The text model, without preedit.
+//!
+//! Can be reimplemented by derived classes, the default implementation
+//! runs the registered backends. Must not set a primary candidate, as there
+//! is no preedit it could replace. Runs on a worker thread in asynchronous
+//! mode.
+
+//! \fn WordCandidateList AbstractWordEngine::fetchSwipeCandidates(Model::Text *text, const QVector<QPointF> &path)
+//! \brief Returns the words fitting a swipe path, best first, and sets the
+//! preedit of text to the best one.
+//! \param text The text model.
+//! \param path The swipe path, in key area coordinates.
+//!
+//! Can be reimplemented by derived classes, the default implementation
+//! finds no words. Always called on the thread of the word engine. Derived
+//! classes reimplementing it also need to reimplement supportsSwipe().
 
 //! \property AbstractWordEngine::enabled
 //! \brief Whether the engine provides updates for word candidates.
 
+//! \property AbstractWordEngine::asynchronous
+//! \brief Whether candidates are computed on a worker thread.
+
 class AbstractWordEnginePrivate
 {
 public:
     bool enabled;
+    bool asynchronous;
+    QAtomicInt generation;
+    QAtomicInt max_candidates; //!< Read by fetchCandidates() on the worker.
+    QList<QSharedPointer<WordEngineBackend> > backends;
+    QThreadPool backend_pool; //!< Declared after backends, so that jobs finish first.
+    QThreadPool pool;
+
+    QTimer quiet_timer;
+    QTimer latency_timer;
+    bool has_pending;
+    int pending_generation;
+    Model::Text pending_text;
+
+    QAtomicInt requests;
+    QAtomicInt coalesced;
+    QAtomicInt computations;
 
     explicit AbstractWordEnginePrivate();
 };
 
 AbstractWordEnginePrivate::AbstractWordEnginePrivate()
     : enabled(false)
-{}
+    , asynchronous(false)
+    , generation(0)
+    , max_candidates(AbstractWordEngine::DefaultMaxCandidates)
+    , backends()
+    , backend_pool()
+    , pool()
+    , quiet_timer()
+    , latency_timer()
+    , has_pending(false)
+    , pending_generation(0)
+    , pending_text()
+    , requests(0)
+    , coalesced(0)
+    , computations(0)
+{
+    // A single worker keeps requests in order, and fetchCandidates()
+    // serialized:
+    pool.setMaxThreadCount(1);
+
+    // Each backend of a request gets a thread of its own, if possible:
+    backend_pool.setMaxThreadCount(qMax(2, QThread::idealThreadCount()));
+
+    // Coalescing is disabled by default:
+    quiet_timer.setSingleShot(true);
+    quiet_timer.setInterval(0);
+    latency_timer.setSingleShot(true);
+    latency_timer.setInterval(0);
+}
+
+
+//! \internal
+class AbstractWordEngine::CandidatesJob
+    : public QRunnable
+{
+private:
+    AbstractWordEngine *const m_engine;
+    const int m_generation;
+    const bool m_is_next_word;
+    Model::Text m_text;
+
+public:
+    explicit CandidatesJob(AbstractWordEngine *engine,
+                           int generation,
+                           const Model::Text &text,
+                           bool is_next_word = false)
+        : m_engine(engine)
+        , m_generation(generation)
+        , m_is_next_word(is_next_word)
+        , m_text(text)
+    {}
+
+    void run()
+    {
+        AbstractWordEnginePrivate *const d(m_engine->d_func());
+
+        // Skip requests that were superseded while waiting in the queue.
+        // Like predictNextWord() itself, next word jobs are not counted:
+        if (d->generation.load() != m_generation) {
+            if (not m_is_next_word) {
+                d->coalesced.ref();
+            }
+
+            return;
+        }
+
+        if (not m_is_next_word) {
+            d->computations.ref();
+        }
+
+        // Backends publish their cheap results themselves:
+        const WordCandidateList &candidates(not d->backends.isEmpty()
+                                            ? m_engine->runBackends(&m_text, m_generation, m_is_next_word)
+                                            : m_is_next_word ? m_engine->fetchNextWordCandidates(&m_text)
+                                                             : m_engine->fetchCandidates(&m_text));
+        QCoreApplication::postEvent(m_engine, new CandidatesEvent(m_generation, m_is_next_word, m_text, candidates));
+    }
+};
+//! \internal_end
 
 
 //! \brief Constructor.
@@ -78,13 +320,22 @@ AbstractWordEnginePrivate::AbstractWordEnginePrivate()
 AbstractWordEngine::AbstractWordEngine(QObject *parent)
     : QObject(parent)
     , d_ptr(new AbstractWordEnginePrivate)
-{}
+{
+    Q_D(AbstractWordEngine);
+
+    connect(&d->quiet_timer,   SIGNAL(timeout()),
+            this,              SLOT(computePendingCandidates()));
+    connect(&d->latency_timer, SIGNAL(timeout()),
+            this,              SLOT(computePendingCandidates()));
+}
 
 //! \brief Destructor.
 //!
 //! Needs to be implemented in derived classes.
 AbstractWordEngine::~AbstractWordEngine()
-{}
+{
+    waitForCandidates();
+}
 
 
 //! \brief Returns whether the word engine is enabled.
@@ -112,12 +363,162 @@ void AbstractWordEngine::setEnabled(bool enabled)
 }
 
 
+//! \brief Returns whether candidates are computed on a worker thread.
+//! \sa AbstractWordEngine::asynchronous
+bool AbstractWordEngine::isAsynchronous() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->asynchronous;
+}
+
+
+//! \brief Set whether candidates should be computed on a worker thread.
+//! \param asynchronous If true, computeCandidates() returns immediately and
+//!                     candidatesChanged() is emitted once the candidates
+//!                     are available. Switching back to synchronous mode
+//!                     waits for, and drops, pending computations.
+//! \sa AbstractWordEngine::asynchronous
+void AbstractWordEngine::setAsynchronous(bool asynchronous)
+{
+    Q_D(AbstractWordEngine);
+
+    if (d->asynchronous != asynchronous) {
+        if (not asynchronous) {
+            waitForCandidates();
+        }
+
+        d->asynchronous = asynchronous;
+        Q_EMIT asynchronousChanged(d->asynchronous);
+    }
+}
+
+
+//! \brief Returns how many candidates fit into the word ribbon.
+//!
+//! Derived classes should not return more candidates. Safe to call from
+//! fetchCandidates(), on the worker thread.
+int AbstractWordEngine::maxCandidates() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->max_candidates.load();
+}
+
+
+//! \brief Sets how many candidates fit into the word ribbon.
+//! \param max_candidates The number of candidates, usually taken from the
+//!                       style. Values less than 1 restore
+//!                       DefaultMaxCandidates.
+//!
+//! Applies to candidates computed from now on.
+void AbstractWordEngine::setMaxCandidates(int max_candidates)
+{
+    Q_D(AbstractWordEngine);
+    d->max_candidates.store(max_candidates > 0 ? max_candidates : int(DefaultMaxCandidates));
+}
+
+
+//! \brief Returns the quiet period, in milliseconds.
+//! \sa setCoalescing()
+int AbstractWordEngine::quietPeriod() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->quiet_timer.interval();
+}
+
+
+//! \brief Returns the maximum latency, in milliseconds.
+//! \sa setCoalescing()
+int AbstractWordEngine::maxLatency() const
+{
+    Q_D(const AbstractWordEngine);
+    return d->latency_timer.interval();
+}
+
+
+//! \brief Configures coalescing of candidate requests during fast typing.
+//! \param quiet_period Candidates are only computed once no new request
+//!                     arrived for this many milliseconds. 0 disables
+//!                     coalescing.
+//! \param max_latency Upper bound, in milliseconds, for holding back a
+//!                    request while typing continues. 0 means no bound.
+void AbstractWordEngine::setCoalescing(int quiet_period,
+                                       int max_latency)
+{
+    Q_D(AbstractWordEngine);
+
+    d->quiet_timer.setInterval(qMax(0, quiet_period));
+    d->latency_timer.setInterval(qMax(0, max_latency));
+
+    if (d->quiet_timer.interval() == 0) {
+        computePendingCandidates();
+    }
+}
+
+
+//! \brief Returns the counters of the candidate request scheduler.
+AbstractWordEngine::SchedulerStatistics AbstractWordEngine::schedulerStatistics() const
+{
+    Q_D(const AbstractWordEngine);
+    SchedulerStatistics statistics;
+
+    statistics.requests = d->requests.load();
+    statistics.coalesced = d->coalesced.load();
+    statistics.computations = d->computations.load();
+    return statistics;
+}
+
+
+//! \brief Resets the counters of the candidate request scheduler.
+void AbstractWordEngine::resetSchedulerStatistics()
+{
+    Q_D(AbstractWordEngine);
+
+    d->requests.store(0);
+    d->coalesced.store(0);
+    d->computations.store(0);
+}
+
+
+//! \brief Registers a backend, which then provides candidates.
+//! \param backend The backend. The word engine takes ownership.
+//!
+//! Backends should be registered before candidates are requested, usually
+//! by the constructor of a derived class.
+void AbstractWordEngine::addBackend(WordEngineBackend *backend)
+{
+    Q_D(AbstractWordEngine);
+
+    if (backend) {
+        waitForCandidates();
+        d->backends.append(QSharedPointer<WordEngineBackend>(backend));
+    }
+}
+
+
+//! @returns the registered backends, in order of registration.
+QList<WordEngineBackend *> AbstractWordEngine::backends() const
+{
+    Q_D(const AbstractWordEngine);
+    QList<WordEngineBackend *> result;
+
+    Q_FOREACH (const QSharedPointer<WordEngineBackend> &backend, d->backends) {
+        result.append(backend.data());
+    }
+
+    return result;
+}
+
+
 //! \brief Clears the current candidates.
 //!
-//! Only has an effect when word engine is enabled, in which case
-//! candidatesCanged() is emitted.
+//! Pending asynchronous computations are dropped. Only emits
+//! candidatesCanged() when word engine is enabled.
 void AbstractWordEngine::clearCandidates()
 {
+    Q_D(AbstractWordEngine);
+    d->generation.ref();
+    dropPendingCandidates();
+
     if (isEnabled()) {
         Q_EMIT candidatesChanged(WordCandidateList());
     }
@@ -127,9 +528,24 @@ void AbstractWordEngine::clearCandidates()
 //! \brief Computes new candidates, based on text model.
 //! \param text The text model.
 //!
-//! Can trigger emission of candidatesChanged().
+//! Can trigger emission of candidatesChanged(). In asynchronous mode, the
+//! emission happens later, from the event loop, and only if no newer request
+//! was made in the meantime.
 void AbstractWordEngine::computeCandidates(Model::Text *text)
 {
+    Q_D(AbstractWordEngine);
+
+    // Every request supersedes pending ones, even if it computes nothing:
+    const int generation(d->generation.fetchAndAddOrdered(1) + 1);
+    const bool had_pending(d->has_pending);
+
+    if (had_pending) {
+        d->has_pending = false;
+        d->coalesced.ref();
+    }
+
+    d->quiet_timer.stop();
+
     // FIXME: add possiblity to turn off the error correction for
     // entries that does not need it (like password entries).  Also,
     // with that we probably will want to turn off preedit styling at
@@ -144,19 +560,366 @@ void AbstractWordEngine::computeCandidates(Model::Text *text)
         // editor to send no formatting informations along with
         // preedit string. When this is done, preedit-string test
         // needs to be adapted.
+        d->latency_timer.stop();
         return;
     }
 
+    d->requests.ref();
+
+    if (d->quiet_timer.interval() > 0) {
+        // The latency bound counts from the oldest held back request:
+        if (not had_pending && d->latency_timer.interval() > 0) {
+            d->latency_timer.start();
+        }
+
+        d->has_pending = true;
+        d->pending_generation = generation;
+        d->pending_text = *text;
+        d->quiet_timer.start();
+        return;
+    }
+
+    if (d->asynchronous) {
+        d->pool.start(new CandidatesJob(this, generation, *text));
+        return;
+    }
+
+    d->computations.ref();
     Q_EMIT candidatesChanged(fetchCandidates(text));
 }
 
+
+//! \brief Predicts the word following the committed text.
+//! \param text The text model, right after its preedit was committed.
+//!
+//! Meant to be called after a word was committed, so that the word candidates
+//! show likely next words before the user starts typing. In asynchronous
+//! mode, the predictions are computed on the worker thread, and dropped if
+//! the user starts typing in the meantime. Pending requests are dropped.
+//! Emits candidatesChanged() when word engine is enabled and predicts
+//! anything. Predictions are not counted by the scheduler statistics.
+void AbstractWordEngine::predictNextWord(Model::Text *text)
+{
+    Q_D(AbstractWordEngine);
+    const int generation(d->generation.fetchAndAddOrdered(1) + 1);
+    dropPendingCandidates();
+
+    if (not isEnabled() || not text || not text->preedit().isEmpty()) {
+        return;
+    }
+
+    if (d->asynchronous) {
+        d->pool.start(new CandidatesJob(this, generation, *text, true));
+        return;
+    }
+
+    const WordCandidateList &candidates(fetchNextWordCandidates(text));
+
+    if (not candidates.isEmpty()) {
+        Q_EMIT candidatesChanged(candidates);
+    }
+}
+
+
+//! \brief Computes the candidates for a swipe path.
+//! \param text The text model, whose preedit is replaced by the best
+//!             candidate.
+//! \param path The swipe path, in key area coordinates.
+//!
+//! Candidates are computed right away, even in asynchronous mode, so that
+//! they are shown as soon as the swipe ends. Pending requests are dropped.
+//! Emits candidatesChanged() when word engine is enabled.
+void AbstractWordEngine::computeSwipeCandidates(Model::Text *text,
+                                                const QVector<QPointF> &path)
+{
+    Q_D(AbstractWordEngine);
+    d->generation.ref();
+    dropPendingCandidates();
+
+    if (not isEnabled() || not text) {
+        return;
+    }
+
+    Q_EMIT candidatesChanged(fetchSwipeCandidates(text, path));
+}
+
+
+//! \brief Drops a held back request, if any.
+void AbstractWordEngine::dropPendingCandidates()
+{
+    Q_D(AbstractWordEngine);
+
+    if (d->has_pending) {
+        d->has_pending = false;
+        d->coalesced.ref();
+    }
+
+    d->quiet_timer.stop();
+    d->latency_timer.stop();
+}
+
+
+//! \brief Computes candidates for the held back request, if any.
+//!
+//! Called once typing paused for the quiet period, or once the maximum
+//! latency has been reached.
+void AbstractWordEngine::computePendingCandidates()
+{
+    Q_D(AbstractWordEngine);
+
+    d->quiet_timer.stop();
+    d->latency_timer.stop();
+
+    if (not d->has_pending) {
+        return;
+    }
+
+    d->has_pending = false;
+
+    if (d->asynchronous) {
+        d->pool.start(new CandidatesJob(this, d->pending_generation, d->pending_text));
+        return;
+    }
+
+    Model::Text text(d->pending_text);
+    d->computations.ref();
+    const WordCandidateList &candidates(fetchCandidates(&text));
+    deliverCandidates(d->pending_generation, false, text, candidates);
+}
+
+
+//! \brief Drops pending asynchronous computations and waits for a running
+//! one to finish.
+//!
+//! Derived classes using asynchronous mode have to call this in their
+//! destructor, before their backends are destroyed.
+void AbstractWordEngine::waitForCandidates()
+{
+    Q_D(AbstractWordEngine);
+
+    d->generation.ref();
+    d->pool.waitForDone();
+}
+
+
+//! \brief Delivers asynchronously computed candidates.
+//!
+//! Results are posted from the worker thread, so that they are emitted in the
+//! thread of the word engine, in the same order as requested.
+void AbstractWordEngine::customEvent(QEvent *event)
+{
+    if (event->type() != candidatesEventType()) {
+        QObject::customEvent(event);
+        return;
+    }
+
+    const CandidatesEvent *const result(static_cast<const CandidatesEvent *>(event));
+    deliverCandidates(result->generation, result->is_next_word, result->text, result->candidates);
+}
+
+
+//! \brief Emits candidates that were computed on a copy of the text model.
+//! \param generation The generation of the request.
+//! \param is_next_word Whether candidates predict the next word. Those carry
+//!                     no preedit, and are only emitted if not empty.
+//! \param text The copy of the text model, as updated by fetchCandidates().
+//! \param candidates The computed candidates.
+void AbstractWordEngine::deliverCandidates(int generation,
+                                           bool is_next_word,
+                                           const Model::Text &text,
+                                           const WordCandidateList &candidates)
+{
+    Q_D(AbstractWordEngine);
+
+    // Drop results that were superseded while being computed:
+    if (generation != d->generation.load() || not d->enabled) {
+        return;
+    }
+
+    if (is_next_word) {
+        if (not candidates.isEmpty()) {
+            Q_EMIT candidatesChanged(candidates);
+        }
+
+        return;
+    }
+
+    // Preedit goes first, so that the application never shows candidates for
+    // a preedit it has not seen yet:
+    Q_EMIT preeditFaceChanged(text.preedit(), text.preeditFace(), text.primaryCandidate());
+    Q_EMIT candidatesChanged(candidates);
+}
+
+//! \brief Learns from a word the user committed, e.g. a web address.
+//! \param text The text model, right before its preedit gets committed.
+//!
+//! Can be reimplemented in derived classes. This passes the text to the
+//! registered backends that support its content type, if word engine is
+//! enabled.
+void AbstractWordEngine::learnWord(Model::Text *text)
+{
+    Q_D(AbstractWordEngine);
+
+    if (not isEnabled() || not text || text->preedit().isEmpty()) {
+        return;
+    }
+
+    Q_FOREACH (const QSharedPointer<WordEngineBackend> &backend, d->backends) {
+        if (backend->supportsContentType(text->contentType())) {
+            backend->learnWord(*text);
+        }
+    }
+}
+
+
+//! \brief Returns whether the engine can decode swipe paths into words.
+//!
+//! Swipe typing should only be offered if it can. Can be reimplemented in
+//! derived classes, this returns false.
+//! \sa fetchSwipeCandidates()
+bool AbstractWordEngine::supportsSwipe() const
+{
+    return false;
+}
+
+
 //! \brief Adds a word to user dictionary.
 //! \param word A word.
 //!
-//! Needs to be implemented in derived classes. This does nothing.
+//! Can be reimplemented in derived classes. This passes the word to the
+//! registered backends.
 void AbstractWordEngine::addToUserDictionary(const QString &word)
 {
-    Q_UNUSED(word);
+    Q_D(AbstractWordEngine);
+
+    Q_FOREACH (const QSharedPointer<WordEngineBackend> &backend, d->backends) {
+        backend->addToUserDictionary(word);
+    }
+}
+
+
+//! \brief Tells the engine which key area the user types on, for instance
+//! to weigh corrections by key proximity.
+//! \param key_area The current key area.
+//!
+//! Can be reimplemented in derived classes. This passes the key area to the
+//! registered backends.
+void AbstractWordEngine::setKeyArea(const KeyArea &key_area)
+{
+    Q_D(AbstractWordEngine);
+
+    Q_FOREACH (const QSharedPointer<WordEngineBackend> &backend, d->backends) {
+        backend->setKeyArea(key_area);
+    }
+}
+
+
+//! \brief Tells the engine the language of the active layout, for instance
+//! to load a matching dictionary.
+//! \param language The language, as declared by the layout, e.g. "en" or
+//!                 "zh@pinyin".
+//!
+//! Can be reimplemented in derived classes. This passes the language to
+//! the registered backends.
+void AbstractWordEngine::setActiveLanguage(const QString &language)
+{
+    Q_D(AbstractWordEngine);
+
+    Q_FOREACH (const QSharedPointer<WordEngineBackend> &backend, d->backends) {
+        backend->setActiveLanguage(language);
+    }
+}
+
+
+//! \brief Runs the registered backends in parallel, and merges their
+//! candidates.
+//! \param text The text model. Receives preedit face and primary candidate,
+//!             unless is_next_word is set.
+//! \param generation The generation of an asynchronous request, or
+//!                   NoGeneration. Asynchronous requests deliver the
+//!                   candidates of the cheap backends while the expensive
+//!                   ones still run.
+//! \param is_next_word Whether to predict the word following the text.
+//! @returns the candidates of all backends, best first.
+WordCandidateList AbstractWordEngine::runBackends(Model::Text *text,
+                                                  int generation,
+                                                  bool is_next_word)
+{
+    Q_D(AbstractWordEngine);
+    BackendRequest request(*text, is_next_word, maxCandidates());
+
+    QList<WordEngineBackend *> cheap_backends;
+    QList<WordEngineBackend *> expensive_backends;
+
+    // Only backends for the content type of the edited field run:
+    Q_FOREACH (const QSharedPointer<WordEngineBackend> &backend, d->backends) {
+        if (backend->supportsContentType(text->contentType())) {
+            (backend->costClass() == WordEngineBackend::Cheap ? cheap_backends
+                                                              : expensive_backends).append(backend.data());
+        }
+    }
+
+    // Cheap backends get queued first, in case threads are scarce:
+    Q_FOREACH (WordEngineBackend *backend, cheap_backends + expensive_backends) {
+        d->backend_pool.start(new BackendJob(&request, backend));
+    }
+
+    const int cheap_count(cheap_backends.count());
+    const int expensive_count(expensive_backends.count());
+
+    request.cheap_finished.acquire(cheap_count);
+
+    if (generation != NoGeneration and expensive_count > 0) {
+        const WordCandidateList &candidates(request.ranker.candidates());
+
+        // Nothing to show yet is no reason to clear the word ribbon:
+        if (not candidates.isEmpty()) {
+            Model::Text cheap_text(*text);
+
+            if (not is_next_word) {
+                cheap_text.setPreeditFace(Model::Text::PreeditActive);
+                cheap_text.setPrimaryCandidate(candidates.first().label().text());
+            }
+
+            QCoreApplication::postEvent(this, new CandidatesEvent(generation, is_next_word, cheap_text, candidates));
+        }
+    }
+
+    request.expensive_finished.acquire(expensive_count);
+    const WordCandidateList &candidates(request.ranker.candidates());
+
+    if (not is_next_word) {
+        const bool misspelled(request.unknown_word.load() and not request.known_word.load());
+
+        text->setPreeditFace(candidates.isEmpty() ? (misspelled ? Model::Text::PreeditNoCandidates
+                                                                : Model::Text::PreeditDefault)
+                                                  : Model::Text::PreeditActive);
+        text->setPrimaryCandidate(candidates.isEmpty() ? QString()
+                                                       : candidates.first().label().text());
+    }
+
+    return candidates;
+}
+
+
+WordCandidateList AbstractWordEngine::fetchCandidates(Model::Text *text)
+{
+    return runBackends(text, NoGeneration, false);
+}
+
+
+WordCandidateList AbstractWordEngine::fetchNextWordCandidates(Model::Text *text)
+{
+    return runBackends(text, NoGeneration, true);
+}
+
+
+WordCandidateList AbstractWordEngine::fetchSwipeCandidates(Model::Text *text,
+                                                           const QVector<QPointF> &path)
+{
+    Q_UNUSED(text);
+    Q_UNUSED(path);
+    return WordCandidateList();
 }
 
 }} // namespace MaliitKeyboard, Logic
@@ -32,6 +32,7 @@
 #ifndef MALIIT_KEYBOARD_ABSTRACTWORDENGINE_H
 #define MALIIT_KEYBOARD_ABSTRACTWORDENGINE_H
 
+#include "models/keyarea.h"
 #include "models/text.h"
 #include "models/wordcandidate.h"
 #include <QtCore>
@@ -40,6 +41,7 @@ namespace MaliitKeyboard {
 namespace Logic {
 
 class AbstractWordEnginePrivate;
+class WordEngineBackend;
 
 class AbstractWordEngine
     : public QObject
@@ -51,8 +53,23 @@ class AbstractWordEngine
     Q_PROPERTY(bool enabled READ isEnabled
                             WRITE setEnabled
                             NOTIFY enabledChanged)
+    Q_PROPERTY(bool asynchronous READ isAsynchronous
+                                 WRITE setAsynchronous
+                                 NOTIFY asynchronousChanged)
 
 public:
+    //! Counters of the candidate request scheduler.
+    struct SchedulerStatistics
+    {
+        int requests; //!< Requests that asked for candidates.
+        int coalesced; //!< Requests superseded before being computed.
+        int computations; //!< Calls to fetchCandidates().
+    };
+
+    enum {
+        DefaultMaxCandidates = 7 //!< Used when the style does not tell how many candidates fit.
+    };
+
     explicit AbstractWordEngine(QObject *parent = 0);
     virtual ~AbstractWordEngine();
 
@@ -60,14 +77,62 @@ public:
     Q_SLOT virtual void setEnabled(bool enabled);
     Q_SIGNAL void enabledChanged(bool enabled);
 
+    bool isAsynchronous() const;
+    Q_SLOT void setAsynchronous(bool asynchronous);
+    Q_SIGNAL void asynchronousChanged(bool asynchronous);
+
+    int maxCandidates() const;
+    void setMaxCandidates(int max_candidates);
+
+    int quietPeriod() const;
+    int maxLatency() const;
+    void setCoalescing(int quiet_period,
+                       int max_latency);
+
+    SchedulerStatistics schedulerStatistics() const;
+    void resetSchedulerStatistics();
+
+    void addBackend(WordEngineBackend *backend);
+    QList<WordEngineBackend *> backends() const;
+
     void clearCandidates();
     void computeCandidates(Model::Text *text);
+    void predictNextWord(Model::Text *text);
+    void computeSwipeCandidates(Model::Text *text,
+                                const QVector<QPointF> &path);
     Q_SIGNAL void candidatesChanged(const WordCandidateList &candidates);
+    Q_SIGNAL void preeditFaceChanged(const QString &preedit,
+                                     Model::Text::PreeditFace face,
+                                     const QString &primary_candidate);
 
+    virtual bool supportsSwipe() const;
+    virtual void learnWord(Model::Text *text);
     virtual void addToUserDictionary(const QString &word);
+    Q_SLOT virtual void setKeyArea(const KeyArea &key_area);
+    Q_SLOT virtual void setActiveLanguage(const QString &language);
+
+protected:
+    void waitForCandidates();
+    virtual void customEvent(QEvent *event);
 
 private:
-    virtual WordCandidateList fetchCandidates(Model::Text *text) = 0;
+    class CandidatesJob;
+
+    void dropPendingCandidates();
+    Q_SLOT void computePendingCandidates();
+    void deliverCandidates(int generation,
+                           bool is_next_word,
+                           const Model::Text &text,
+                           const WordCandidateList &candidates);
+
+    WordCandidateList runBackends(Model::Text *text,
+                                  int generation,
+                                  bool is_next_word);
+
+    virtual WordCandidateList fetchCandidates(Model::Text *text);
+    virtual WordCandidateList fetchNextWordCandidates(Model::Text *text);
+    virtual WordCandidateList fetchSwipeCandidates(Model::Text *text,
+                                                   const QVector<QPointF> &path);
     const QScopedPointer<AbstractWordEnginePrivate> d_ptr;
 };
 
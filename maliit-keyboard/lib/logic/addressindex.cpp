@@ -0,0 +1,808 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "addressindex.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+
+namespace MaliitKeyboard {
+namespace Logic {
+namespace {
+
+const int HeaderWords = 4;
+//! Score, time of last use and kind.
+const int RecordWords = 3;
+//! Scores are fixed point numbers of uses.
+const quint32 ScorePerUse = 256;
+//! Entries used less than this, after decay, get dropped by compactions.
+const quint32 MinScore = ScorePerUse / 16;
+
+struct AddressEntry
+{
+    quint32 score;
+    quint32 last_used; //!< seconds since epoch, UTC.
+    quint32 kind; //!< combination of AddressIndex::Kind.
+};
+
+typedef QPair<quint32, QString> RankedAddress;
+
+void appendWord(QByteArray *data,
+                quint32 value)
+{
+    uchar buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    data->append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+quint32 readWord(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+qint64 padded(qint64 size)
+{
+    return (size + 3) & ~qint64(3);
+}
+
+quint32 seconds(const QDateTime &time)
+{
+    return quint32(qMax<qint64>(0, time.toMSecsSinceEpoch() / 1000));
+}
+
+//! @returns score, decayed from its last use until time.
+quint32 decayed(const AddressEntry &entry,
+                quint32 time)
+{
+    if (time <= entry.last_used) {
+        return entry.score;
+    }
+
+    return quint32(entry.score * std::pow(0.5, double(time - entry.last_used) / AddressIndex::HalfLife));
+}
+
+//! Orders by score, most used first, then alphabetically.
+bool isMoreUsed(const RankedAddress &lhs,
+                const RankedAddress &rhs)
+{
+    return (lhs.first > rhs.first or (lhs.first == rhs.first and lhs.second < rhs.second));
+}
+
+//! Compiles entries, which are sorted by key, into an index.
+//!
+//! The index consists of a header (magic, version, number of entries,
+//! number of UTF-16 units of all keys), the offsets of the keys, one record
+//! per entry and the keys, as UTF-16. All numbers are little endian 32 bit
+//! words.
+QByteArray compile(const QMap<QString, AddressEntry> &entries)
+{
+    quint32 string_size(0);
+
+    Q_FOREACH (const QString &key, entries.keys()) {
+        string_size += key.length();
+    }
+
+    QByteArray result;
+    appendWord(&result, AddressIndex::Magic);
+    appendWord(&result, AddressIndex::Version);
+    appendWord(&result, entries.count());
+    appendWord(&result, string_size);
+
+    quint32 offset(0);
+    appendWord(&result, offset);
+
+    for (QMap<QString, AddressEntry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        offset += it.key().length();
+        appendWord(&result, offset);
+    }
+
+    for (QMap<QString, AddressEntry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        appendWord(&result, it.value().score);
+        appendWord(&result, it.value().last_used);
+        appendWord(&result, it.value().kind);
+    }
+
+    for (QMap<QString, AddressEntry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        const QString &key(it.key());
+
+        for (int index = 0; index < key.length(); ++index) {
+            uchar buffer[2];
+            qToLittleEndian<quint16>(key.at(index).unicode(), buffer);
+            result.append(reinterpret_cast<const char *>(buffer), 2);
+        }
+    }
+
+    while (result.size() % 4) {
+        result.append('\0');
+    }
+
+    return result;
+}
+
+//! Reads a compiled index, see compile(). Keys are sorted, so that all keys
+//! sharing a prefix are adjacent.
+class AddressIndexReader
+{
+private:
+    quint32 m_count;
+    quint32 m_string_size;
+    const uchar *m_offsets;
+    const uchar *m_records;
+    const uchar *m_strings;
+
+public:
+    explicit AddressIndexReader()
+        : m_count(0)
+        , m_string_size(0)
+        , m_offsets(0)
+        , m_records(0)
+        , m_strings(0)
+    {}
+
+    //! Validates the index. Invalid indices are read as empty ones.
+    //! \param data The index. Needs to stay valid while the reader is used.
+    //! \param size Size of data in bytes.
+    //! \param error_string Receives the reason, for invalid indices.
+    bool read(const uchar *data,
+              qint64 size,
+              QString *error_string)
+    {
+        *this = AddressIndexReader();
+
+        if (not data or size < HeaderWords * 4) {
+            *error_string = "Truncated header.";
+            return false;
+        }
+
+        if (readWord(data) != static_cast<quint32>(AddressIndex::Magic)) {
+            *error_string = "Not an address index.";
+            return false;
+        }
+
+        if (readWord(data + 4) != static_cast<quint32>(AddressIndex::Version)) {
+            *error_string = QString("Unsupported version %1.").arg(readWord(data + 4));
+            return false;
+        }
+
+        const quint32 count(readWord(data + 8));
+        const quint32 string_size(readWord(data + 12));
+        const qint64 offsets_size((qint64(count) + 1) * 4);
+        const qint64 records_size(qint64(count) * RecordWords * 4);
+        const qint64 expected_size(HeaderWords * 4 + offsets_size + records_size
+                                   + padded(qint64(string_size) * 2));
+
+        if (size != expected_size) {
+            *error_string = QString("Expected %1 bytes, got %2.").arg(expected_size).arg(size);
+            return false;
+        }
+
+        const uchar *const offsets(data + HeaderWords * 4);
+        quint32 previous(0);
+
+        for (quint32 index = 0; index <= count; ++index) {
+            const quint32 offset(readWord(offsets + qint64(index) * 4));
+
+            if (offset < previous or (index == 0 and offset != 0) or offset > string_size
+                or (index == count and offset != string_size)) {
+                *error_string = "Invalid offset table.";
+                return false;
+            }
+
+            previous = offset;
+        }
+
+        m_count = count;
+        m_string_size = string_size;
+        m_offsets = offsets;
+        m_records = offsets + offsets_size;
+        m_strings = m_records + records_size;
+        return true;
+    }
+
+    quint32 count() const
+    {
+        return m_count;
+    }
+
+    QString key(quint32 index) const
+    {
+        const quint32 begin(readWord(m_offsets + qint64(index) * 4));
+        const quint32 end(readWord(m_offsets + (qint64(index) + 1) * 4));
+        QString result(end - begin, Qt::Uninitialized);
+
+        for (quint32 unit = begin; unit < end; ++unit) {
+            result[unit - begin] = QChar(qFromLittleEndian<quint16>(m_strings + qint64(unit) * 2));
+        }
+
+        return result;
+    }
+
+    AddressEntry entry(quint32 index) const
+    {
+        const uchar *const record(m_records + qint64(index) * RecordWords * 4);
+        AddressEntry result;
+        result.score = readWord(record);
+        result.last_used = readWord(record + 4);
+        result.kind = readWord(record + 8);
+        return result;
+    }
+
+    //! @returns index of the first key not less than word.
+    quint32 lowerBound(const QString &word) const
+    {
+        quint32 first(0);
+        quint32 last(m_count);
+
+        while (first < last) {
+            const quint32 middle(first + (last - first) / 2);
+
+            if (compare(middle, word, false) < 0) {
+                first = middle + 1;
+            } else {
+                last = middle;
+            }
+        }
+
+        return first;
+    }
+
+    bool startsWith(quint32 index,
+                    const QString &prefix) const
+    {
+        return (compare(index, prefix, true) == 0);
+    }
+
+    bool find(const QString &key,
+              AddressEntry *entry) const
+    {
+        const quint32 index(lowerBound(key));
+
+        if (index >= m_count or compare(index, key, false) != 0) {
+            return false;
+        }
+
+        *entry = this->entry(index);
+        return true;
+    }
+
+private:
+    int compare(quint32 index,
+                const QString &word,
+                bool prefix_only) const
+    {
+        const quint32 begin(readWord(m_offsets + qint64(index) * 4));
+        const int length(readWord(m_offsets + (qint64(index) + 1) * 4) - begin);
+        const int common(qMin(length, word.length()));
+
+        for (int unit = 0; unit < common; ++unit) {
+            const ushort key_unit(qFromLittleEndian<quint16>(m_strings + (qint64(begin) + unit) * 2));
+            const ushort word_unit(word.at(unit).unicode());
+
+            if (key_unit != word_unit) {
+                return (key_unit < word_unit ? -1 : 1);
+            }
+        }
+
+        if (prefix_only and length >= word.length()) {
+            return 0;
+        }
+
+        return (length < word.length() ? -1 : (length > word.length() ? 1 : 0));
+    }
+};
+
+} // namespace
+
+//! \class AddressIndex
+//! \brief Remembers committed web and email addresses, and their host
+//! names, to complete them in URL and email fields.
+//!
+//! Each entry counts its uses, with a decay: a use counts half after
+//! HalfLife seconds. The index is a compact, sorted file that is memory
+//! mapped, so completions are a binary search for the prefix range. Learned
+//! addresses are kept in memory until CompactionThreshold of them are
+//! collected. A compaction then merges them into a new index, drops rarely
+//! used entries and keeps at most MaxEntries. Compactions run on a writer
+//! thread, which swaps the new index in and writes it.
+
+//! \internal
+struct AddressIndexPrivate
+{
+    const QString file_name;
+    //! Guards everything but file_name and writer. Only the writer replaces
+    //! the index, so it reads the index without locking.
+    mutable QMutex mutex;
+    QFile file;
+    uchar *mapped; //!< Contents of file, until the first compaction.
+    QByteArray compiled; //!< Index built by the last compaction.
+    AddressIndexReader reader;
+    QHash<QString, AddressEntry> learned; //!< Entries learned since the index was built.
+    bool compaction_scheduled;
+    QThreadPool writer; //!< Declared last, so that writes finish first.
+
+    explicit AddressIndexPrivate(const QString &new_file_name);
+    ~AddressIndexPrivate();
+
+    bool find(const QString &key,
+              AddressEntry *entry) const;
+    void use(const QString &key,
+             quint32 kinds,
+             quint32 time);
+    void compact(quint32 time);
+    void unmap();
+};
+
+
+namespace {
+
+//! Compacts the index on the writer thread.
+class CompactionJob
+    : public QRunnable
+{
+private:
+    AddressIndexPrivate *const d;
+    const quint32 m_time;
+
+public:
+    explicit CompactionJob(AddressIndexPrivate *address_index,
+                           quint32 time)
+        : d(address_index)
+        , m_time(time)
+    {}
+
+    void run()
+    {
+        d->compact(m_time);
+    }
+};
+
+} // namespace
+
+
+AddressIndexPrivate::AddressIndexPrivate(const QString &new_file_name)
+    : file_name(new_file_name)
+    , mutex()
+    , file(new_file_name)
+    , mapped(0)
+    , compiled()
+    , reader()
+    , learned()
+    , compaction_scheduled(false)
+    , writer()
+{
+    // A single writer keeps the index file consistent:
+    writer.setMaxThreadCount(1);
+
+    if (file_name.isEmpty() or file.size() <= 0 or not file.open(QFile::ReadOnly)) {
+        return;
+    }
+
+    mapped = file.map(0, file.size());
+
+    // Some file systems do not support mapping:
+    if (not mapped) {
+        compiled = file.readAll();
+    }
+
+    const uchar *const data(mapped ? mapped : reinterpret_cast<const uchar *>(compiled.constData()));
+    QString error_string;
+
+    if (not reader.read(data, mapped ? file.size() : compiled.size(), &error_string)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Invalid address index:" << file_name
+                   << "error:" << error_string;
+        unmap();
+    }
+}
+
+
+AddressIndexPrivate::~AddressIndexPrivate()
+{
+    unmap();
+}
+
+
+bool AddressIndexPrivate::find(const QString &key,
+                               AddressEntry *entry) const
+{
+    const QHash<QString, AddressEntry>::const_iterator it(learned.find(key));
+
+    if (it != learned.constEnd()) {
+        *entry = it.value();
+        return true;
+    }
+
+    return reader.find(key, entry);
+}
+
+
+void AddressIndexPrivate::use(const QString &key,
+                              quint32 kinds,
+                              quint32 time)
+{
+    AddressEntry entry;
+
+    if (not find(key, &entry)) {
+        entry.score = 0;
+        entry.last_used = time;
+        entry.kind = AddressIndex::NoAddress;
+    }
+
+    entry.score = quint32(qMin<quint64>(quint64(decayed(entry, time)) + ScorePerUse, 0xffffffff));
+    entry.last_used = qMax(entry.last_used, time);
+    entry.kind |= kinds;
+    learned.insert(key, entry);
+}
+
+
+//! Merges the learned entries into a new index, and writes it. Runs on the
+//! writer thread, and only locks to take the learned entries and to swap the
+//! new index in.
+void AddressIndexPrivate::compact(quint32 time)
+{
+    QVector<RankedAddress> ranked;
+    QHash<QString, AddressEntry> merged;
+
+    {
+        QMutexLocker locker(&mutex);
+        merged = learned;
+    }
+
+    QHash<QString, AddressEntry> entries(merged);
+
+    for (quint32 index = 0; index < reader.count(); ++index) {
+        const QString &key(reader.key(index));
+
+        if (not entries.contains(key)) {
+            entries.insert(key, reader.entry(index));
+        }
+    }
+
+    for (QHash<QString, AddressEntry>::const_iterator it = entries.constBegin(); it != entries.constEnd(); ++it) {
+        const quint32 score(decayed(it.value(), time));
+
+        if (score >= MinScore) {
+            ranked.append(RankedAddress(score, it.key()));
+        }
+    }
+
+    std::sort(ranked.begin(), ranked.end(), isMoreUsed);
+
+    if (ranked.count() > AddressIndex::MaxEntries) {
+        ranked.resize(AddressIndex::MaxEntries);
+    }
+
+    // Scores get decayed until now, so that they stay comparable:
+    QMap<QString, AddressEntry> kept;
+
+    Q_FOREACH (const RankedAddress &address, ranked) {
+        AddressEntry entry(entries.value(address.second));
+        entry.score = address.first;
+        entry.last_used = qMax(entry.last_used, time);
+        kept.insert(address.second, entry);
+    }
+
+    const QByteArray &data(compile(kept));
+
+    {
+        QMutexLocker locker(&mutex);
+        unmap();
+        compiled = data;
+
+        QString error_string;
+        reader.read(reinterpret_cast<const uchar *>(compiled.constData()), compiled.size(), &error_string);
+
+        // Entries learned again while compacting stay:
+        for (QHash<QString, AddressEntry>::const_iterator it = merged.constBegin(); it != merged.constEnd(); ++it) {
+            const QHash<QString, AddressEntry>::iterator learned_it(learned.find(it.key()));
+
+            if (learned_it != learned.end()
+                and learned_it->score == it->score
+                and learned_it->last_used == it->last_used
+                and learned_it->kind == it->kind) {
+                learned.erase(learned_it);
+            }
+        }
+
+        compaction_scheduled = false;
+    }
+
+    if (file_name.isEmpty()) {
+        return;
+    }
+
+    // The index file gets replaced atomically:
+    QDir().mkpath(QFileInfo(file_name).absolutePath());
+    QSaveFile index_file(file_name);
+
+    if (not index_file.open(QFile::WriteOnly)
+        or index_file.write(data) != data.size()
+        or not index_file.commit()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << ": Failed to write" << file_name << ":" << index_file.errorString();
+    }
+}
+
+
+void AddressIndexPrivate::unmap()
+{
+    reader = AddressIndexReader();
+    compiled.clear();
+
+    if (mapped) {
+        file.unmap(mapped);
+        mapped = 0;
+    }
+
+    file.close();
+}
+//! \internal_end
+
+
+//! \param file_name The index file. Can be empty for an index that is not
+//!                  stored.
+AddressIndex::AddressIndex(const QString &file_name)
+    : d_ptr(new AddressIndexPrivate(file_name))
+{}
+
+
+//! \brief Destructor. Writes learned entries.
+AddressIndex::~AddressIndex()
+{
+    flush();
+}
+
+
+//! @returns the index file.
+QString AddressIndex::fileName() const
+{
+    Q_D(const AddressIndex);
+    return d->file_name;
+}
+
+
+//! @returns the number of entries, including rarely used ones that the next
+//!          compaction might drop.
+int AddressIndex::count() const
+{
+    Q_D(const AddressIndex);
+    QMutexLocker locker(&d->mutex);
+    int result(d->reader.count());
+
+    for (QHash<QString, AddressEntry>::const_iterator it = d->learned.constBegin(); it != d->learned.constEnd(); ++it) {
+        AddressEntry entry;
+
+        if (not d->reader.find(it.key(), &entry)) {
+            ++result;
+        }
+    }
+
+    return result;
+}
+
+
+//! \brief Counts a use of an address, and of its host name.
+//! \param address The committed text. Ignored, unless it looks like a web
+//!                or email address.
+//! \param time Time of use.
+void AddressIndex::learn(const QString &address,
+                         const QDateTime &time)
+{
+    Q_D(AddressIndex);
+
+    const QString &key(address.trimmed().toLower());
+    const Kind address_kind(kind(key));
+
+    if (address_kind == NoAddress) {
+        return;
+    }
+
+    const QString &host(hostName(key));
+    const quint32 now(seconds(time));
+    QMutexLocker locker(&d->mutex);
+
+    // Addresses that are host names, like "example.com", complete both:
+    if (host == key) {
+        d->use(key, address_kind | HostName, now);
+    } else {
+        d->use(key, address_kind, now);
+
+        if (not host.isEmpty()) {
+            d->use(host, HostName, now);
+        }
+    }
+
+    if (d->learned.count() >= CompactionThreshold and not d->compaction_scheduled) {
+        d->compaction_scheduled = true;
+        d->writer.start(new CompactionJob(d, now));
+    }
+}
+
+
+//! \brief Completes a prefix with known entries.
+//! \param prefix The prefix, case is ignored.
+//! \param kinds Combination of the kinds of entries to complete with.
+//! \param limit Maximum number of completions.
+//! \param time Time to decay scores until.
+//! @returns the completions, lower cased and most used first.
+QStringList AddressIndex::complete(const QString &prefix,
+                                   int kinds,
+                                   int limit,
+                                   const QDateTime &time) const
+{
+    Q_D(const AddressIndex);
+
+    QStringList result;
+
+    if (limit <= 0) {
+        return result;
+    }
+
+    const QString &key_prefix(prefix.trimmed().toLower());
+    const quint32 now(seconds(time));
+    QVector<RankedAddress> ranked;
+    QMutexLocker locker(&d->mutex);
+
+    for (quint32 index = d->reader.lowerBound(key_prefix);
+         index < d->reader.count() and d->reader.startsWith(index, key_prefix);
+         ++index) {
+        const AddressEntry &entry(d->reader.entry(index));
+
+        if (entry.kind & kinds) {
+            const QString &key(d->reader.key(index));
+
+            if (not d->learned.contains(key)) {
+                ranked.append(RankedAddress(decayed(entry, now), key));
+            }
+        }
+    }
+
+    for (QHash<QString, AddressEntry>::const_iterator it = d->learned.constBegin(); it != d->learned.constEnd(); ++it) {
+        if ((it.value().kind & kinds) and it.key().startsWith(key_prefix)) {
+            ranked.append(RankedAddress(decayed(it.value(), now), it.key()));
+        }
+    }
+
+    locker.unlock();
+    std::sort(ranked.begin(), ranked.end(), isMoreUsed);
+
+    for (int index = 0; index < qMin(limit, ranked.count()); ++index) {
+        result.append(ranked.at(index).second);
+    }
+
+    return result;
+}
+
+
+//! \brief Merges learned entries into a new index, and waits until it is
+//! written.
+//! \param time Time to decay scores until.
+void AddressIndex::compact(const QDateTime &time)
+{
+    Q_D(AddressIndex);
+    d->writer.start(new CompactionJob(d, seconds(time)));
+    d->writer.waitForDone();
+}
+
+
+//! \brief Writes learned entries and waits until they are written.
+void AddressIndex::flush()
+{
+    Q_D(AddressIndex);
+    d->writer.waitForDone();
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (d->learned.isEmpty()) {
+            return;
+        }
+    }
+
+    compact();
+}
+
+
+//! @returns the kind of address, WebAddress, EmailAddress or NoAddress for
+//!          text that does not look like one.
+AddressIndex::Kind AddressIndex::kind(const QString &address)
+{
+    if (address.isEmpty() or address.startsWith('.') or address.endsWith('.')) {
+        return NoAddress;
+    }
+
+    Q_FOREACH (const QChar &c, address) {
+        if (c.isSpace()) {
+            return NoAddress;
+        }
+    }
+
+    const int at(address.indexOf('@'));
+    const bool has_scheme(address.contains("://"));
+
+    if (at > 0 and not has_scheme and not address.contains('/') and address.indexOf('.', at) > at + 1) {
+        return EmailAddress;
+    }
+
+    if (has_scheme or address.indexOf('.') > 0) {
+        return WebAddress;
+    }
+
+    return NoAddress;
+}
+
+
+//! @returns the lower cased host name of a web or email address, or an
+//!          empty string for other text.
+QString AddressIndex::hostName(const QString &address)
+{
+    QString host(address.trimmed().toLower());
+
+    switch (kind(host)) {
+    case EmailAddress:
+        return host.mid(host.lastIndexOf('@') + 1);
+
+    case WebAddress:
+        break;
+
+    default:
+        return QString();
+    }
+
+    const int scheme(host.indexOf("://"));
+
+    if (scheme >= 0) {
+        host.remove(0, scheme + 3);
+    }
+
+    for (int index = 0; index < host.length(); ++index) {
+        const QChar c(host.at(index));
+
+        if (c == '/' or c == '?' or c == '#') {
+            host.truncate(index);
+            break;
+        }
+    }
+
+    // Drop credentials and port:
+    host.remove(0, host.lastIndexOf('@') + 1);
+    const int port(host.lastIndexOf(':'));
+
+    if (port >= 0) {
+        host.truncate(port);
+    }
+
+    return host;
+}
+
+}} // namespace Logic, MaliitKeyboard
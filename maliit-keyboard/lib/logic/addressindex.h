@@ -0,0 +1,90 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_ADDRESSINDEX_H
+#define MALIIT_KEYBOARD_ADDRESSINDEX_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class AddressIndexPrivate;
+
+class AddressIndex
+{
+    Q_DISABLE_COPY(AddressIndex)
+    Q_DECLARE_PRIVATE(AddressIndex)
+
+public:
+    //! Kinds of entries, can be combined to filter completions.
+    enum Kind {
+        NoAddress = 0,
+        WebAddress = 1, //!< Web address, as committed.
+        EmailAddress = 2, //!< Email address, as committed.
+        HostName = 4, //!< Host name of a committed web or email address.
+        AnyKind = WebAddress | EmailAddress | HostName
+    };
+
+    enum {
+        Magic = 0x4941474d, // "MGAI"
+        Version = 1,
+        HalfLife = 2592000, //!< Seconds after which a use counts half, 30 days.
+        MaxEntries = 2048, //!< Entries kept by a compaction, most used first.
+        CompactionThreshold = 32 //!< Learned entries that trigger a compaction.
+    };
+
+    explicit AddressIndex(const QString &file_name);
+    ~AddressIndex();
+
+    QString fileName() const;
+    int count() const;
+
+    void learn(const QString &address,
+               const QDateTime &time = QDateTime::currentDateTimeUtc());
+    QStringList complete(const QString &prefix,
+                         int kinds,
+                         int limit,
+                         const QDateTime &time = QDateTime::currentDateTimeUtc()) const;
+    void compact(const QDateTime &time = QDateTime::currentDateTimeUtc());
+    void flush();
+
+    static Kind kind(const QString &address);
+    static QString hostName(const QString &address);
+
+private:
+    const QScopedPointer<AddressIndexPrivate> d_ptr;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_ADDRESSINDEX_H
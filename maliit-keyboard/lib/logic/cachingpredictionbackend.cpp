@@ -0,0 +1,155 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "cachingpredictionbackend.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \class CachingPredictionBackend
+//! \brief A word prediction backend that caches its prediction pools per
+//! preedit.
+//!
+//! Pools are cached as long as the words left of the preedit do not change.
+//! A preedit seen before (for instance, after backspace) is served from the
+//! cache. When a character is appended, the pool of the shorter preedit is
+//! filtered by the new preedit, keeping its ranking, and only if too few
+//! predictions remain, the predictor is queried again. The pool of the empty
+//! preedit comes from next word predictions.
+//!
+//! Derived classes implement the predictor, see setPredictionContext() and
+//! predict(). Both are called with the cache locked, so the predictor needs
+//! no guard of its own.
+
+//! \fn void CachingPredictionBackend::setPredictionContext(const QStringList &context)
+//! \brief Starts a new prediction context.
+//! \param context Words left of the preedit, see Model::Text::context().
+
+//! \fn QStringList CachingPredictionBackend::predict(const QString &preedit, int pool_size)
+//! \brief Returns up to pool_size predictions for preedit, best first,
+//! within the current prediction context.
+
+
+//! \param cost_class How long the predictor takes to answer.
+CachingPredictionBackend::CachingPredictionBackend(CostClass cost_class)
+    : WordEngineBackend(cost_class)
+    , m_mutex()
+    , m_cache_context()
+    , m_cache_max_candidates(0)
+    , m_cache()
+{}
+
+
+CachingPredictionBackend::~CachingPredictionBackend()
+{}
+
+
+//! \brief Returns the prediction pool for a preedit, best first.
+//! \param context Words left of the preedit. Another context than in the
+//!                previous call drops the cache.
+//! \param preedit The preedit, or an empty string for next word predictions.
+//! \param max_candidates The number of shown candidates. The pool holds up
+//!                       to PredictionPoolFactor times as many.
+QStringList CachingPredictionBackend::predictions(const QStringList &context,
+                                                  const QString &preedit,
+                                                  int max_candidates)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (context != m_cache_context || max_candidates != m_cache_max_candidates) {
+        m_cache.clear();
+        m_cache_context = context;
+        m_cache_max_candidates = max_candidates;
+        setPredictionContext(context);
+    }
+
+    for (int index = 0; index < m_cache.count(); ++index) {
+        if (m_cache.at(index).preedit == preedit) {
+            return m_cache.at(index).predictions;
+        }
+    }
+
+    PrefixCacheEntry entry;
+    entry.preedit = preedit;
+
+    // Word probabilities do not change when the prefix grows, so filtering
+    // the previous prediction pool keeps it ranked:
+    if (not preedit.isEmpty()) {
+        const QString &previous_preedit(preedit.left(preedit.length() - 1));
+
+        for (int index = 0; index < m_cache.count(); ++index) {
+            if (m_cache.at(index).preedit == previous_preedit) {
+                Q_FOREACH (const QString &prediction, m_cache.at(index).predictions) {
+                    if (prediction.startsWith(preedit, Qt::CaseInsensitive)) {
+                        entry.predictions.append(prediction);
+                    }
+                }
+
+                break;
+            }
+        }
+    }
+
+    if (entry.predictions.count() < max_candidates) {
+        entry.predictions = predict(preedit, PredictionPoolFactor * max_candidates);
+    }
+
+    m_cache.prepend(entry);
+
+    while (m_cache.count() > MaxCachedPrefixes) {
+        m_cache.removeLast();
+    }
+
+    return entry.predictions;
+}
+
+
+//! \brief Drops all cached prediction pools.
+void CachingPredictionBackend::clearPredictions()
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_cache.clear();
+    // Forces a new prediction context for the next request:
+    m_cache_max_candidates = 0;
+}
+
+
+//! \brief Drops the cached prediction pools, as predictors might learn
+//! from the user dictionary.
+void CachingPredictionBackend::addToUserDictionary(const QString &word)
+{
+    Q_UNUSED(word);
+    clearPredictions();
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,90 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_CACHINGPREDICTIONBACKEND_H
+#define MALIIT_KEYBOARD_CACHINGPREDICTIONBACKEND_H
+
+#include "wordenginebackend.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+class CachingPredictionBackend
+    : public WordEngineBackend
+{
+    Q_DISABLE_COPY(CachingPredictionBackend)
+
+public:
+    enum {
+        MaxCachedPrefixes = 32, //!< Preedits whose predictions are kept.
+        //! Predictions requested from the predictor, per shown candidate.
+        //! Larger than one, so that growing preedits can be served by
+        //! filtering.
+        PredictionPoolFactor = 3
+    };
+
+    explicit CachingPredictionBackend(CostClass cost_class);
+    virtual ~CachingPredictionBackend();
+
+    QStringList predictions(const QStringList &context,
+                            const QString &preedit,
+                            int max_candidates);
+    void clearPredictions();
+
+    //! \reimp
+    virtual void addToUserDictionary(const QString &word);
+    //! \reimp_end
+
+protected:
+    virtual void setPredictionContext(const QStringList &context) = 0;
+    virtual QStringList predict(const QString &preedit,
+                                int pool_size) = 0;
+
+private:
+    //! Predictions for one preedit, within the current context.
+    struct PrefixCacheEntry
+    {
+        QString preedit;
+        QStringList predictions; //!< Prediction pool, best first.
+    };
+
+    QMutex m_mutex; //!< guards the predictor and the cache.
+    QStringList m_cache_context; //!< context words the cached prefixes belong to.
+    int m_cache_max_candidates; //!< number of candidates the cached prefixes got.
+    QList<PrefixCacheEntry> m_cache; //!< most recently computed first.
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_CACHINGPREDICTIONBACKEND_H
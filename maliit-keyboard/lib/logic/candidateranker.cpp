@@ -0,0 +1,179 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "candidateranker.h"
+
+#include <algorithm>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \param limit Number of candidates to keep.
+CandidateRanker::CandidateRanker(int limit)
+    : m_limit(qMax(limit, 0))
+    , m_mutex()
+    , m_sequence(0)
+    , m_heap()
+    , m_costs()
+{
+    m_heap.reserve(m_limit + 1);
+}
+
+
+//! @returns the number of candidates that are kept.
+int CandidateRanker::limit() const
+{
+    return m_limit;
+}
+
+
+//! @returns the number of candidates kept so far.
+int CandidateRanker::count() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_heap.count();
+}
+
+
+//! \brief Offers a candidate.
+//! \param source The source of the candidate.
+//! \param word The candidate.
+//! \param cost The cost of the candidate. Lower costs rank first, equal
+//!             costs in the order they were added.
+//!
+//! Adding a word that was added before only lowers its cost, and takes the
+//! source of the better offer.
+void CandidateRanker::add(WordCandidate::Source source,
+                          const QString &word,
+                          int cost)
+{
+    if (word.isEmpty() or m_limit == 0) {
+        return;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    const QHash<QString, int>::iterator offered(m_costs.find(word));
+
+    if (offered != m_costs.end()) {
+        if (offered.value() <= cost) {
+            return;
+        }
+
+        offered.value() = cost;
+
+        // Better offers replace the kept one, if any. The heap holds only a
+        // few candidates, so a linear scan is cheap:
+        for (int index = 0; index < m_heap.count(); ++index) {
+            if (m_heap.at(index).word == word) {
+                m_heap.remove(index);
+                std::make_heap(m_heap.begin(), m_heap.end(), isBetter);
+                break;
+            }
+        }
+    } else {
+        m_costs.insert(word, cost);
+    }
+
+    Entry entry;
+    entry.cost = cost;
+    entry.sequence = m_sequence++;
+    entry.source = source;
+    entry.word = word;
+
+    if (m_heap.count() == m_limit) {
+        if (not isBetter(entry, m_heap.first())) {
+            return;
+        }
+
+        std::pop_heap(m_heap.begin(), m_heap.end(), isBetter);
+        m_heap.removeLast();
+    }
+
+    m_heap.append(entry);
+    std::push_heap(m_heap.begin(), m_heap.end(), isBetter);
+}
+
+
+//! \brief Drops the kept candidates of a source.
+//! \param source The source, for instance one whose results turned out to
+//!               be irrelevant.
+//!
+//! Dropped words, as well as words that did not make it into the best
+//! candidates, can be added again.
+void CandidateRanker::discard(WordCandidate::Source source)
+{
+    QMutexLocker locker(&m_mutex);
+    m_costs.clear();
+
+    for (int index = m_heap.count() - 1; index >= 0; --index) {
+        if (m_heap.at(index).source == source) {
+            m_heap.remove(index);
+        } else {
+            m_costs.insert(m_heap.at(index).word, m_heap.at(index).cost);
+        }
+    }
+
+    std::make_heap(m_heap.begin(), m_heap.end(), isBetter);
+}
+
+
+//! @returns the kept candidates, best first.
+WordCandidateList CandidateRanker::candidates() const
+{
+    QVector<Entry> entries;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        entries = m_heap;
+    }
+
+    std::sort(entries.begin(), entries.end(), isBetter);
+
+    WordCandidateList result;
+    Q_FOREACH (const Entry &entry, entries) {
+        result.append(WordCandidate(entry.source, entry.word));
+    }
+
+    return result;
+}
+
+
+//! \brief Orders entries best first. As heap order, it keeps the worst
+//! entry on top.
+bool CandidateRanker::isBetter(const Entry &entry,
+                               const Entry &other)
+{
+    return entry.cost < other.cost
+           or (entry.cost == other.cost and entry.sequence < other.sequence);
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,91 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_CANDIDATERANKER_H
+#define MALIIT_KEYBOARD_CANDIDATERANKER_H
+
+#include "models/wordcandidate.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \brief Merges scored word candidates of several sources into the best
+//! few.
+//!
+//! Each source adds words with a cost, lower being better. A word offered
+//! by several sources is kept once, with its lowest cost. Only the best
+//! limit() candidates are kept, in a heap. Sources may add candidates from
+//! several threads at once, for instance as soon as their results are
+//! ready.
+class CandidateRanker
+{
+    Q_DISABLE_COPY(CandidateRanker)
+
+public:
+    explicit CandidateRanker(int limit);
+
+    int limit() const;
+    int count() const;
+
+    void add(WordCandidate::Source source,
+             const QString &word,
+             int cost);
+    void discard(WordCandidate::Source source);
+
+    WordCandidateList candidates() const;
+
+private:
+    //! \internal
+    struct Entry
+    {
+        int cost;
+        int sequence; //!< Breaks ties between equal costs, first added first.
+        WordCandidate::Source source;
+        QString word;
+    };
+
+    static bool isBetter(const Entry &entry,
+                         const Entry &other);
+    //! \internal_end
+
+    const int m_limit;
+    mutable QMutex m_mutex;
+    int m_sequence;
+    QVector<Entry> m_heap; //!< Kept candidates, the worst one first.
+    QHash<QString, int> m_costs; //!< Lowest cost of each word added so far.
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_CANDIDATERANKER_H
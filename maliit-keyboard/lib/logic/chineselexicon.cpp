@@ -0,0 +1,468 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "chineselexicon.h"
+
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+
+#include <cmath>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+const int HeaderWords = 6;
+
+enum CodeField {
+    CodeOffset,
+    CodeLength,
+    CodeFirstEntry,
+    CodeEntryCount,
+    CodeWords
+};
+
+enum EntryField {
+    EntryOffset,
+    EntryLength,
+    EntryCost,
+    EntryWords
+};
+
+void appendWord(QByteArray *data,
+                quint32 value)
+{
+    uchar buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    data->append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+quint32 readWord(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+ushort readUnit(const uchar *data)
+{
+    return qFromLittleEndian<quint16>(data);
+}
+
+//! \internal
+//! A text of an input code, only used while compiling.
+struct CompiledEntry
+{
+    QString text;
+    quint32 cost;
+
+    bool operator<(const CompiledEntry &other) const
+    {
+        return (cost != other.cost ? cost < other.cost
+                                   : text < other.text);
+    }
+};
+//! \internal_end
+
+} // namespace
+
+
+//! \brief Serializes a conversion table.
+QByteArray ChineseLexicon::compile(const QHash<QString, QHash<QString, quint32> > &frequencies)
+{
+    typedef QHash<QString, QHash<QString, quint32> >::const_iterator CodeIterator;
+    typedef QHash<QString, quint32>::const_iterator TextIterator;
+
+    double total(0);
+    QStringList codes;
+
+    for (CodeIterator it = frequencies.constBegin(); it != frequencies.constEnd(); ++it) {
+        if (it.key().isEmpty()) {
+            continue;
+        }
+
+        codes.append(it.key());
+
+        for (TextIterator text = it.value().constBegin(); text != it.value().constEnd(); ++text) {
+            total += qMax<quint32>(1, text.value());
+        }
+    }
+
+    // QString::operator< compares UTF-16 units, as the reader does:
+    qSort(codes);
+
+    QVector<quint32> code_table;
+    QVector<quint32> entry_table;
+    QString units;
+    quint32 max_code_length(0);
+
+    Q_FOREACH (const QString &code, codes) {
+        const QHash<QString, quint32> &texts(frequencies.value(code));
+        QVector<CompiledEntry> entries;
+
+        for (TextIterator text = texts.constBegin(); text != texts.constEnd(); ++text) {
+            if (text.key().isEmpty()) {
+                continue;
+            }
+
+            CompiledEntry entry;
+            entry.text = text.key();
+            entry.cost = qRound(CostScale * std::log(total / qMax<quint32>(1, text.value())));
+            entries.append(entry);
+        }
+
+        if (entries.isEmpty()) {
+            continue;
+        }
+
+        qSort(entries);
+
+        code_table.append(units.length());
+        code_table.append(code.length());
+        code_table.append(entry_table.size() / EntryWords);
+        code_table.append(entries.size());
+        units.append(code);
+        max_code_length = qMax<quint32>(max_code_length, code.length());
+
+        Q_FOREACH (const CompiledEntry &entry, entries) {
+            entry_table.append(units.length());
+            entry_table.append(entry.text.length());
+            entry_table.append(entry.cost);
+            units.append(entry.text);
+        }
+    }
+
+    QByteArray result;
+    result.reserve((HeaderWords + code_table.size() + entry_table.size()) * 4 + units.length() * 2);
+
+    appendWord(&result, Magic);
+    appendWord(&result, Version);
+    appendWord(&result, code_table.size() / CodeWords);
+    appendWord(&result, entry_table.size() / EntryWords);
+    appendWord(&result, units.length());
+    appendWord(&result, max_code_length);
+
+    Q_FOREACH (quint32 value, code_table) {
+        appendWord(&result, value);
+    }
+
+    Q_FOREACH (quint32 value, entry_table) {
+        appendWord(&result, value);
+    }
+
+    for (int index = 0; index < units.length(); ++index) {
+        uchar buffer[2];
+        qToLittleEndian<quint16>(units.at(index).unicode(), buffer);
+        result.append(reinterpret_cast<const char *>(buffer), 2);
+    }
+
+    return result;
+}
+
+
+QString ChineseLexicon::fileSuffix()
+{
+    return QString::fromLatin1(".lexicon");
+}
+
+
+//! \class ChineseLexiconReader
+//! \brief Looks up input codes in a compiled conversion table.
+
+ChineseLexiconReader::ChineseLexiconReader(const uchar *data,
+                                           qint64 size)
+    : m_data(data)
+    , m_code_count(0)
+    , m_entry_count(0)
+    , m_unit_count(0)
+    , m_max_code_length(0)
+    , m_codes(0)
+    , m_entries(0)
+    , m_units(0)
+    , m_error_string()
+{
+    if (not m_data or size < HeaderWords * 4) {
+        error("Truncated header.");
+        return;
+    }
+
+    if (readWord(m_data) != static_cast<quint32>(ChineseLexicon::Magic)) {
+        error("Not a compiled conversion table.");
+        return;
+    }
+
+    if (readWord(m_data + 4) != static_cast<quint32>(ChineseLexicon::Version)) {
+        error(QString("Unsupported version %1.").arg(readWord(m_data + 4)));
+        return;
+    }
+
+    m_code_count = readWord(m_data + 8);
+    m_entry_count = readWord(m_data + 12);
+    m_unit_count = readWord(m_data + 16);
+    m_max_code_length = readWord(m_data + 20);
+
+    const qint64 expected_size((HeaderWords + qint64(m_code_count) * CodeWords
+                                + qint64(m_entry_count) * EntryWords) * 4
+                               + qint64(m_unit_count) * 2);
+
+    if (size != expected_size) {
+        error(QString("Expected %1 bytes, got %2.").arg(expected_size).arg(size));
+        return;
+    }
+
+    m_codes = m_data + HeaderWords * 4;
+    m_entries = m_codes + qint64(m_code_count) * CodeWords * 4;
+    m_units = m_entries + qint64(m_entry_count) * EntryWords * 4;
+
+    for (quint32 code = 0; code < m_code_count; ++code) {
+        const quint32 length(codeField(code, CodeLength));
+
+        if (length == 0 or length > m_max_code_length
+            or qint64(codeField(code, CodeOffset)) + length > m_unit_count) {
+            error(QString("Invalid input code %1.").arg(code));
+            return;
+        }
+
+        if (codeField(code, CodeEntryCount) == 0
+            or qint64(codeField(code, CodeFirstEntry)) + codeField(code, CodeEntryCount) > m_entry_count) {
+            error(QString("Invalid entries of input code %1.").arg(code));
+            return;
+        }
+
+        // Lookups use binary search:
+        if (code > 0 and not codeLessThan(code - 1, code)) {
+            error(QString("Input code %1 is not sorted.").arg(code));
+            return;
+        }
+    }
+
+    for (quint32 entry = 0; entry < m_entry_count; ++entry) {
+        if (qint64(entryField(entry, EntryOffset)) + entryField(entry, EntryLength) > m_unit_count) {
+            error(QString("Invalid text of entry %1.").arg(entry));
+            return;
+        }
+    }
+}
+
+
+bool ChineseLexiconReader::isValid() const
+{
+    return m_error_string.isEmpty();
+}
+
+
+const QString ChineseLexiconReader::errorString() const
+{
+    return m_error_string;
+}
+
+
+int ChineseLexiconReader::codeCount() const
+{
+    return isValid() ? m_code_count : 0;
+}
+
+
+//! @returns length of the longest input code, in UTF-16 units.
+int ChineseLexiconReader::maxCodeLength() const
+{
+    return isValid() ? m_max_code_length : 0;
+}
+
+
+//! \brief Finds an input code.
+//! \param code The input code, not necessarily null terminated.
+//! \param length Length of code.
+//! @returns index of the input code, or -1 if it is not in the table.
+int ChineseLexiconReader::findCode(const QChar *code,
+                                   int length) const
+{
+    const int index(lowerBound(code, length));
+
+    if (index < codeCount() and compareCode(index, code, length) == 0) {
+        return index;
+    }
+
+    return -1;
+}
+
+
+//! @returns index of the first input code not less than code, or
+//!          codeCount() if there is none. Input codes starting with code
+//!          follow from there.
+int ChineseLexiconReader::lowerBound(const QChar *code,
+                                     int length) const
+{
+    int first(0);
+    int count(codeCount());
+
+    while (count > 0) {
+        const int step(count / 2);
+        const int middle(first + step);
+
+        if (compareCode(middle, code, length) < 0) {
+            first = middle + 1;
+            count -= step + 1;
+        } else {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+
+//! @returns whether the input code at index code starts with prefix.
+bool ChineseLexiconReader::codeStartsWith(int code,
+                                          const QChar *prefix,
+                                          int length) const
+{
+    if (code < 0 or code >= codeCount()
+        or codeField(code, CodeLength) < static_cast<quint32>(length)) {
+        return false;
+    }
+
+    const uchar *units(m_units + qint64(codeField(code, CodeOffset)) * 2);
+
+    for (int index = 0; index < length; ++index) {
+        if (readUnit(units + index * 2) != prefix[index].unicode()) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+//! @returns the input code at index code.
+QString ChineseLexiconReader::codeText(int code) const
+{
+    const uchar *units(m_units + qint64(codeField(code, CodeOffset)) * 2);
+    QString text(codeField(code, CodeLength), Qt::Uninitialized);
+
+    for (int index = 0; index < text.length(); ++index) {
+        text[index] = QChar(readUnit(units + index * 2));
+    }
+
+    return text;
+}
+
+
+//! @returns index of the cheapest entry of an input code. The entries of a
+//!          code are consecutive and sorted by cost.
+int ChineseLexiconReader::firstEntry(int code) const
+{
+    return codeField(code, CodeFirstEntry);
+}
+
+
+int ChineseLexiconReader::entryCount(int code) const
+{
+    return codeField(code, CodeEntryCount);
+}
+
+
+//! @returns the Chinese text of an entry.
+QString ChineseLexiconReader::entryText(int entry) const
+{
+    const uchar *units(m_units + qint64(entryField(entry, EntryOffset)) * 2);
+    QString text(entryField(entry, EntryLength), Qt::Uninitialized);
+
+    for (int index = 0; index < text.length(); ++index) {
+        text[index] = QChar(readUnit(units + index * 2));
+    }
+
+    return text;
+}
+
+
+//! @returns the cost of an entry, see ChineseLexicon::CostScale.
+quint32 ChineseLexiconReader::entryCost(int entry) const
+{
+    return entryField(entry, EntryCost);
+}
+
+
+//! \internal
+quint32 ChineseLexiconReader::codeField(quint32 code,
+                                        int field) const
+{
+    return readWord(m_codes + (qint64(code) * CodeWords + field) * 4);
+}
+
+
+quint32 ChineseLexiconReader::entryField(quint32 entry,
+                                         int field) const
+{
+    return readWord(m_entries + (qint64(entry) * EntryWords + field) * 4);
+}
+
+
+//! Compares an input code with key, unit by unit.
+int ChineseLexiconReader::compareCode(quint32 code,
+                                      const QChar *key,
+                                      int length) const
+{
+    const uchar *units(m_units + qint64(codeField(code, CodeOffset)) * 2);
+    const int code_length(codeField(code, CodeLength));
+    const int common(qMin(code_length, length));
+
+    for (int index = 0; index < common; ++index) {
+        const ushort unit(readUnit(units + index * 2));
+
+        if (unit != key[index].unicode()) {
+            return (unit < key[index].unicode() ? -1 : 1);
+        }
+    }
+
+    return code_length - length;
+}
+
+
+bool ChineseLexiconReader::codeLessThan(quint32 code,
+                                        quint32 other) const
+{
+    const QString &key(codeText(other));
+    return compareCode(code, key.constData(), key.length()) < 0;
+}
+
+
+void ChineseLexiconReader::error(const QString &message)
+{
+    m_error_string = message;
+    m_codes = 0;
+    m_entries = 0;
+    m_units = 0;
+}
+//! \internal_end
+
+}} // namespace Logic, MaliitKeyboard
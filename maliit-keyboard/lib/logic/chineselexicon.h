@@ -0,0 +1,133 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_CHINESELEXICON_H
+#define MALIIT_KEYBOARD_CHINESELEXICON_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \brief Compiled conversion table from input codes to Chinese text.
+//!
+//! Input codes are what the user types for a character or word: pinyin
+//! syllables (words concatenate them, as in "nihao"), bopomofo or cangjie
+//! radicals. Each code maps to one or more texts, each with a cost that is
+//! the scaled negative log probability of the text. Codes are sorted by
+//! their UTF-16 units, the texts of a code by cost. Integers are stored as
+//! little endian 32 bit words.
+class ChineseLexicon
+{
+public:
+    enum {
+        Magic = 0x584c4b4d, // "MKLX"
+        Version = 1
+    };
+
+    enum {
+        CostScale = 64 //!< Costs of texts are CostScale * ln(total frequency / frequency).
+    };
+
+    //! \brief Serializes a conversion table.
+    //! \param frequencies Texts and their frequencies, per input code.
+    //!                    Frequencies of 0 are stored as 1.
+    static QByteArray compile(const QHash<QString, QHash<QString, quint32> > &frequencies);
+    //! @returns file name suffix of compiled conversion tables.
+    static QString fileSuffix();
+};
+
+//! \brief Looks up input codes in a compiled conversion table, usually a
+//! memory mapped file.
+//!
+//! The data is validated once, when constructing the reader. Lookups never
+//! copy the table and are safe to run from several threads at once.
+class ChineseLexiconReader
+{
+    Q_DISABLE_COPY(ChineseLexiconReader)
+
+public:
+    //! \param data Compiled conversion table. Needs to stay valid for the
+    //!             lifetime of the reader.
+    //! \param size Size of data in bytes.
+    explicit ChineseLexiconReader(const uchar *data,
+                                  qint64 size);
+
+    bool isValid() const;
+    const QString errorString() const;
+
+    int codeCount() const;
+    int maxCodeLength() const;
+
+    int findCode(const QChar *code,
+                 int length) const;
+    int lowerBound(const QChar *code,
+                   int length) const;
+    bool codeStartsWith(int code,
+                        const QChar *prefix,
+                        int length) const;
+    QString codeText(int code) const;
+
+    int firstEntry(int code) const;
+    int entryCount(int code) const;
+    QString entryText(int entry) const;
+    quint32 entryCost(int entry) const;
+
+private:
+    const uchar *m_data;
+    quint32 m_code_count;
+    quint32 m_entry_count;
+    quint32 m_unit_count;
+    quint32 m_max_code_length;
+    const uchar *m_codes;
+    const uchar *m_entries;
+    const uchar *m_units;
+    QString m_error_string;
+
+    quint32 codeField(quint32 code,
+                      int field) const;
+    quint32 entryField(quint32 entry,
+                       int field) const;
+    int compareCode(quint32 code,
+                    const QChar *key,
+                    int length) const;
+    bool codeLessThan(quint32 code,
+                      quint32 other) const;
+
+    void error(const QString &message);
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_CHINESELEXICON_H
@@ -0,0 +1,254 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "chinesewordengine.h"
+#include "chineselexicon.h"
+#include "conversionlattice.h"
+#include "coreutils.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+//! Languages of the pinyin, zhuyin and cangjie layouts.
+const char *const LanguagePrefix = "zh@";
+
+} // namespace
+
+//! \class ChineseWordEngine
+//! \brief Converts pinyin, zhuyin (bopomofo) or cangjie input into Chinese
+//! characters.
+//!
+//! The preedit holds the typed input codes; candidates are conversions of
+//! the whole preedit, the cheapest one first. Conversion tables are memory
+//! mapped compiled lexicons (see ChineseLexicon), one per input method,
+//! created with the maliit-keyboard-build-lexicon tool.
+//!
+//! The conversion lattice is kept between keystrokes, so typing another
+//! input unit only computes one more lattice position. This is cheap enough
+//! to convert synchronously, on every keystroke.
+
+class ChineseWordEnginePrivate
+{
+public:
+    mutable QMutex mutex; //!< guards the lexicon, as candidates can be computed on a worker thread.
+    QFile file;
+    uchar *data;
+    QScopedPointer<ChineseLexiconReader> reader;
+    ConversionLattice lattice;
+
+    explicit ChineseWordEnginePrivate();
+    ~ChineseWordEnginePrivate();
+
+    void unload();
+};
+
+ChineseWordEnginePrivate::ChineseWordEnginePrivate()
+    : mutex()
+    , file()
+    , data(0)
+    , reader()
+    , lattice()
+{}
+
+ChineseWordEnginePrivate::~ChineseWordEnginePrivate()
+{
+    unload();
+}
+
+void ChineseWordEnginePrivate::unload()
+{
+    lattice.setInput(0, QString());
+    reader.reset();
+
+    if (data) {
+        file.unmap(data);
+        data = 0;
+    }
+
+    file.close();
+}
+
+
+//! \brief Constructor. No lexicon is loaded until a Chinese language
+//! becomes active.
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+ChineseWordEngine::ChineseWordEngine(QObject *parent)
+    : AbstractWordEngine(parent)
+    , d_ptr(new ChineseWordEnginePrivate)
+{}
+
+//! \brief Destructor.
+ChineseWordEngine::~ChineseWordEngine()
+{
+    waitForCandidates();
+}
+
+
+//! @returns path of the compiled lexicon for language, such as "zh@pinyin",
+//!          or an empty string if language is not converted.
+QString ChineseWordEngine::lexiconFile(const QString &language)
+{
+    if (not language.startsWith(QLatin1String(LanguagePrefix))
+        or language.length() == int(qstrlen(LanguagePrefix))) {
+        return QString();
+    }
+
+    QString name(language);
+    name.replace('@', '_');
+
+    return (CoreUtils::maliitKeyboardDataDirectory() + "/dictionaries/" + name + ChineseLexicon::fileSuffix());
+}
+
+
+//! \brief Replaces the lexicon by a compiled lexicon.
+//! \param file_name Path of the compiled lexicon, which gets memory mapped.
+//! @returns false if the lexicon could not be loaded, leaving the engine
+//!          without lexicon.
+bool ChineseWordEngine::loadLexicon(const QString &file_name)
+{
+    Q_D(ChineseWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    d->unload();
+    d->file.setFileName(file_name);
+
+    if (not d->file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open lexicon:" << file_name;
+        return false;
+    }
+
+    d->data = d->file.map(0, d->file.size());
+
+    if (not d->data) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not map lexicon:" << file_name;
+        d->unload();
+        return false;
+    }
+
+    d->reader.reset(new ChineseLexiconReader(d->data, d->file.size()));
+
+    if (not d->reader->isValid()) {
+        qWarning() << __PRETTY_FUNCTION__ << "Invalid lexicon:" << file_name
+                   << "error:" << d->reader->errorString();
+        d->unload();
+        return false;
+    }
+
+    return true;
+}
+
+
+//! @returns whether a lexicon is loaded.
+bool ChineseWordEngine::hasLexicon() const
+{
+    Q_D(const ChineseWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    return not d->reader.isNull();
+}
+
+
+void ChineseWordEngine::setEnabled(bool enabled)
+{
+    // Don't allow to enable word engine without lexicon:
+    if (enabled and not hasLexicon()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "No lexicon available, cannot enable word engine!";
+        enabled = false;
+    }
+
+    AbstractWordEngine::setEnabled(enabled);
+}
+
+
+//! \brief Loads the lexicon of language, and enables the engine if it
+//! could be loaded. Other languages unload the lexicon and disable the
+//! engine.
+void ChineseWordEngine::setActiveLanguage(const QString &language)
+{
+    Q_D(ChineseWordEngine);
+    const QString &file_name(lexiconFile(language));
+
+    if (file_name.isEmpty()) {
+        AbstractWordEngine::setEnabled(false);
+
+        QMutexLocker locker(&d->mutex);
+        d->unload();
+        return;
+    }
+
+    if (d->file.fileName() != file_name or not hasLexicon()) {
+        AbstractWordEngine::setEnabled(false);
+        loadLexicon(file_name);
+    }
+
+    AbstractWordEngine::setEnabled(hasLexicon());
+}
+
+
+//! \brief Returns conversions of the preedit, cheapest first.
+//!
+//! The cheapest conversion becomes the primary candidate.
+WordCandidateList ChineseWordEngine::fetchCandidates(Model::Text *text)
+{
+    WordCandidateList candidates;
+
+    Q_D(ChineseWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    const QString &preedit(text->preedit());
+
+    if (preedit.isEmpty() or not d->reader) {
+        text->setPreeditFace(Model::Text::PreeditDefault);
+        text->setPrimaryCandidate(QString());
+        return candidates;
+    }
+
+    // Pinyin codes are lower case, shifted input converts all the same:
+    d->lattice.setInput(d->reader.data(), preedit.toLower());
+
+    Q_FOREACH (const QString &conversion, d->lattice.candidates(maxCandidates())) {
+        candidates.append(WordCandidate(WordCandidate::SourcePrediction, conversion));
+    }
+
+    text->setPreeditFace(candidates.isEmpty() ? Model::Text::PreeditNoCandidates
+                                              : Model::Text::PreeditActive);
+    text->setPrimaryCandidate(candidates.isEmpty() ? QString()
+                                                   : candidates.first().label().text());
+
+    return candidates;
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,277 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "conversionlattice.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+//! Partially typed input codes completed per start position. Completions
+//! are only offered for the trailing input, this keeps them cheap.
+const int MaxCompletionCodes = 64;
+
+//! \internal
+//! A conversion of the whole input: the cheapest path to start, followed by
+//! an entry of the conversion table (or -1 for the cheapest path to the end).
+struct Conversion
+{
+    int cost;
+    int start;
+    int entry;
+
+    bool operator<(const Conversion &other) const
+    {
+        return cost < other.cost;
+    }
+};
+//! \internal_end
+
+Conversion makeConversion(int cost,
+                          int start,
+                          int entry)
+{
+    Conversion conversion;
+    conversion.cost = cost;
+    conversion.start = start;
+    conversion.entry = entry;
+    return conversion;
+}
+
+} // namespace
+
+ConversionLattice::ConversionLattice()
+    : m_reader(0)
+    , m_input()
+    , m_nodes()
+    , m_computed_positions(0)
+{
+    reset();
+}
+
+
+//! \brief Forgets the input and all computed positions.
+void ConversionLattice::reset()
+{
+    m_input.clear();
+    m_nodes.resize(1);
+    m_nodes[0].cost = 0;
+    m_nodes[0].start = -1;
+    m_nodes[0].entry = -1;
+}
+
+
+//! \brief Updates the lattice for new input.
+//! \param reader The conversion table. A different reader than last time
+//!               discards all positions.
+//! \param input The typed input codes.
+//!
+//! Only positions after the common prefix of the previous and the new input
+//! are computed.
+void ConversionLattice::setInput(const ChineseLexiconReader *reader,
+                                 const QString &input)
+{
+    if (reader != m_reader) {
+        m_reader = reader;
+        reset();
+    }
+
+    int common(0);
+    const int max_common(qMin(m_input.length(), input.length()));
+
+    while (common < max_common and m_input.at(common) == input.at(common)) {
+        ++common;
+    }
+
+    m_nodes.resize(common + 1);
+    m_input = input;
+
+    for (int position = common + 1; position <= m_input.length(); ++position) {
+        extend(position);
+    }
+}
+
+
+QString ConversionLattice::input() const
+{
+    return m_input;
+}
+
+
+//! @returns the cheapest conversion of the whole input.
+QString ConversionLattice::conversion() const
+{
+    return pathText(m_input.length());
+}
+
+
+//! \brief Returns conversions of the whole input, cheapest first.
+//! \param limit Maximum number of conversions.
+//!
+//! Each conversion follows the cheapest path up to some position, and then
+//! converts the rest of the input with one entry of the conversion table,
+//! or completes it to one. This offers alternatives for the input typed
+//! last, which is what the user looks at.
+QStringList ConversionLattice::candidates(int limit) const
+{
+    QStringList result;
+    const int end(m_input.length());
+
+    if (end == 0 or limit <= 0) {
+        return result;
+    }
+
+    QVector<Conversion> conversions;
+    conversions.append(makeConversion(m_nodes.at(end).cost, end, -1));
+
+    if (m_reader and m_reader->isValid()) {
+        for (int start = qMax(0, end - m_reader->maxCodeLength()); start < end; ++start) {
+            const QChar *const code(m_input.constData() + start);
+            const int length(end - start);
+            int index(m_reader->lowerBound(code, length));
+
+            if (index < m_reader->codeCount() and m_reader->codeStartsWith(index, code, length)) {
+                const int first(m_reader->firstEntry(index));
+                const bool is_exact(m_reader->findCode(code, length) == index);
+
+                // The exact code, if any, sorts first; all of its entries are
+                // offered, but only the cheapest one of longer codes:
+                if (is_exact) {
+                    const int count(qMin(m_reader->entryCount(index), limit));
+
+                    for (int entry = first; entry < first + count; ++entry) {
+                        conversions.append(makeConversion(m_nodes.at(start).cost + m_reader->entryCost(entry),
+                                                          start, entry));
+                    }
+
+                    ++index;
+                }
+
+                for (int completed = 0;
+                     completed < MaxCompletionCodes and m_reader->codeStartsWith(index, code, length);
+                     ++completed, ++index) {
+                    const int entry(m_reader->firstEntry(index));
+                    conversions.append(makeConversion(m_nodes.at(start).cost + m_reader->entryCost(entry)
+                                                      + CompletionCost, start, entry));
+                }
+            }
+        }
+    }
+
+    qStableSort(conversions.begin(), conversions.end());
+
+    QSet<QString> seen;
+    QVector<QString> prefixes(end + 1);
+    QVector<bool> has_prefix(end + 1, false);
+
+    Q_FOREACH (const Conversion &conversion, conversions) {
+        if (result.count() >= limit) {
+            break;
+        }
+
+        if (not has_prefix.at(conversion.start)) {
+            prefixes[conversion.start] = pathText(conversion.start);
+            has_prefix[conversion.start] = true;
+        }
+
+        const QString text(conversion.entry < 0 ? prefixes.at(conversion.start)
+                                                : prefixes.at(conversion.start) + m_reader->entryText(conversion.entry));
+
+        if (not seen.contains(text)) {
+            seen.insert(text);
+            result.append(text);
+        }
+    }
+
+    return result;
+}
+
+
+//! @returns number of positions computed since construction. Only meant
+//!          for tests and benchmarks.
+int ConversionLattice::computedPositions() const
+{
+    return m_computed_positions;
+}
+
+
+//! \internal
+//! Finds the cheapest arc into position. All earlier positions are known.
+void ConversionLattice::extend(int position)
+{
+    Node node;
+    node.cost = m_nodes.at(position - 1).cost + UnconvertedCost;
+    node.start = position - 1;
+    node.entry = -1;
+
+    if (m_reader and m_reader->isValid()) {
+        for (int start = qMax(0, position - m_reader->maxCodeLength()); start < position; ++start) {
+            const int code(m_reader->findCode(m_input.constData() + start, position - start));
+
+            if (code < 0) {
+                continue;
+            }
+
+            const int entry(m_reader->firstEntry(code));
+            const int cost(m_nodes.at(start).cost + m_reader->entryCost(entry));
+
+            if (cost < node.cost) {
+                node.cost = cost;
+                node.start = start;
+                node.entry = entry;
+            }
+        }
+    }
+
+    m_nodes.append(node);
+    ++m_computed_positions;
+}
+
+
+//! Concatenates the texts along the cheapest path into position.
+QString ConversionLattice::pathText(int position) const
+{
+    QStringList parts;
+
+    while (position > 0) {
+        const Node &node(m_nodes.at(position));
+        parts.prepend(node.entry < 0 ? m_input.mid(node.start, position - node.start)
+                                     : m_reader->entryText(node.entry));
+        position = node.start;
+    }
+
+    return parts.join(QString());
+}
+//! \internal_end
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,93 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_CONVERSIONLATTICE_H
+#define MALIIT_KEYBOARD_CONVERSIONLATTICE_H
+
+#include "chineselexicon.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \brief Converts typed input codes into Chinese text, by finding the
+//! cheapest segmentation of the input into codes of a conversion table.
+//!
+//! The lattice has a node per input position and an arc for each input code
+//! of the conversion table spanning two positions. A Viterbi pass keeps the
+//! cheapest path into every position. As a position only depends on the
+//! input before it, appending input only computes the new positions, and
+//! other edits keep the positions of the common prefix.
+class ConversionLattice
+{
+public:
+    enum {
+        UnconvertedCost = 16 * ChineseLexicon::CostScale, //!< Cost of passing an input unit through unconverted.
+        CompletionCost = 2 * ChineseLexicon::CostScale //!< Extra cost of completing a partially typed, trailing input code.
+    };
+
+    explicit ConversionLattice();
+
+    void reset();
+    void setInput(const ChineseLexiconReader *reader,
+                  const QString &input);
+    QString input() const;
+
+    QString conversion() const;
+    QStringList candidates(int limit) const;
+
+    int computedPositions() const;
+
+private:
+    //! \internal
+    //! Cheapest arc into a position; entry is -1 for unconverted input.
+    struct Node
+    {
+        int cost;
+        int start;
+        int entry;
+    };
+    //! \internal_end
+
+    const ChineseLexiconReader *m_reader;
+    QString m_input;
+    QVector<Node> m_nodes; //!< one per input position, including the end.
+    int m_computed_positions;
+
+    void extend(int position);
+    QString pathText(int position) const;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_CONVERSIONLATTICE_H
@@ -0,0 +1,657 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "dawg.h"
+
+#include <QMap>
+#include <QVector>
+#include <QtEndian>
+
+#include <queue>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+const int HeaderWords = 6;
+
+enum NodeField {
+    NodeFirstEdge,
+    NodeEdgeCount,
+    NodeFrequency,
+    NodeMaxFrequency,
+    NodeWords
+};
+
+enum EdgeField {
+    EdgeLabel,
+    EdgeTarget,
+    EdgeWords
+};
+
+void appendWord(QByteArray *data,
+                quint32 value)
+{
+    uchar buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    data->append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+quint32 readWord(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+bool lessThanMatch(const DawgMatch &a,
+                   const DawgMatch &b)
+{
+    if (a.distance != b.distance) {
+        return a.distance < b.distance;
+    }
+
+    return a.frequency > b.frequency;
+}
+
+//! \internal
+//! Node of the uncompressed trie, only used while compiling.
+struct TrieNode
+{
+    QMap<ushort, int> children;
+    quint32 frequency;
+
+    TrieNode()
+        : children()
+        , frequency(0)
+    {}
+};
+
+//! Shares identical subtrees of the trie. Nodes are emitted after their
+//! children, so edges always point to lower node ids.
+class DawgBuilder
+{
+public:
+    explicit DawgBuilder(const QVector<TrieNode> &trie);
+
+    quint32 reduce(int trie_node);
+    QByteArray data(quint32 root,
+                    quint32 word_count) const;
+
+private:
+    const QVector<TrieNode> &m_trie;
+    QHash<QByteArray, quint32> m_registry;
+    QVector<quint32> m_nodes;
+    QVector<quint32> m_edges;
+};
+
+DawgBuilder::DawgBuilder(const QVector<TrieNode> &trie)
+    : m_trie(trie)
+    , m_registry()
+    , m_nodes()
+    , m_edges()
+{}
+
+quint32 DawgBuilder::reduce(int trie_node)
+{
+    const TrieNode &node(m_trie.at(trie_node));
+
+    // A node is identified by its frequency and its (already shared) children:
+    QVector<quint32> signature;
+    signature.reserve(1 + node.children.size() * EdgeWords);
+    signature.append(node.frequency);
+    quint32 max_frequency(node.frequency);
+
+    for (QMap<ushort, int>::const_iterator it = node.children.constBegin();
+         it != node.children.constEnd();
+         ++it) {
+        const quint32 child(reduce(it.value()));
+        signature.append(it.key());
+        signature.append(child);
+        max_frequency = qMax(max_frequency, m_nodes.at(child * NodeWords + NodeMaxFrequency));
+    }
+
+    const QByteArray key(reinterpret_cast<const char *>(signature.constData()),
+                         signature.size() * sizeof(quint32));
+    const QHash<QByteArray, quint32>::const_iterator found(m_registry.constFind(key));
+
+    if (found != m_registry.constEnd()) {
+        return found.value();
+    }
+
+    const quint32 id(m_nodes.size() / NodeWords);
+    m_nodes.append(m_edges.size() / EdgeWords);
+    m_nodes.append(node.children.size());
+    m_nodes.append(node.frequency);
+    m_nodes.append(max_frequency);
+
+    for (int index = 1; index < signature.size(); ++index) {
+        m_edges.append(signature.at(index));
+    }
+
+    m_registry.insert(key, id);
+    return id;
+}
+
+QByteArray DawgBuilder::data(quint32 root,
+                             quint32 word_count) const
+{
+    QByteArray result;
+    result.reserve((HeaderWords + m_nodes.size() + m_edges.size()) * 4);
+
+    appendWord(&result, Dawg::Magic);
+    appendWord(&result, Dawg::Version);
+    appendWord(&result, word_count);
+    appendWord(&result, m_nodes.size() / NodeWords);
+    appendWord(&result, m_edges.size() / EdgeWords);
+    appendWord(&result, root);
+
+    Q_FOREACH (quint32 value, m_nodes) {
+        appendWord(&result, value);
+    }
+
+    Q_FOREACH (quint32 value, m_edges) {
+        appendWord(&result, value);
+    }
+
+    return result;
+}
+
+//! Pending entry of the best-first search used for completions. Nodes are
+//! ranked by the highest frequency below them, words by their own frequency.
+struct QueueEntry
+{
+    quint32 priority;
+    quint32 node;
+    bool is_word;
+    QString word;
+
+    QueueEntry(quint32 new_priority,
+               quint32 new_node,
+               bool new_is_word,
+               const QString &new_word)
+        : priority(new_priority)
+        , node(new_node)
+        , is_word(new_is_word)
+        , word(new_word)
+    {}
+
+    bool operator<(const QueueEntry &other) const
+    {
+        if (priority != other.priority) {
+            return priority < other.priority;
+        }
+
+        // Words are taken before subtrees of the same rank, shorter and
+        // alphabetically smaller words first:
+        if (is_word != other.is_word) {
+            return other.is_word;
+        }
+
+        if (word.length() != other.word.length()) {
+            return word.length() > other.word.length();
+        }
+
+        return word > other.word;
+    }
+};
+//! \internal_end
+
+} // namespace
+
+
+//! \brief Serializes a word list.
+QByteArray Dawg::compile(const QHash<QString, quint32> &frequencies)
+{
+    QVector<TrieNode> trie(1);
+    quint32 word_count(0);
+
+    for (QHash<QString, quint32>::const_iterator it = frequencies.constBegin();
+         it != frequencies.constEnd();
+         ++it) {
+        const QString &word(it.key());
+
+        if (word.isEmpty()) {
+            continue;
+        }
+
+        int node(0);
+
+        for (int index = 0; index < word.length(); ++index) {
+            const ushort label(word.at(index).unicode());
+            int child(trie.at(node).children.value(label, -1));
+
+            if (child < 0) {
+                child = trie.size();
+                trie.append(TrieNode());
+                trie[node].children.insert(label, child);
+            }
+
+            node = child;
+        }
+
+        trie[node].frequency = qMax<quint32>(1, it.value());
+        ++word_count;
+    }
+
+    DawgBuilder builder(trie);
+    const quint32 root(builder.reduce(0));
+
+    return builder.data(root, word_count);
+}
+
+
+QString Dawg::fileSuffix()
+{
+    return QString::fromLatin1(".dawg");
+}
+
+
+//! \class DawgReader
+//! \brief Looks up words in a compiled word list.
+
+//! \internal
+struct DawgReader::LookupState
+{
+    QString word;
+    int max_distance;
+    int max_depth;
+    QVector<int> rows; //!< Edit distance rows, one per depth of the current path.
+    QString path; //!< Labels of the current path.
+    DawgMatchList matches;
+};
+//! \internal_end
+
+
+DawgReader::DawgReader(const uchar *data,
+                       qint64 size)
+    : m_data(data)
+    , m_word_count(0)
+    , m_node_count(0)
+    , m_edge_count(0)
+    , m_root(0)
+    , m_nodes(0)
+    , m_edges(0)
+    , m_error_string()
+{
+    if (not m_data or size < HeaderWords * 4) {
+        error("Truncated header.");
+        return;
+    }
+
+    if (readWord(m_data) != static_cast<quint32>(Dawg::Magic)) {
+        error("Not a compiled word list.");
+        return;
+    }
+
+    if (readWord(m_data + 4) != static_cast<quint32>(Dawg::Version)) {
+        error(QString("Unsupported version %1.").arg(readWord(m_data + 4)));
+        return;
+    }
+
+    m_word_count = readWord(m_data + 8);
+    m_node_count = readWord(m_data + 12);
+    m_edge_count = readWord(m_data + 16);
+    m_root = readWord(m_data + 20);
+
+    const qint64 expected_size((HeaderWords + qint64(m_node_count) * NodeWords
+                                + qint64(m_edge_count) * EdgeWords) * 4);
+
+    if (size != expected_size) {
+        error(QString("Expected %1 bytes, got %2.").arg(expected_size).arg(size));
+        return;
+    }
+
+    if (m_root >= m_node_count) {
+        error("Invalid root node.");
+        return;
+    }
+
+    m_nodes = m_data + HeaderWords * 4;
+    m_edges = m_nodes + qint64(m_node_count) * NodeWords * 4;
+
+    // Edges have to point to lower node ids, which rules out cycles:
+    for (quint32 node = 0; node < m_node_count; ++node) {
+        const quint32 first_edge(nodeField(node, NodeFirstEdge));
+        const quint32 edge_count(nodeField(node, NodeEdgeCount));
+
+        if (qint64(first_edge) + edge_count > m_edge_count) {
+            error(QString("Invalid edges of node %1.").arg(node));
+            return;
+        }
+
+        for (quint32 edge = first_edge; edge < first_edge + edge_count; ++edge) {
+            if (edgeField(edge, EdgeTarget) >= node) {
+                error(QString("Invalid target of edge %1.").arg(edge));
+                return;
+            }
+        }
+    }
+}
+
+
+bool DawgReader::isValid() const
+{
+    return m_error_string.isEmpty();
+}
+
+
+const QString DawgReader::errorString() const
+{
+    return m_error_string;
+}
+
+
+int DawgReader::wordCount() const
+{
+    return isValid() ? m_word_count : 0;
+}
+
+
+//! @returns frequency of word, or 0 if the word is not in the word list.
+quint32 DawgReader::frequency(const QString &word) const
+{
+    quint32 node;
+
+    if (word.isEmpty() or not findNode(word, &node)) {
+        return 0;
+    }
+
+    return nodeField(node, NodeFrequency);
+}
+
+
+//! \brief Finds the most frequent words starting with prefix.
+//! \param prefix The prefix, matched case sensitively.
+//! \param limit Maximum number of words, or -1 for all words.
+//! @returns words ordered by frequency, most frequent first. Includes prefix
+//!          itself, if it is a word.
+DawgMatchList DawgReader::complete(const QString &prefix,
+                                   int limit) const
+{
+    DawgMatchList result;
+    quint32 start;
+
+    if (limit == 0 or not findNode(prefix, &start)) {
+        return result;
+    }
+
+    std::priority_queue<QueueEntry> queue;
+    queue.push(QueueEntry(nodeField(start, NodeMaxFrequency), start, false, prefix));
+
+    while (not queue.empty() and (limit < 0 or result.size() < limit)) {
+        const QueueEntry top(queue.top());
+        queue.pop();
+
+        if (top.is_word) {
+            const DawgMatch match = {top.word, top.priority, 0};
+            result.append(match);
+            continue;
+        }
+
+        const quint32 frequency(nodeField(top.node, NodeFrequency));
+
+        if (frequency > 0) {
+            queue.push(QueueEntry(frequency, top.node, true, top.word));
+        }
+
+        const quint32 first_edge(nodeField(top.node, NodeFirstEdge));
+        const quint32 last_edge(first_edge + nodeField(top.node, NodeEdgeCount));
+
+        for (quint32 edge = first_edge; edge < last_edge; ++edge) {
+            const quint32 target(edgeField(edge, EdgeTarget));
+            queue.push(QueueEntry(nodeField(target, NodeMaxFrequency), target, false,
+                                  top.word + QChar(ushort(edgeField(edge, EdgeLabel)))));
+        }
+    }
+
+    return result;
+}
+
+
+//! \brief Finds words within a bounded edit distance of word.
+//!
+//! Walks the word graph once, computing one row of the edit distance matrix
+//! per visited edge and pruning paths that cannot come within max_distance.
+//! Insertions, deletions, substitutions and transpositions of adjacent
+//! characters count as one edit each.
+//! \param word The misspelled word.
+//! \param max_distance Maximum number of edits.
+//! \param limit Maximum number of words, or -1 for all words.
+//! @returns words ordered by edit distance, then by frequency.
+DawgMatchList DawgReader::lookup(const QString &word,
+                                 int max_distance,
+                                 int limit) const
+{
+    if (not isValid() or limit == 0 or max_distance < 0) {
+        return DawgMatchList();
+    }
+
+    const int columns(word.length() + 1);
+
+    LookupState state;
+    state.word = word;
+    state.max_distance = max_distance;
+    state.max_depth = word.length() + max_distance;
+    state.rows.resize((state.max_depth + 1) * columns);
+    state.path.resize(state.max_depth);
+
+    for (int column = 0; column < columns; ++column) {
+        state.rows[column] = column;
+    }
+
+    lookupFrom(m_root, 0, &state);
+
+    qStableSort(state.matches.begin(), state.matches.end(), lessThanMatch);
+
+    if (limit > 0 and state.matches.size() > limit) {
+        state.matches.erase(state.matches.begin() + limit, state.matches.end());
+    }
+
+    return state.matches;
+}
+
+
+//! @returns node the word graph starts from. Only valid if the reader is
+//!          valid.
+quint32 DawgReader::rootNode() const
+{
+    return m_root;
+}
+
+
+//! @returns frequency of the word ending in node, 0 if no word ends there.
+quint32 DawgReader::wordFrequency(quint32 node) const
+{
+    return nodeField(node, NodeFrequency);
+}
+
+
+//! @returns highest frequency of all words ending in or below node.
+quint32 DawgReader::maxFrequency(quint32 node) const
+{
+    return nodeField(node, NodeMaxFrequency);
+}
+
+
+//! @returns number of edges leaving node, sorted by label.
+int DawgReader::edgeCount(quint32 node) const
+{
+    return nodeField(node, NodeEdgeCount);
+}
+
+
+//! @returns UTF-16 label of an edge leaving node.
+//! \param node The node.
+//! \param index The edge, from 0 to edgeCount(node) - 1.
+ushort DawgReader::edgeLabel(quint32 node,
+                             int index) const
+{
+    return edgeField(nodeField(node, NodeFirstEdge) + index, EdgeLabel);
+}
+
+
+//! @returns node an edge leaving node leads to.
+//! \param node The node.
+//! \param index The edge, from 0 to edgeCount(node) - 1.
+quint32 DawgReader::edgeTarget(quint32 node,
+                               int index) const
+{
+    return edgeField(nodeField(node, NodeFirstEdge) + index, EdgeTarget);
+}
+
+
+//! \internal
+quint32 DawgReader::nodeField(quint32 node,
+                              int field) const
+{
+    return readWord(m_nodes + (qint64(node) * NodeWords + field) * 4);
+}
+
+
+quint32 DawgReader::edgeField(quint32 edge,
+                              int field) const
+{
+    return readWord(m_edges + (qint64(edge) * EdgeWords + field) * 4);
+}
+
+
+bool DawgReader::findChild(quint32 node,
+                           ushort label,
+                           quint32 *child) const
+{
+    quint32 first(nodeField(node, NodeFirstEdge));
+    quint32 last(first + nodeField(node, NodeEdgeCount));
+
+    while (first < last) {
+        const quint32 middle(first + (last - first) / 2);
+        const quint32 middle_label(edgeField(middle, EdgeLabel));
+
+        if (middle_label == label) {
+            *child = edgeField(middle, EdgeTarget);
+            return true;
+        }
+
+        if (middle_label < label) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    return false;
+}
+
+
+bool DawgReader::findNode(const QString &word,
+                          quint32 *node) const
+{
+    if (not isValid()) {
+        return false;
+    }
+
+    quint32 current(m_root);
+
+    for (int index = 0; index < word.length(); ++index) {
+        if (not findChild(current, word.at(index).unicode(), &current)) {
+            return false;
+        }
+    }
+
+    *node = current;
+    return true;
+}
+
+
+void DawgReader::lookupFrom(quint32 node,
+                            int depth,
+                            LookupState *state) const
+{
+    const int columns(state->word.length() + 1);
+    int *const rows(state->rows.data());
+    const int *const previous(rows + depth * columns);
+
+    const quint32 frequency(nodeField(node, NodeFrequency));
+
+    if (frequency > 0 and previous[columns - 1] <= state->max_distance) {
+        const DawgMatch match = {state->path.left(depth), frequency, previous[columns - 1]};
+        state->matches.append(match);
+    }
+
+    if (depth >= state->max_depth) {
+        return;
+    }
+
+    const ushort *const word(state->word.utf16());
+    const quint32 first_edge(nodeField(node, NodeFirstEdge));
+    const quint32 last_edge(first_edge + nodeField(node, NodeEdgeCount));
+
+    for (quint32 edge = first_edge; edge < last_edge; ++edge) {
+        const ushort label(edgeField(edge, EdgeLabel));
+        int *const row(rows + (depth + 1) * columns);
+        int row_min(depth + 1);
+
+        row[0] = depth + 1;
+
+        for (int column = 1; column < columns; ++column) {
+            const int cost(word[column - 1] == label ? 0 : 1);
+            int value(qMin(qMin(row[column - 1] + 1, previous[column] + 1),
+                           previous[column - 1] + cost));
+
+            if (depth > 0 and column > 1
+                and label == word[column - 2]
+                and state->path.at(depth - 1).unicode() == word[column - 1]) {
+                value = qMin(value, rows[(depth - 1) * columns + column - 2] + 1);
+            }
+
+            row[column] = value;
+            row_min = qMin(row_min, value);
+        }
+
+        if (row_min > state->max_distance) {
+            continue;
+        }
+
+        state->path[depth] = QChar(label);
+        lookupFrom(edgeField(edge, EdgeTarget), depth + 1, state);
+    }
+}
+
+
+void DawgReader::error(const QString &message)
+{
+    m_error_string = message;
+    m_nodes = 0;
+    m_edges = 0;
+}
+//! \internal_end
+
+}} // namespace Logic, MaliitKeyboard
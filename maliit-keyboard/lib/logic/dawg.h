@@ -0,0 +1,145 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_DAWG_H
+#define MALIIT_KEYBOARD_DAWG_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \brief A dictionary word found by DawgReader.
+struct DawgMatch
+{
+    QString word;
+    quint32 frequency;
+    int distance; //!< Edit distance to the looked up word, 0 for completions.
+};
+
+typedef QList<DawgMatch> DawgMatchList;
+
+//! \brief Compiled word list, stored as a directed acyclic word graph.
+//!
+//! Each node carries the frequency of the word ending in it (0 if none) and
+//! the highest frequency found below it, which allows for best-first prefix
+//! completion. Subtrees are only merged if their frequencies match, too, so
+//! mostly word endings without further words below them get merged. Integers are stored as little endian 32
+//! bit words, edges of a node are sorted by their UTF-16 label.
+class Dawg
+{
+public:
+    enum {
+        Magic = 0x57444b4d, // "MKDW"
+        Version = 1
+    };
+
+    //! \brief Serializes a word list.
+    //! \param frequencies Words and their frequencies. Frequencies of 0 are
+    //!                    stored as 1.
+    static QByteArray compile(const QHash<QString, quint32> &frequencies);
+    //! @returns file name suffix of compiled word lists.
+    static QString fileSuffix();
+};
+
+//! \brief Looks up words in a compiled word list, usually a memory mapped file.
+//!
+//! The data is validated once, when constructing the reader. Lookups never
+//! copy the word list and are safe to run from several threads at once.
+class DawgReader
+{
+    Q_DISABLE_COPY(DawgReader)
+
+public:
+    //! \param data Compiled word list. Needs to stay valid for the lifetime
+    //!             of the reader.
+    //! \param size Size of data in bytes.
+    explicit DawgReader(const uchar *data,
+                        qint64 size);
+
+    bool isValid() const;
+    const QString errorString() const;
+
+    int wordCount() const;
+    quint32 frequency(const QString &word) const;
+
+    DawgMatchList complete(const QString &prefix,
+                           int limit) const;
+    DawgMatchList lookup(const QString &word,
+                         int max_distance,
+                         int limit) const;
+
+    // Walking the word graph node by node. Node ids are only meaningful to
+    // the reader that returned them.
+    quint32 rootNode() const;
+    quint32 wordFrequency(quint32 node) const;
+    quint32 maxFrequency(quint32 node) const;
+    int edgeCount(quint32 node) const;
+    ushort edgeLabel(quint32 node,
+                     int index) const;
+    quint32 edgeTarget(quint32 node,
+                       int index) const;
+
+private:
+    struct LookupState;
+
+    const uchar *m_data;
+    quint32 m_word_count;
+    quint32 m_node_count;
+    quint32 m_edge_count;
+    quint32 m_root;
+    const uchar *m_nodes;
+    const uchar *m_edges;
+    QString m_error_string;
+
+    quint32 nodeField(quint32 node,
+                      int field) const;
+    quint32 edgeField(quint32 edge,
+                      int field) const;
+    bool findChild(quint32 node,
+                   ushort label,
+                   quint32 *child) const;
+    bool findNode(const QString &word,
+                  quint32 *node) const;
+    void lookupFrom(quint32 node,
+                    int depth,
+                    LookupState *state) const;
+
+    void error(const QString &message);
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_DAWG_H
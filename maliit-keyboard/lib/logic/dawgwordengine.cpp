@@ -0,0 +1,380 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "dawgwordengine.h"
+#include "candidateranker.h"
+#include "dawg.h"
+#include "proximitycorrector.h"
+#include "swipedecoder.h"
+#include "coreutils.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+//! Words looked up before ranking them by key proximity.
+const int MaxCorrectionPool = 64;
+
+//! Candidate costs, see CandidateRanker. A known preedit comes first, then
+//! user words, completions by frequency, and corrections by key proximity.
+const int KnownWordCost = 0;
+const int UserWordCost = 1;
+const int CompletionCost = 2;
+const int CorrectionCost = 1 << 16;
+
+//! @returns number of typos tolerated when correcting word.
+int maxEditDistance(const QString &word)
+{
+    return (word.length() <= 4 ? 1 : 2);
+}
+
+bool moreFrequent(const DawgMatch &a,
+                  const DawgMatch &b)
+{
+    return a.frequency > b.frequency;
+}
+
+bool closerOrMoreFrequent(const DawgMatch &a,
+                          const DawgMatch &b)
+{
+    return (a.distance != b.distance ? a.distance < b.distance
+                                     : a.frequency > b.frequency);
+}
+
+} // namespace
+
+//! \class DawgWordEngine
+//! \brief Provides word completion and error correction from a memory
+//! mapped, compiled word list (see DawgReader).
+//!
+//! The word list is shared between all processes using it and is never
+//! copied to the heap. Compiled word lists are created with the
+//! maliit-keyboard-build-dawg tool. Words added to the user dictionary are
+//! only kept for the lifetime of the engine.
+//!
+//! Corrections are ranked by a weighted edit distance, for which mistyping a
+//! neighbouring key is cheaper than other typos (see ProximityCorrector).
+//! Swipe paths are decoded against the same word list (see SwipeDecoder).
+
+class DawgWordEnginePrivate
+{
+public:
+    QMutex mutex; //!< guards the dictionary, as candidates can be computed on a worker thread.
+    QFile file;
+    uchar *data;
+    QScopedPointer<DawgReader> reader;
+    QSet<QString> user_words;
+    ProximityCorrector corrector;
+    SwipeDecoder swipe_decoder;
+
+    explicit DawgWordEnginePrivate();
+    ~DawgWordEnginePrivate();
+
+    void unload();
+};
+
+DawgWordEnginePrivate::DawgWordEnginePrivate()
+    : mutex()
+    , file()
+    , data(0)
+    , reader()
+    , user_words()
+    , corrector()
+    , swipe_decoder()
+{}
+
+DawgWordEnginePrivate::~DawgWordEnginePrivate()
+{
+    unload();
+}
+
+void DawgWordEnginePrivate::unload()
+{
+    reader.reset();
+
+    if (data) {
+        file.unmap(data);
+        data = 0;
+    }
+
+    file.close();
+}
+
+
+//! \brief Constructor. Loads the default dictionary.
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+DawgWordEngine::DawgWordEngine(QObject *parent)
+    : AbstractWordEngine(parent)
+    , d_ptr(new DawgWordEnginePrivate)
+{
+    loadDictionary(defaultDictionary());
+}
+
+//! \brief Destructor.
+DawgWordEngine::~DawgWordEngine()
+{
+    waitForCandidates();
+}
+
+
+//! @returns path of the compiled word list loaded by default.
+QString DawgWordEngine::defaultDictionary()
+{
+    return (CoreUtils::maliitKeyboardDataDirectory() + "/dictionaries/words" + Dawg::fileSuffix());
+}
+
+
+//! \brief Replaces the dictionary by a compiled word list.
+//! \param file_name Path of the compiled word list, which gets memory mapped.
+//! @returns false if the word list could not be loaded, leaving the engine
+//!          without dictionary.
+bool DawgWordEngine::loadDictionary(const QString &file_name)
+{
+    Q_D(DawgWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    d->unload();
+    d->file.setFileName(file_name);
+
+    if (not d->file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open dictionary:" << file_name;
+        return false;
+    }
+
+    d->data = d->file.map(0, d->file.size());
+
+    if (not d->data) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not map dictionary:" << file_name;
+        d->unload();
+        return false;
+    }
+
+    d->reader.reset(new DawgReader(d->data, d->file.size()));
+
+    if (not d->reader->isValid()) {
+        qWarning() << __PRETTY_FUNCTION__ << "Invalid dictionary:" << file_name
+                   << "error:" << d->reader->errorString();
+        d->unload();
+        return false;
+    }
+
+    return true;
+}
+
+
+void DawgWordEngine::setEnabled(bool enabled)
+{
+    Q_D(DawgWordEngine);
+
+    {
+        QMutexLocker locker(&d->mutex);
+
+        // Don't allow to enable word engine without dictionary:
+        if (enabled and not d->reader) {
+            qWarning() << __PRETTY_FUNCTION__
+                       << "No dictionary available, cannot enable word engine!";
+            enabled = false;
+        }
+    }
+
+    AbstractWordEngine::setEnabled(enabled);
+}
+
+
+//! \brief Returns candidates for the preedit of the text model.
+//!
+//! A known word comes first, followed by the most frequent completions of
+//! the preedit. Unknown words are additionally corrected by looking up words
+//! within a small edit distance. Capitalized preedits also match lower case
+//! dictionary words.
+WordCandidateList DawgWordEngine::fetchCandidates(Model::Text *text)
+{
+    WordCandidateList candidates;
+
+#ifdef DISABLE_PREEDIT
+    Q_UNUSED(text)
+    return candidates;
+#else
+    Q_D(DawgWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    const QString &preedit(text->preedit());
+
+    if (preedit.isEmpty() or not d->reader) {
+        text->setPreeditFace(Model::Text::PreeditDefault);
+        text->setPrimaryCandidate(QString());
+        return candidates;
+    }
+
+    const bool is_preedit_capitalized(preedit.at(0).isUpper());
+    QStringList queries(preedit);
+
+    if (is_preedit_capitalized) {
+        QString uncapitalized(preedit);
+        uncapitalized[0] = uncapitalized.at(0).toLower();
+        queries.append(uncapitalized);
+    }
+
+    const int max_candidates(maxCandidates());
+    CandidateRanker ranker(max_candidates);
+    bool is_known_word(false);
+    DawgMatchList completions;
+
+    Q_FOREACH (const QString &query, queries) {
+        is_known_word = (is_known_word or d->user_words.contains(query) or d->reader->frequency(query) > 0);
+        completions += d->reader->complete(query, max_candidates);
+    }
+
+    if (is_known_word) {
+        ranker.add(WordCandidate::SourcePrediction, preedit, KnownWordCost);
+    }
+
+    Q_FOREACH (const QString &user_word, d->user_words) {
+        Q_FOREACH (const QString &query, queries) {
+            if (user_word.startsWith(query)) {
+                ranker.add(WordCandidate::SourcePrediction, CoreUtils::capitalized(user_word, is_preedit_capitalized),
+                           UserWordCost);
+            }
+        }
+    }
+
+    qStableSort(completions.begin(), completions.end(), moreFrequent);
+
+    for (int rank = 0; rank < completions.count(); ++rank) {
+        ranker.add(WordCandidate::SourcePrediction, CoreUtils::capitalized(completions.at(rank).word, is_preedit_capitalized),
+                   CompletionCost + rank);
+    }
+
+    if (not is_known_word) {
+        DawgMatchList corrections;
+
+        QStringList words;
+
+        Q_FOREACH (const QString &query, queries) {
+            corrections += d->reader->lookup(query, maxEditDistance(query), MaxCorrectionPool);
+        }
+
+        Q_FOREACH (const DawgMatch &correction, corrections) {
+            words.append(correction.word);
+        }
+
+        const QVector<int> &distances(d->corrector.distances(preedit, words));
+
+        // The weighted distance knows no transpositions, keep the plain edit
+        // distance where it is lower:
+        for (int index = 0; index < corrections.count(); ++index) {
+            corrections[index].distance = qMin<int>(distances.at(index),
+                                                    corrections.at(index).distance * ProximityCorrector::EditCost);
+        }
+
+        qStableSort(corrections.begin(), corrections.end(), closerOrMoreFrequent);
+
+        for (int rank = 0; rank < corrections.count(); ++rank) {
+            ranker.add(WordCandidate::SourceSpellChecking, CoreUtils::capitalized(corrections.at(rank).word, is_preedit_capitalized),
+                       CorrectionCost + rank);
+        }
+    }
+
+    candidates = ranker.candidates();
+
+    text->setPreeditFace(candidates.isEmpty() ? (is_known_word ? Model::Text::PreeditDefault
+                                                               : Model::Text::PreeditNoCandidates)
+                                              : Model::Text::PreeditActive);
+
+    text->setPrimaryCandidate(candidates.isEmpty() ? QString()
+                                                   : candidates.first().label().text());
+
+    return candidates;
+#endif
+}
+
+
+//! \brief Returns the dictionary words fitting the swipe path, best first.
+//!
+//! The best word becomes the preedit, and the primary candidate.
+WordCandidateList DawgWordEngine::fetchSwipeCandidates(Model::Text *text,
+                                                       const QVector<QPointF> &path)
+{
+    WordCandidateList candidates;
+
+    Q_D(DawgWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    if (d->reader) {
+        Q_FOREACH (const QString &word, d->swipe_decoder.decode(*d->reader, path, maxCandidates())) {
+            candidates.append(WordCandidate(WordCandidate::SourcePrediction, word));
+        }
+    }
+
+    if (candidates.isEmpty()) {
+        return candidates;
+    }
+
+    text->setPreedit(candidates.first().label().text());
+    text->setPreeditFace(Model::Text::PreeditActive);
+    text->setPrimaryCandidate(candidates.first().label().text());
+
+    return candidates;
+}
+
+
+//! \brief Adds word to the user dictionary, for the lifetime of the engine.
+void DawgWordEngine::addToUserDictionary(const QString &word)
+{
+    Q_D(DawgWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    d->user_words.insert(word);
+}
+
+
+//! \brief Returns true, swipe paths are decoded against the dictionary.
+bool DawgWordEngine::supportsSwipe() const
+{
+    return true;
+}
+
+
+//! \brief Rebuilds the key proximity costs used to rank corrections, and the
+//! key centers swipe paths are decoded against.
+void DawgWordEngine::setKeyArea(const KeyArea &key_area)
+{
+    Q_D(DawgWordEngine);
+    QMutexLocker locker(&d->mutex);
+
+    d->corrector.setKeyArea(key_area);
+    d->swipe_decoder.setKeyArea(key_area);
+}
+
+}} // namespace Logic, MaliitKeyboard
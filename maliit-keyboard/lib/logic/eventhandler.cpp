@@ -41,6 +41,8 @@ class EventHandlerPrivate
 public:
     Model::Layout * const layout;
     LayoutUpdater * const updater;
+    bool swipe_enabled;
+    QVector<QPointF> swipe_path;
 
     explicit EventHandlerPrivate(Model::Layout * const new_layout,
                                  LayoutUpdater * const new_updater);
@@ -51,12 +53,22 @@ EventHandlerPrivate::EventHandlerPrivate(Model::Layout *const new_layout,
                                          LayoutUpdater *const new_updater)
     : layout(new_layout)
     , updater(new_updater)
+    , swipe_enabled(false)
+    , swipe_path()
 {
     Q_ASSERT(new_layout != 0);
     Q_ASSERT(new_updater != 0);
 }
 
 
+//! \property EventHandler::swipeEnabled
+//! \brief Whether sliding over the keys enters whole words, instead of a
+//! single character.
+
+//! \fn void EventHandler::swipeFinished(const QVector<QPointF> &path)
+//! \brief Emitted when a swipe ends.
+//! \param path The touch points of the swipe, in key area coordinates.
+
 //! \brief Performs event handling for Model::Layout instance, using a LayoutUpdater instance.
 //!
 //! Does not take ownership of either layout or updater.
@@ -195,4 +207,96 @@ void EventHandler::onPressAndHold(int index)
 }
 
 
+//! \brief Returns whether sliding over the keys enters whole words.
+//! \sa EventHandler::swipeEnabled
+bool EventHandler::isSwipeEnabled() const
+{
+    Q_D(const EventHandler);
+    return d->swipe_enabled;
+}
+
+
+//! \brief Sets whether sliding over the keys enters whole words.
+//! \sa EventHandler::swipeEnabled
+void EventHandler::setSwipeEnabled(bool enabled)
+{
+    Q_D(EventHandler);
+
+    if (d->swipe_enabled != enabled) {
+        d->swipe_enabled = enabled;
+        d->swipe_path.clear();
+        Q_EMIT swipeEnabledChanged(d->swipe_enabled);
+    }
+}
+
+
+//! \brief Turns a key press into a swipe.
+//! \param index The pressed key.
+//! \param x Horizontal position of the press, in key area coordinates.
+//! \param y Vertical position of the press, in key area coordinates.
+//! @returns false if the key press has to be handled as usual, because
+//!          swiping is disabled or the key does not insert text.
+//!
+//! The key is released without triggering its action.
+bool EventHandler::onSwipeStarted(int index,
+                                  qreal x,
+                                  qreal y)
+{
+    Q_D(EventHandler);
+
+    const QVector<Key> &keys(d->layout->keyArea().keys());
+
+    if (not d->swipe_enabled
+        || index < 0 || index >= keys.count()
+        || keys.at(index).action() != Key::ActionInsert) {
+        return false;
+    }
+
+    onExited(index);
+
+    d->swipe_path.clear();
+    d->swipe_path.append(QPointF(x, y));
+    return true;
+}
+
+
+//! \brief Extends the current swipe, if any.
+//! \param x Horizontal position, in key area coordinates.
+//! \param y Vertical position, in key area coordinates.
+void EventHandler::onSwipeMoved(qreal x,
+                                qreal y)
+{
+    Q_D(EventHandler);
+
+    if (not d->swipe_path.isEmpty()) {
+        d->swipe_path.append(QPointF(x, y));
+    }
+}
+
+
+//! \brief Ends the current swipe, if any, and emits swipeFinished().
+void EventHandler::onSwipeFinished()
+{
+    Q_D(EventHandler);
+
+    if (d->swipe_path.isEmpty()) {
+        return;
+    }
+
+    const QVector<QPointF> path(d->swipe_path);
+    d->swipe_path.clear();
+
+    Q_EMIT swipeFinished(path);
+}
+
+
+//! \brief Drops the current swipe, if any, for instance when it turned out
+//! to be a flick gesture.
+void EventHandler::onSwipeCancelled()
+{
+    Q_D(EventHandler);
+    d->swipe_path.clear();
+}
+
+
 }} // namespace Logic, MaliitKeyboard
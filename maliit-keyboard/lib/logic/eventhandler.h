@@ -53,6 +53,9 @@ class EventHandler
     Q_OBJECT
     Q_DISABLE_COPY(EventHandler)
     Q_DECLARE_PRIVATE(EventHandler)
+    Q_PROPERTY(bool swipeEnabled READ isSwipeEnabled
+                                 WRITE setSwipeEnabled
+                                 NOTIFY swipeEnabledChanged)
 
 public:
     explicit EventHandler(Model::Layout * const layout,
@@ -70,6 +73,19 @@ public:
     Q_INVOKABLE void onReleased(int index);
     Q_INVOKABLE void onPressAndHold(int index);
 
+    bool isSwipeEnabled() const;
+    Q_SLOT void setSwipeEnabled(bool enabled);
+    Q_SIGNAL void swipeEnabledChanged(bool enabled);
+
+    Q_INVOKABLE bool onSwipeStarted(int index,
+                                    qreal x,
+                                    qreal y);
+    Q_INVOKABLE void onSwipeMoved(qreal x,
+                                  qreal y);
+    Q_INVOKABLE void onSwipeFinished();
+    Q_INVOKABLE void onSwipeCancelled();
+    Q_SIGNAL void swipeFinished(const QVector<QPointF> &path);
+
     // Key signals:
     Q_SIGNAL void keyPressed(const Key &key);
     Q_SIGNAL void keyLongPressed(const Key &key);
@@ -31,35 +31,170 @@
 
 #include "hitlogic.h"
 
+#include <algorithm>
+
 namespace MaliitKeyboard {
 namespace Logic {
 namespace {
 
-//! Find whether pos hit an filtered element, with its rectangle being
-//! translated to origin.
-//! \param filtered the list of filtered elements.
-//! \param origin the origin to use for translation.
-//! \param pos the position to test against the element bounding box.
+const int MaxCachedHitIndices = 4;
+
+//! A row-banded spatial index over a list of elements. The vertical extent
+//! of all elements is split into bands at every top and bottom edge, so that
+//! each band is crossed by a fixed set of elements. Within a band, elements
+//! are sorted by their left edge. A lookup is a binary search for the band,
+//! followed by a binary search within the band.
+template<class T>
+struct HitIndex
+{
+    //! Shallow copy of the indexed elements. Keeps the shared data alive, so
+    //! that comparing data pointers is enough to find an existing index.
+    QVector<T> elements;
+    //! Sorted band edges; band n spans [band_edges[n], band_edges[n + 1]).
+    QVector<int> band_edges;
+    //! Element indices per band, sorted by left edge.
+    QVector<QVector<int> > bands;
+    //! Widest element per band, bounds the backward scan within a band.
+    QVector<int> band_max_widths;
+};
+
+template<class T>
+class LeftEdgeLessThan
+{
+private:
+    const QVector<T> &m_elements;
+
+public:
+    explicit LeftEdgeLessThan(const QVector<T> &elements)
+        : m_elements(elements)
+    {}
+
+    bool operator()(int lhs, int rhs) const
+    {
+        return m_elements.at(lhs).rect().left() < m_elements.at(rhs).rect().left();
+    }
+};
+
+//! Builds the spatial index for a list of elements.
+//! \param elements the list of elements to index.
+template<class T>
+void buildHitIndex(HitIndex<T> *index,
+                   const QVector<T> &elements)
+{
+    index->elements = elements;
+    index->band_edges.clear();
+    index->bands.clear();
+    index->band_max_widths.clear();
+
+    Q_FOREACH (const T &current, elements) {
+        const QRect &rect(current.rect());
+
+        if (not rect.isEmpty()) {
+            index->band_edges.append(rect.top());
+            index->band_edges.append(rect.top() + rect.height());
+        }
+    }
+
+    qSort(index->band_edges);
+    index->band_edges.erase(std::unique(index->band_edges.begin(), index->band_edges.end()),
+                            index->band_edges.end());
+
+    const int band_count(qMax(0, index->band_edges.count() - 1));
+    index->bands.resize(band_count);
+    index->band_max_widths.fill(0, band_count);
+
+    for (int element_index(0); element_index < elements.count(); ++element_index) {
+        const QRect &rect(elements.at(element_index).rect());
+
+        if (rect.isEmpty()) {
+            continue;
+        }
+
+        const int first_band(qLowerBound(index->band_edges, rect.top())
+                             - index->band_edges.constBegin());
+
+        for (int band(first_band);
+             band < band_count && index->band_edges.at(band) < rect.top() + rect.height();
+             ++band) {
+            index->bands[band].append(element_index);
+            index->band_max_widths[band] = qMax(index->band_max_widths.at(band), rect.width());
+        }
+    }
+
+    for (int band(0); band < band_count; ++band) {
+        qStableSort(index->bands[band].begin(), index->bands[band].end(),
+                    LeftEdgeLessThan<T>(elements));
+    }
+}
+
+//! Returns the spatial index for a list of elements, building it if needed.
+//! The most recently used indices are kept, one per key area that is being
+//! hit tested. Hit testing only happens in the GUI thread.
+//! \param elements the list of elements to index.
+template<class T>
+const HitIndex<T> &hitIndex(const QVector<T> &elements)
+{
+    static QList<HitIndex<T> > cache;
+
+    for (int cache_index(0); cache_index < cache.count(); ++cache_index) {
+        const QVector<T> &cached(cache.at(cache_index).elements);
+
+        if (cached.constData() == elements.constData()
+            && cached.count() == elements.count()) {
+            if (cache_index > 0) {
+                cache.move(cache_index, 0);
+            }
+
+            return cache.first();
+        }
+    }
+
+    if (cache.count() >= MaxCachedHitIndices) {
+        cache.removeLast();
+    }
+
+    cache.prepend(HitIndex<T>());
+    buildHitIndex<T>(&cache.first(), elements);
+
+    return cache.first();
+}
+
+//! Hashed copy of a filter list, for constant time lookups.
+template<class T>
+struct HitFilter
+{
+    //! Shallow copy of the filter list, see HitIndex::elements.
+    QVector<T> elements;
+    QSet<T> set;
+};
+
+//! Returns the hashed filter list, hashing it only if it changed since the
+//! last hit test. Hit testing only happens in the GUI thread.
+//! \param filtered the filter list.
 template<class T>
-T findFilteredElement(const QVector<T> &filtered,
-                      const QPoint &origin,
-                      const QPoint &pos)
+const QSet<T> &hitFilter(const QVector<T> &filtered)
 {
-    Q_FOREACH (const T &current, filtered) {
-        if (current.rect().translated(origin).contains(pos)) {
-            return current;
+    static HitFilter<T> cache;
+
+    if (cache.elements.constData() != filtered.constData()
+        || cache.elements.count() != filtered.count()) {
+        cache.elements = filtered;
+        cache.set.clear();
+
+        Q_FOREACH (const T &current, filtered) {
+            cache.set.insert(current);
         }
     }
 
-    // No filtered element found:
-    return T();
+    return cache.set;
 }
 
 //! From a list of elements of type T, find out whether pos (in same coordinate
 //! system as geometry) hits one of the elements, if their bounding box is
 //! translated to geometry's top left corner.
 //!     Returns the found element or a default constructed elment, if pos did
-//! not hit any of the provided elements.
+//! not hit any of the provided elements. If several elements overlap at pos,
+//! the first one in the list wins.
 //! \param elements the list of provided elements.
 //! \param geometry the geometry that pos relates to.
 //! \param pos the position to test on whether it hit an element.
@@ -76,35 +211,68 @@ T elementHit(const QVector<T> &elements,
              FilterBehaviour behaviour)
 {
     // TODO: assume pos in screen coordinates and translate here?
-    if (geometry.contains(pos)) {
-        const QPoint &origin(geometry.topLeft());
+    if (elements.isEmpty() || not geometry.contains(pos)) {
+        return T();
+    }
 
-        // FIXME: use binary range search
-        Q_FOREACH (const T &current, elements) {
-            const T &from_filter = findFilteredElement<T>(filtered, origin, pos);
+    if (behaviour == AcceptIfInFilter && filtered.isEmpty()) {
+        return T();
+    }
 
-            if (current.rect().translated(origin).contains(pos)) {
-                switch (behaviour) {
-                case IgnoreIfInFilter:
-                    if (current != from_filter) {
-                        return current;
-                    }
+    const HitIndex<T> &index(hitIndex<T>(elements));
+    const QPoint local(pos - geometry.topLeft());
+    const int band(qUpperBound(index.band_edges, local.y())
+                   - index.band_edges.constBegin() - 1);
 
-                    break;
+    if (band < 0 || band >= index.bands.count()) {
+        return T();
+    }
 
-                case AcceptIfInFilter:
-                    if (current == from_filter) {
-                        return current;
-                    }
+    const QSet<T> &filter(hitFilter<T>(filtered));
 
-                    break;
-                }
-            }
+    // Find the first entry whose left edge is past pos, then walk back over
+    // all entries that could still reach pos.
+    const QVector<int> &entries(index.bands.at(band));
+    const int max_width(index.band_max_widths.at(band));
+    int lower(0);
+    int upper(entries.count());
+
+    while (lower < upper) {
+        const int middle(lower + (upper - lower) / 2);
+
+        if (index.elements.at(entries.at(middle)).rect().left() <= local.x()) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+
+    int result(-1);
+
+    for (int entry(lower - 1); entry >= 0; --entry) {
+        const int element_index(entries.at(entry));
+        const T &current(index.elements.at(element_index));
+        const QRect &rect(current.rect());
+
+        if (rect.left() + max_width <= local.x()) {
+            break;
+        }
+
+        if (not rect.contains(local)
+            || (result != -1 && result < element_index)) {
+            continue;
+        }
+
+        const bool in_filter(filter.contains(current));
+
+        if ((behaviour == IgnoreIfInFilter && not in_filter)
+            || (behaviour == AcceptIfInFilter && in_filter)) {
+            result = element_index;
         }
     }
 
     // No element hit:
-    return T();
+    return (result != -1 ? index.elements.at(result) : T());
 }
 
 }
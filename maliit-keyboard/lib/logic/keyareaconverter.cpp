@@ -49,6 +49,9 @@ namespace Logic {
 //! Explicit functions are used for the different key areas, instead of a
 //! generic lookup. This makes the class easier to use and better documents
 //! the valid combinations.
+//! Conversion only reads the keyboard and selects styles on the given
+//! attributes, so createKeyArea() can run on a worker thread that owns its
+//! own copy of the attributes.
 
 namespace {
 //! \brief Creates a key area from a keyboard.
@@ -82,7 +85,7 @@ KeyArea createFromKeyboard(StyleAttributes *attributes,
     Font small_font(font);
     small_font.setSize(attributes->smallFontSize(orientation));
 
-    static const QMargins bg_margins(attributes->keyBackgroundBorders());
+    const QMargins bg_margins(attributes->keyBackgroundBorders());
 
     const qreal max_width(attributes->keyAreaWidth(orientation));
     const qreal key_height(attributes->keyHeight(orientation));
@@ -231,6 +234,22 @@ KeyAreaConverter::~KeyAreaConverter()
 {}
 
 
+//! \brief Creates a key area from an already loaded keyboard.
+//!
+//! Reentrant: it does not use any loader, and it only changes the style name
+//! of \a attributes. Threads other than the GUI thread therefore need to
+//! pass their own copy of the attributes.
+//! \param attributes The styling attributes that get applied to the key area.
+//! \param keyboard The keyboard layout used for the key area.
+//! \param orientation The layout orientation.
+KeyArea KeyAreaConverter::createKeyArea(StyleAttributes *attributes,
+                                        const Keyboard &keyboard,
+                                        LayoutHelper::Orientation orientation)
+{
+    return createFromKeyboard(attributes, keyboard, orientation);
+}
+
+
 //! \brief Sets the layout orientation used for creating key areas.
 //! \param orientation The layout orientation. Default: landscape.
 void KeyAreaConverter::setLayoutOrientation(LayoutHelper::Orientation orientation)
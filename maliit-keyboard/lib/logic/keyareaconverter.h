@@ -42,6 +42,7 @@ class StyleAttributes;
 class KeyboardLoader;
 class KeyArea;
 class Key;
+struct Keyboard;
 
 namespace Logic {
 
@@ -57,6 +58,10 @@ public:
                               KeyboardLoader *loader);
     virtual ~KeyAreaConverter();
 
+    static KeyArea createKeyArea(StyleAttributes *attributes,
+                                 const Keyboard &keyboard,
+                                 LayoutHelper::Orientation orientation);
+
     void setLayoutOrientation(LayoutHelper::Orientation orientation);
 
     virtual KeyArea keyArea() const;
@@ -31,14 +31,19 @@
  *
  */
 
-#include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
 #include <QRegExp>
 
 #include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
 #include "coreutils.h"
 
 #include "keyboardloader.h"
+#include "layoutmanifest.h"
 
 namespace {
 
@@ -49,46 +54,264 @@ using namespace MaliitKeyboard;
 // would mean that CoreUtils::pluginDataDirectory is ran before any code in main
 // and it sets its static variable once. We want to be able to set the
 // environment variable altering behaviour of pluginDataDirectory for testing
-// purposes.
+// purposes. Layouts get loaded on worker threads, too, so the directory is
+// kept in a function-local constant, whose initialization is thread-safe.
 QString getLanguagesDir()
 {
-    static QString languages_dir;
-
-    if (languages_dir.isEmpty()) {
-        // From http://doc.qt.nokia.com/4.7/qdir.html#separator: If you always
-        // use "/", Qt will translate your paths to conform to the underlying
-        // operating system.
-        languages_dir = CoreUtils::pluginDataDirectory() + "/languages";
-    }
+    // From http://doc.qt.nokia.com/4.7/qdir.html#separator: If you always
+    // use "/", Qt will translate your paths to conform to the underlying
+    // operating system.
+    static const QString languages_dir(CoreUtils::pluginDataDirectory() + "/languages");
 
     return languages_dir;
 }
 
 typedef const QStringList (LayoutParser::*ParserFunc)() const;
 
-TagKeyboardPtr getTagKeyboard(const QString &id)
+//! Parsed language layout, together with the stamp of the XML or compiled
+//! file it was loaded from.
+struct CachedLayout
 {
-    if (id.isEmpty()) {
-        return TagKeyboardPtr();
+    TagKeyboardPtr keyboard;
+    QStringList imports;
+    QStringList symviews;
+    QStringList numbers;
+    QStringList phonenumbers;
+    QString path;
+    QDateTime last_modified;
+    qint64 size;
+    // Validation epoch the file stamp was last checked in.
+    int epoch;
+
+    CachedLayout()
+        : size(-1)
+        , epoch(-1)
+    {}
+
+    const QStringList imported(ParserFunc func) const
+    {
+        if (func == &LayoutParser::symviews) {
+            return symviews;
+        } else if (func == &LayoutParser::numbers) {
+            return numbers;
+        } else if (func == &LayoutParser::phonenumbers) {
+            return phonenumbers;
+        }
+
+        return imports;
+    }
+};
+
+//! Process-wide cache of parsed layout files, keyed by file path. Entries are
+//! validated against the file modification time and size at most once per
+//! validation epoch, and the epoch is bumped on every layout switch, so only
+//! switching layouts touches the filesystem. The same applies to the manifest
+//! of available layouts.
+struct LayoutCache
+{
+    QMutex mutex;
+    QHash<QString, CachedLayout> entries;
+    QScopedPointer<LayoutManifest> manifest;
+    int manifest_epoch;
+    int epoch;
+    int revision; // Bumped whenever cached layouts got dropped.
+    int hits;
+    int misses;
+
+    LayoutCache()
+        : mutex()
+        , entries()
+        , manifest()
+        , manifest_epoch(-1)
+        , epoch(0)
+        , revision(0)
+        , hits(0)
+        , misses(0)
+    {}
+};
+
+LayoutCache &layoutCache()
+{
+    static LayoutCache cache;
+    return cache;
+}
+
+void invalidateLayoutCache()
+{
+    LayoutCache &cache(layoutCache());
+    QMutexLocker locker(&cache.mutex);
+
+    ++cache.epoch;
+}
+
+// Needs to be called with the cache mutex locked.
+const LayoutManifest &getManifest(LayoutCache &cache)
+{
+    const QString languages_dir(getLanguagesDir());
+
+    if (not cache.manifest or cache.manifest->languagesDirectory() != languages_dir) {
+        cache.manifest.reset(new LayoutManifest(languages_dir));
+        cache.manifest_epoch = cache.epoch;
+    } else if (cache.manifest_epoch != cache.epoch) {
+        cache.manifest->update();
+        cache.manifest_epoch = cache.epoch;
+    }
+
+    return *cache.manifest;
+}
+
+// Compiled layouts are preferred over XML files, unless they are stale.
+QFileInfo getLayoutSource(const QString &id)
+{
+    const QString base_path(getLanguagesDir() + "/" + id);
+    const QFileInfo xml_info(base_path + ".xml");
+    const QFileInfo blob_info(base_path + LayoutBlob::fileSuffix());
+
+    if (blob_info.exists()
+        and (not xml_info.exists() or blob_info.lastModified() >= xml_info.lastModified())) {
+        return blob_info;
     }
 
-    const QString path(getLanguagesDir() + "/" + id + ".xml");
+    return xml_info;
+}
+
+bool loadCompiledLayout(const QString &path,
+                        CachedLayout *layout)
+{
     QFile file(path);
 
-    if (file.exists()) {
-        file.open(QIODevice::ReadOnly);
+    if (not file.open(QIODevice::ReadOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not open file:" << path;
+        return false;
+    }
 
-        LayoutParser parser(&file);
-        const bool result(parser.parse());
+    const qint64 size(file.size());
+    uchar *data(file.map(0, size));
 
-        file.close();
-        if (result) {
-            return parser.keyboard();
-        } else {
-            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
-        }
-    } else {
+    if (not data) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not map file:" << path;
+        return false;
+    }
+
+    LayoutBlobReader reader(data, size);
+    const bool result(reader.read());
+
+    file.unmap(data);
+    if (not result) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not read file:" << path << ", error:" << reader.errorString();
+        return false;
+    }
+
+    layout->keyboard = reader.keyboard();
+    layout->imports = reader.imports();
+    layout->symviews = reader.symviews();
+    layout->numbers = reader.numbers();
+    layout->phonenumbers = reader.phonenumbers();
+    return true;
+}
+
+bool loadLayoutFile(const QString &path,
+                    CachedLayout *layout)
+{
+    QFile file(path);
+
+    if (not file.exists()) {
         qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
+        return false;
+    }
+
+    file.open(QIODevice::ReadOnly);
+
+    LayoutParser parser(&file);
+    const bool result(parser.parse());
+
+    file.close();
+    if (not result) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
+        return false;
+    }
+
+    layout->keyboard = parser.keyboard();
+    layout->imports = parser.imports();
+    layout->symviews = parser.symviews();
+    layout->numbers = parser.numbers();
+    layout->phonenumbers = parser.phonenumbers();
+    return true;
+}
+
+bool getCachedLayout(const QString &id,
+                     CachedLayout *layout)
+{
+    if (id.isEmpty()) {
+        return false;
+    }
+
+    const QString key(getLanguagesDir() + "/" + id);
+    LayoutCache &cache(layoutCache());
+    QMutexLocker locker(&cache.mutex);
+    QHash<QString, CachedLayout>::iterator it(cache.entries.find(key));
+
+    if (it != cache.entries.end()) {
+        if (it->epoch != cache.epoch) {
+            const QFileInfo file_info(getLayoutSource(id));
+
+            if (file_info.exists()
+                and file_info.filePath() == it->path
+                and file_info.lastModified() == it->last_modified
+                and file_info.size() == it->size) {
+                it->epoch = cache.epoch;
+            } else {
+                cache.entries.erase(it);
+                it = cache.entries.end();
+                ++cache.revision;
+            }
+        }
+
+        if (it != cache.entries.end()) {
+            ++cache.hits;
+            *layout = *it;
+            return true;
+        }
+    }
+
+    ++cache.misses;
+
+    QFileInfo file_info(getLayoutSource(id));
+    CachedLayout entry;
+    bool loaded(false);
+
+    if (file_info.filePath().endsWith(LayoutBlob::fileSuffix())) {
+        loaded = loadCompiledLayout(file_info.filePath(), &entry);
+
+        if (not loaded) {
+            file_info = QFileInfo(key + ".xml");
+        }
+    }
+
+    if (not loaded) {
+        loaded = loadLayoutFile(file_info.filePath(), &entry);
+    }
+
+    if (not loaded) {
+        return false;
+    }
+
+    entry.path = file_info.filePath();
+    entry.last_modified = file_info.lastModified();
+    entry.size = file_info.size();
+    entry.epoch = cache.epoch;
+
+    cache.entries.insert(key, entry);
+    *layout = entry;
+    return true;
+}
+
+TagKeyboardPtr getTagKeyboard(const QString &id)
+{
+    CachedLayout layout;
+
+    if (getCachedLayout(id, &layout)) {
+        return layout.keyboard;
     }
 
     return TagKeyboardPtr();
@@ -251,6 +474,115 @@ Keyboard getKeyboard(const TagKeyboardPtr &keyboard,
     return skeyboard;
 }
 
+TagBindingPtr getShiftedBinding(const TagBindingPtr &binding)
+{
+    const TagModifiersPtrs all_modifiers(binding->modifiers());
+    TagBindingPtr the_binding;
+
+    Q_FOREACH (const TagModifiersPtr &modifiers, all_modifiers) {
+        if (modifiers->keys() == TagModifiers::Shift) {
+            the_binding = modifiers->binding();
+        }
+    }
+
+    return (the_binding ? the_binding : binding);
+}
+
+// Sets accented labels of all keys whose binding has given accent.
+Keyboard getAccentedKeyboard(const Keyboard &keyboard,
+                             const QVector<TagBindingPtr> &bindings,
+                             const QChar &accent)
+{
+    Keyboard accented(keyboard);
+
+    for (int index(0); index < bindings.size(); ++index) {
+        const TagBindingPtr &binding(bindings.at(index));
+        const int accent_index(binding->accents().indexOf(accent));
+
+        if (accent_index >= 0 and accent_index < binding->accented_labels().size()) {
+            accented.keys[index].rLabel().setText(binding->accented_labels().at(accent_index));
+        }
+    }
+
+    return accented;
+}
+
+// Equivalent to calling getKeyboard() for the plain, shifted and every
+// accented variant of the first section, but walks the layout only once.
+void getKeyboardVariants(const TagKeyboardPtr &keyboard,
+                         LayoutVariantSet *variants)
+{
+    if (not keyboard or keyboard->layouts().isEmpty()) {
+        return;
+    }
+
+    // sections cannot be empty - parser does not allow that.
+    const TagSectionPtr section(keyboard->layouts().first()->sections().first());
+    const TagRowPtrs rows(section->rows());
+    QVector<TagBindingPtr> bindings;
+    QVector<TagBindingPtr> shifted_bindings;
+    QString accents;
+    int row_num(0);
+    QString section_style(section->style());
+
+    Q_FOREACH (const TagRowPtr &row, rows) {
+        const TagRowElementPtrs elements(row->elements());
+        bool spacer_met(false);
+
+        Q_FOREACH (const TagRowElementPtr &element, elements) {
+            if (element->element_type() == TagRowElement::Key) {
+                const TagKeyPtr key(element.staticCast<TagKey>());
+                const TagBindingPtr binding(key->binding());
+                const TagBindingPtr shifted_binding(getShiftedBinding(binding));
+                QPair<Key, KeyDescription> key_and_desc(keyAndDescFromTags(key, binding, row_num));
+                QPair<Key, KeyDescription> shifted_key_and_desc(keyAndDescFromTags(key, shifted_binding, row_num));
+
+                key_and_desc.second.left_spacer = spacer_met;
+                key_and_desc.second.right_spacer = false;
+                shifted_key_and_desc.second.left_spacer = spacer_met;
+                shifted_key_and_desc.second.right_spacer = false;
+
+                variants->base.keys.append(key_and_desc.first);
+                variants->base.key_descriptions.append(key_and_desc.second);
+                variants->shifted.keys.append(shifted_key_and_desc.first);
+                variants->shifted.key_descriptions.append(shifted_key_and_desc.second);
+                bindings.append(binding);
+                shifted_bindings.append(shifted_binding);
+
+                Q_FOREACH (const QChar &accent, binding->accents() + shifted_binding->accents()) {
+                    if (not accents.contains(accent)) {
+                        accents.append(accent);
+                    }
+                }
+                spacer_met = false;
+            } else { // spacer
+                if (not variants->base.key_descriptions.isEmpty()) {
+                    KeyDescription &previous(variants->base.key_descriptions.last());
+                    KeyDescription &shifted_previous(variants->shifted.key_descriptions.last());
+
+                    if (previous.row == row_num) {
+                        previous.right_spacer = true;
+                        shifted_previous.right_spacer = true;
+                    }
+                }
+                spacer_met = true;
+            }
+        }
+        ++row_num;
+    }
+
+    if (section_style.isEmpty()) {
+        section_style = "keys" + QString::number(bindings.size());
+    }
+    variants->base.style_name = section_style;
+    variants->shifted.style_name = section_style;
+
+    Q_FOREACH (const QChar &accent, accents) {
+        variants->dead.insert(accent, getAccentedKeyboard(variants->base, bindings, accent));
+        variants->shifted_dead.insert(accent, getAccentedKeyboard(variants->shifted, shifted_bindings, accent));
+    }
+}
+
 QPair<TagKeyPtr, TagBindingPtr> getTagKeyAndBinding(const TagKeyboardPtr &keyboard,
                                                     const QString &label,
                                                     bool *shifted)
@@ -317,58 +649,44 @@ Keyboard getImportedKeyboard(const QString &id,
                              const QString &default_file,
                              int page = 0)
 {
-    QString path(getLanguagesDir() + "/" + id + ".xml");
-    QFile file(path);
-
-    if (file.exists()) {
-        file.open(QIODevice::ReadOnly);
+    CachedLayout layout;
 
-        LayoutParser parser(&file);
-        const bool result(parser.parse());
+    if (getCachedLayout(id, &layout)) {
+        const QStringList f_results(layout.imported(func));
 
-        file.close();
-        if (result) {
-            const QStringList f_results((parser.*func)());
+        Q_FOREACH (const QString &f_result, f_results) {
+            const QFileInfo file_info(getLanguagesDir() + "/" + f_result);
 
-            Q_FOREACH (const QString &f_result, f_results) {
-                const QFileInfo file_info(getLanguagesDir() + "/" + f_result);
-
-                if (file_info.exists() and file_info.isFile()) {
-                    const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
-                    return getKeyboard(keyboard, false, page);
-                }
+            if (file_info.exists() and file_info.isFile()) {
+                const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
+                return getKeyboard(keyboard, false, page);
             }
+        }
 
-            // If we got there then it means that we got xml layout file that does not use
-            // new <import> syntax or just does not specify explicitly which file to import.
-            // In this case we have to search imports list for entry with filename beginning
-            // with file_prefix.
-            const QStringList imports(parser.imports());
-            const QRegExp file_regexp("^(" + file_prefix + ".*).xml$");
+        // If we got there then it means that we got xml layout file that does not use
+        // new <import> syntax or just does not specify explicitly which file to import.
+        // In this case we have to search imports list for entry with filename beginning
+        // with file_prefix.
+        const QRegExp file_regexp("^(" + file_prefix + ".*).xml$");
 
-            Q_FOREACH (const QString &import, imports) {
-                if (file_regexp.exactMatch(import)) {
-                    QFileInfo file_info(getLanguagesDir() + "/" + import);
+        Q_FOREACH (const QString &import, layout.imports) {
+            if (file_regexp.exactMatch(import)) {
+                QFileInfo file_info(getLanguagesDir() + "/" + import);
 
-                    if (file_info.exists() and file_info.isFile()) {
-                        const TagKeyboardPtr keyboard(getTagKeyboard(file_regexp.cap(1)));
-                        return getKeyboard(keyboard, false, page);
-                    }
+                if (file_info.exists() and file_info.isFile()) {
+                    const TagKeyboardPtr keyboard(getTagKeyboard(file_regexp.cap(1)));
+                    return getKeyboard(keyboard, false, page);
                 }
             }
+        }
 
-            // If we got there then we try to just load a file with name in default_file.
-            QFileInfo file_info(getLanguagesDir() + "/" + default_file);
+        // If we got there then we try to just load a file with name in default_file.
+        QFileInfo file_info(getLanguagesDir() + "/" + default_file);
 
-            if (file_info.exists() and file_info.isFile()) {
-                const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
-                return getKeyboard(keyboard, false);
-            }
-        } else {
-            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << path << ", error:" << parser.errorString();
+        if (file_info.exists() and file_info.isFile()) {
+            const TagKeyboardPtr keyboard(getTagKeyboard(file_info.baseName()));
+            return getKeyboard(keyboard, false);
         }
-    } else {
-        qWarning() << __PRETTY_FUNCTION__ << "File not found:" << path;
     }
     return Keyboard();
 }
@@ -382,6 +700,7 @@ class KeyboardLoaderPrivate
 public:
 
     QString active_id;
+    LayoutVariantSet variants;
 };
 
 KeyboardLoader::KeyboardLoader(QObject *parent)
@@ -392,28 +711,45 @@ KeyboardLoader::KeyboardLoader(QObject *parent)
 KeyboardLoader::~KeyboardLoader()
 {}
 
-QStringList KeyboardLoader::ids() const
+KeyboardLoader::CacheStatistics KeyboardLoader::cacheStatistics()
 {
-    QStringList ids;
-    QDir dir(getLanguagesDir(),
-             "*.xml",
-             QDir::Name | QDir::IgnoreCase,
-             QDir::Files | QDir::NoSymLinks | QDir::Readable);
+    LayoutCache &cache(layoutCache());
+    QMutexLocker locker(&cache.mutex);
+    CacheStatistics statistics;
+
+    statistics.hits = cache.hits;
+    statistics.misses = cache.misses;
+    statistics.entries = cache.entries.size();
+    return statistics;
+}
 
-    if (dir.exists()) {
-        QFileInfoList file_infos(dir.entryInfoList());
+void KeyboardLoader::clearCache()
+{
+    LayoutCache &cache(layoutCache());
+    QMutexLocker locker(&cache.mutex);
+
+    cache.entries.clear();
+    cache.manifest.reset();
+    cache.hits = 0;
+    cache.misses = 0;
+    ++cache.epoch;
+    ++cache.revision;
+}
 
-        Q_FOREACH (const QFileInfo &file_info, file_infos) {
-            QFile file(file_info.filePath());
-            file.open(QIODevice::ReadOnly);
-            LayoutParser parser(&file);
+int KeyboardLoader::layoutRevision()
+{
+    LayoutCache &cache(layoutCache());
+    QMutexLocker locker(&cache.mutex);
 
-            if (parser.isLanguageFile()) {
-                ids.append(file_info.baseName());
-            }
-        }
-    }
-    return ids;
+    return cache.revision;
+}
+
+QStringList KeyboardLoader::ids() const
+{
+    LayoutCache &cache(layoutCache());
+    QMutexLocker locker(&cache.mutex);
+
+    return getManifest(cache).ids();
 }
 
 QString KeyboardLoader::activeId() const
@@ -426,16 +762,66 @@ void KeyboardLoader::setActiveId(const QString &id)
 {
     Q_D(KeyboardLoader);
 
+    if (d->active_id != id) {
+        setVariants(id, loadVariants(id));
+    }
+}
+
+//! \brief Parses all variants of a layout.
+//!
+//! Only touches the process-wide layout cache, which is guarded by a mutex,
+//! so it can run on a worker thread while the GUI thread keeps using its
+//! loader. Pass the result to setVariants() on the loader's thread.
+//! \param id The layout to parse.
+LayoutVariantSet KeyboardLoader::loadVariants(const QString &id)
+{
+    invalidateLayoutCache();
+
+    LayoutVariantSet variants;
+
+    getKeyboardVariants(getTagKeyboard(id), &variants);
+    variants.symbols.append(getImportedKeyboard(id, &LayoutParser::symviews, "symbols", "symbols_en.xml", 0));
+    variants.symbols.append(getImportedKeyboard(id, &LayoutParser::symviews, "symbols", "symbols_en.xml", 1));
+    variants.number = getImportedKeyboard(id, &LayoutParser::numbers, "number", "number.xml");
+    variants.phone_number = getImportedKeyboard(id, &LayoutParser::phonenumbers, "phonenumber", "phonenumber.xml");
+
+    return variants;
+}
+
+//! \brief Activates a layout whose variants were parsed already.
+//! \param id The layout to activate.
+//! \param variants The variants of the layout, see loadVariants().
+void KeyboardLoader::setVariants(const QString &id,
+                                 const LayoutVariantSet &variants)
+{
+    Q_D(KeyboardLoader);
+
     if (d->active_id != id) {
         d->active_id = id;
+        d->variants = variants;
 
-        // FIXME: Emit only after parsing new keyboard.
         Q_EMIT keyboardsChanged();
     }
 }
 
+const LayoutVariantSet &KeyboardLoader::variants() const
+{
+    Q_D(const KeyboardLoader);
+    return d->variants;
+}
+
 QString KeyboardLoader::title(const QString &id) const
 {
+    {
+        LayoutCache &cache(layoutCache());
+        QMutexLocker locker(&cache.mutex);
+        const LayoutManifest &manifest(getManifest(cache));
+
+        if (manifest.contains(id)) {
+            return manifest.entry(id).title;
+        }
+    }
+
     const TagKeyboardPtr keyboard(getTagKeyboard(id));
 
     if (keyboard) {
@@ -445,12 +831,31 @@ QString KeyboardLoader::title(const QString &id) const
     return QString();
 }
 
+QString KeyboardLoader::language(const QString &id) const
+{
+    {
+        LayoutCache &cache(layoutCache());
+        QMutexLocker locker(&cache.mutex);
+        const LayoutManifest &manifest(getManifest(cache));
+
+        if (manifest.contains(id)) {
+            return manifest.entry(id).language;
+        }
+    }
+
+    const TagKeyboardPtr keyboard(getTagKeyboard(id));
+
+    if (keyboard) {
+        return keyboard->language();
+    }
+
+    return QString();
+}
+
 Keyboard KeyboardLoader::keyboard() const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
-
-    return getKeyboard(keyboard);
+    return d->variants.base;
 }
 
 Keyboard KeyboardLoader::nextKeyboard() const
@@ -498,32 +903,30 @@ Keyboard KeyboardLoader::previousKeyboard() const
 Keyboard KeyboardLoader::shiftedKeyboard() const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
-
-    return getKeyboard(keyboard, true);
+    return d->variants.shifted;
 }
 
 Keyboard KeyboardLoader::symbolsKeyboard(int page) const
 {
     Q_D(const KeyboardLoader);
 
+    if (page >= 0 and page < d->variants.symbols.size()) {
+        return d->variants.symbols.at(page);
+    }
+
     return getImportedKeyboard(d->active_id, &LayoutParser::symviews, "symbols", "symbols_en.xml", page);
 }
 
 Keyboard KeyboardLoader::deadKeyboard(const Key &dead) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
-
-    return getKeyboard(keyboard, false, 0, dead.label().text());
+    return d->variants.dead.value(dead.label().text(), d->variants.base);
 }
 
 Keyboard KeyboardLoader::shiftedDeadKeyboard(const Key &dead) const
 {
     Q_D(const KeyboardLoader);
-    TagKeyboardPtr keyboard(getTagKeyboard(d->active_id));
-
-    return getKeyboard(keyboard, true, 0, dead.label().text());
+    return d->variants.shifted_dead.value(dead.label().text(), d->variants.shifted);
 }
 
 Keyboard KeyboardLoader::extendedKeyboard(const Key &key) const
@@ -605,15 +1008,13 @@ Keyboard KeyboardLoader::extendedKeyboard(const Key &key) const
 Keyboard KeyboardLoader::numberKeyboard() const
 {
     Q_D(const KeyboardLoader);
-
-    return getImportedKeyboard(d->active_id, &LayoutParser::numbers, "number", "number.xml");
+    return d->variants.number;
 }
 
 Keyboard KeyboardLoader::phoneNumberKeyboard() const
 {
     Q_D(const KeyboardLoader);
-
-    return getImportedKeyboard(d->active_id, &LayoutParser::phonenumbers, "phonenumber", "phonenumber.xml");
+    return d->variants.phone_number;
 }
 
 } // namespace MaliitKeyboard
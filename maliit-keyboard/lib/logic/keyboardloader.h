@@ -42,6 +42,23 @@ namespace MaliitKeyboard {
 
 class KeyboardLoaderPrivate;
 
+//! \brief All keyboard variants of the active layout.
+//!
+//! Built in one pass over the layout when it becomes active, so that shift,
+//! symbols and dead key transitions do not need to walk the layout again.
+struct LayoutVariantSet
+{
+    Keyboard base;
+    Keyboard shifted;
+    //! Symbols pages 0 and 1.
+    QVector<Keyboard> symbols;
+    Keyboard number;
+    Keyboard phone_number;
+    //! Accented variants, keyed by the dead key label.
+    QHash<QString, Keyboard> dead;
+    QHash<QString, Keyboard> shifted_dead;
+};
+
 class KeyboardLoader
     : public QObject
 {
@@ -50,14 +67,39 @@ class KeyboardLoader
     Q_DECLARE_PRIVATE(KeyboardLoader)
 
 public:
+    //! Hit and miss counters of the process-wide parsed layout cache.
+    struct CacheStatistics
+    {
+        int hits;
+        int misses;
+        int entries;
+    };
+
     explicit KeyboardLoader(QObject *parent = 0);
     virtual ~KeyboardLoader();
 
+    //! \brief Returns statistics of the parsed layout cache shared by all loaders.
+    static CacheStatistics cacheStatistics();
+    //! \brief Drops all parsed layouts and resets the cache statistics.
+    static void clearCache();
+    //! \brief Returns a number that changes whenever parsed layouts were
+    //! dropped, because their files changed or clearCache() was called.
+    //! Anything derived from previously loaded layouts is stale then.
+    static int layoutRevision();
+
     virtual QStringList ids() const;
     virtual QString activeId() const;
     virtual void setActiveId(const QString &id);
 
+    static LayoutVariantSet loadVariants(const QString &id);
+    void setVariants(const QString &id,
+                     const LayoutVariantSet &variants);
+
     virtual QString title(const QString &id) const;
+    virtual QString language(const QString &id) const;
+
+    //! \brief Returns all variants of the active keyboard.
+    const LayoutVariantSet &variants() const;
 
     virtual Keyboard keyboard() const;
     virtual Keyboard nextKeyboard() const;
@@ -0,0 +1,357 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "layoutmanifest.h"
+#include "parser/layoutparser.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace MaliitKeyboard {
+
+namespace {
+
+const quint32 ManifestMagic = 0x4d4b4c4d; // "MKLM"
+const quint32 ManifestVersion = 2;
+
+//! Modification time and size of a layout file.
+typedef QPair<QDateTime, qint64> FileStamp;
+
+FileStamp fileStamp(const QFileInfo &file_info)
+{
+    return FileStamp(file_info.lastModified(), file_info.size());
+}
+
+void writeEntry(QDataStream &stream,
+                const LayoutManifest::Entry &entry)
+{
+    stream << entry.id << entry.modified << entry.size
+           << entry.title << entry.language
+           << entry.imports << entry.symviews << entry.numbers << entry.phonenumbers;
+}
+
+void readEntry(QDataStream &stream,
+               LayoutManifest::Entry *entry)
+{
+    stream >> entry->id >> entry->modified >> entry->size
+           >> entry->title >> entry->language
+           >> entry->imports >> entry->symviews >> entry->numbers >> entry->phonenumbers;
+}
+
+} // anonymous namespace
+
+class LayoutManifestPrivate
+{
+public:
+    QString languages_dir;
+    QString cache_file;
+    QStringList ids;
+    QHash<QString, LayoutManifest::Entry> entries;
+    QHash<QString, FileStamp> other_files; //!< files that are no language layouts, by id.
+    bool from_cache;
+
+    explicit LayoutManifestPrivate(const QString &new_languages_dir,
+                                   const QString &new_cache_file);
+
+    bool load();
+    bool build();
+    void save() const;
+};
+
+LayoutManifestPrivate::LayoutManifestPrivate(const QString &new_languages_dir,
+                                             const QString &new_cache_file)
+    : languages_dir(new_languages_dir)
+    , cache_file(new_cache_file.isEmpty() ? LayoutManifest::defaultCacheFile(new_languages_dir)
+                                          : new_cache_file)
+    , ids()
+    , entries()
+    , other_files()
+    , from_cache(false)
+{}
+
+bool LayoutManifestPrivate::load()
+{
+    QFile file(cache_file);
+
+    if (not file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    quint32 magic(0);
+    quint32 version(0);
+    QString stored_dir;
+
+    stream >> magic >> version;
+    if (magic != ManifestMagic or version != ManifestVersion) {
+        return false;
+    }
+
+    stream >> stored_dir;
+    if (stored_dir != languages_dir) {
+        return false;
+    }
+
+    quint32 count(0);
+    QStringList loaded_ids;
+    QHash<QString, LayoutManifest::Entry> loaded_entries;
+    QHash<QString, FileStamp> loaded_other_files;
+
+    stream >> count;
+    for (quint32 index(0); index < count and stream.status() == QDataStream::Ok; ++index) {
+        LayoutManifest::Entry entry;
+
+        readEntry(stream, &entry);
+        loaded_ids.append(entry.id);
+        loaded_entries.insert(entry.id, entry);
+    }
+
+    stream >> loaded_other_files;
+
+    if (stream.status() != QDataStream::Ok) {
+        qWarning() << __PRETTY_FUNCTION__ << "Corrupted layout manifest:" << cache_file;
+        return false;
+    }
+
+    ids = loaded_ids;
+    entries = loaded_entries;
+    other_files = loaded_other_files;
+    return true;
+}
+
+//! Updates the entries from the layout files. Only files that were added or
+//! whose modification time or size changed are parsed.
+//! @returns true if any entry changed.
+bool LayoutManifestPrivate::build()
+{
+    QStringList new_ids;
+    QHash<QString, LayoutManifest::Entry> new_entries;
+    QHash<QString, FileStamp> new_other_files;
+    bool changed(false);
+
+    QDir dir(languages_dir,
+             "*.xml",
+             QDir::Name | QDir::IgnoreCase,
+             QDir::Files | QDir::NoSymLinks | QDir::Readable);
+
+    const QFileInfoList file_infos(dir.exists() ? dir.entryInfoList() : QFileInfoList());
+
+    Q_FOREACH (const QFileInfo &file_info, file_infos) {
+        const QString id(file_info.baseName());
+        const FileStamp stamp(fileStamp(file_info));
+
+        if (entries.contains(id)) {
+            const LayoutManifest::Entry &entry(entries[id]);
+
+            if (FileStamp(entry.modified, entry.size) == stamp) {
+                new_ids.append(id);
+                new_entries.insert(id, entry);
+                continue;
+            }
+        } else if (other_files.contains(id) and other_files.value(id) == stamp) {
+            new_other_files.insert(id, stamp);
+            continue;
+        }
+
+        changed = true;
+        QFile file(file_info.filePath());
+
+        if (not file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        {
+            LayoutParser probe(&file);
+
+            if (not probe.isLanguageFile()) {
+                new_other_files.insert(id, stamp);
+                continue;
+            }
+        }
+
+        file.seek(0);
+
+        LayoutParser parser(&file);
+        LayoutManifest::Entry entry;
+
+        entry.id = id;
+        entry.modified = stamp.first;
+        entry.size = stamp.second;
+
+        if (parser.parse()) {
+            const TagKeyboardPtr keyboard(parser.keyboard());
+
+            entry.title = keyboard->title();
+            entry.language = keyboard->language();
+            entry.imports = parser.imports();
+            entry.symviews = parser.symviews();
+            entry.numbers = parser.numbers();
+            entry.phonenumbers = parser.phonenumbers();
+        } else {
+            qWarning() << __PRETTY_FUNCTION__ << "Could not parse file:" << file_info.filePath()
+                       << ", error:" << parser.errorString();
+        }
+
+        new_ids.append(entry.id);
+        new_entries.insert(entry.id, entry);
+    }
+
+    // Removed files:
+    changed = changed
+              or new_entries.count() != entries.count()
+              or new_other_files.count() != other_files.count();
+
+    ids = new_ids;
+    entries = new_entries;
+    other_files = new_other_files;
+    return changed;
+}
+
+void LayoutManifestPrivate::save() const
+{
+    if (not QDir().mkpath(QFileInfo(cache_file).absolutePath())) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not create directory for:" << cache_file;
+        return;
+    }
+
+    QSaveFile file(cache_file);
+
+    if (not file.open(QIODevice::WriteOnly)) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not write layout manifest:" << cache_file;
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+
+    stream << ManifestMagic << ManifestVersion << languages_dir;
+    stream << static_cast<quint32>(ids.size());
+
+    Q_FOREACH (const QString &id, ids) {
+        writeEntry(stream, entries.value(id));
+    }
+
+    stream << other_files;
+
+    if (not file.commit()) {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not write layout manifest:" << cache_file;
+    }
+}
+
+LayoutManifest::LayoutManifest(const QString &languages_dir,
+                               const QString &cache_file)
+    : d_ptr(new LayoutManifestPrivate(languages_dir, cache_file))
+{
+    Q_D(LayoutManifest);
+
+    const bool loaded(d->load());
+    const bool changed(d->build());
+
+    d->from_cache = loaded and not changed;
+
+    if (not d->from_cache) {
+        d->save();
+    }
+}
+
+LayoutManifest::~LayoutManifest()
+{}
+
+QString LayoutManifest::languagesDirectory() const
+{
+    Q_D(const LayoutManifest);
+    return d->languages_dir;
+}
+
+QString LayoutManifest::cacheFile() const
+{
+    Q_D(const LayoutManifest);
+    return d->cache_file;
+}
+
+bool LayoutManifest::update()
+{
+    Q_D(LayoutManifest);
+
+    if (not d->build()) {
+        return false;
+    }
+
+    d->save();
+    d->from_cache = false;
+    return true;
+}
+
+bool LayoutManifest::isFromCache() const
+{
+    Q_D(const LayoutManifest);
+    return d->from_cache;
+}
+
+QStringList LayoutManifest::ids() const
+{
+    Q_D(const LayoutManifest);
+    return d->ids;
+}
+
+bool LayoutManifest::contains(const QString &id) const
+{
+    Q_D(const LayoutManifest);
+    return d->entries.contains(id);
+}
+
+LayoutManifest::Entry LayoutManifest::entry(const QString &id) const
+{
+    Q_D(const LayoutManifest);
+    return d->entries.value(id);
+}
+
+QString LayoutManifest::defaultCacheFile(const QString &languages_dir)
+{
+    // Different languages directories (e.g. when testing) must not share
+    // a manifest.
+    const QByteArray dir_hash(QCryptographicHash::hash(languages_dir.toUtf8(),
+                                                       QCryptographicHash::Md5).toHex());
+
+    return QString("%1/maliit-keyboard/layouts-%2.manifest")
+        .arg(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation))
+        .arg(QString::fromLatin1(dir_hash));
+}
+
+} // namespace MaliitKeyboard
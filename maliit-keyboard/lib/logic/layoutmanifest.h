@@ -0,0 +1,98 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LAYOUTMANIFEST_H
+#define MALIIT_KEYBOARD_LAYOUTMANIFEST_H
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class LayoutManifestPrivate;
+
+//! \brief Index of the language layout files found in a languages directory.
+//!
+//! The manifest is built once by parsing every layout file and is persisted
+//! to a cache file. Each entry remembers the modification time and size of
+//! its file, and only added or changed files are parsed again, so listing
+//! layouts and their titles does not need to read the layout files
+//! themselves.
+class LayoutManifest
+{
+    Q_DISABLE_COPY(LayoutManifest)
+    Q_DECLARE_PRIVATE(LayoutManifest)
+
+public:
+    struct Entry
+    {
+        QString id;
+        QDateTime modified; //!< modification time of the layout file.
+        qint64 size; //!< size of the layout file.
+        QString title;
+        QString language;
+        QStringList imports;
+        QStringList symviews;
+        QStringList numbers;
+        QStringList phonenumbers;
+    };
+
+    //! \param languages_dir Directory containing language layout files.
+    //! \param cache_file File to persist the manifest to. Uses
+    //!        defaultCacheFile() if empty.
+    explicit LayoutManifest(const QString &languages_dir,
+                            const QString &cache_file = QString());
+    ~LayoutManifest();
+
+    QString languagesDirectory() const;
+    QString cacheFile() const;
+
+    //! \brief Rebuilds the entries of added, changed or removed layout files.
+    //! @returns true if the manifest changed.
+    bool update();
+    //! @returns true if the manifest was read from the cache file, without
+    //!          parsing any layout file.
+    bool isFromCache() const;
+
+    //! @returns ids of all language layouts, sorted case insensitively.
+    QStringList ids() const;
+    bool contains(const QString &id) const;
+    Entry entry(const QString &id) const;
+
+    static QString defaultCacheFile(const QString &languages_dir);
+
+private:
+    const QScopedPointer<LayoutManifestPrivate> d_ptr;
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LAYOUTMANIFEST_H
@@ -54,6 +54,101 @@ enum ActivationPolicy {
     DeactivateElement
 };
 
+enum KeyAreaVariant {
+    MainVariant,
+    ShiftedVariant,
+    SymbolsVariant,
+    DeadVariant,
+    ShiftedDeadVariant
+};
+
+const int DefaultKeyAreaCacheBudget = 256 * 1024;
+
+//! Finished key area, together with the style name it was built with.
+struct CachedKeyArea
+{
+    KeyArea key_area;
+    QString style_name;
+
+    CachedKeyArea(const KeyArea &new_key_area,
+                  const QString &new_style_name)
+        : key_area(new_key_area)
+        , style_name(new_style_name)
+    {}
+};
+
+//! Key area converted by a layout job, for the cache of the GUI thread.
+struct BuiltKeyArea
+{
+    KeyAreaVariant variant;
+    int page;
+    KeyArea key_area;
+    QString style_name;
+};
+
+QEvent::Type layoutEventType()
+{
+    static const QEvent::Type type(static_cast<QEvent::Type>(QEvent::registerEventType()));
+    return type;
+}
+
+//! Carries a layout that was loaded on the layout worker back to the thread
+//! of the layout updater.
+class LayoutEvent
+    : public QEvent
+{
+public:
+    const int generation;
+    const QString id;
+    const int cache_epoch; //!< Key areas are stale if the cache got cleared since.
+    const LayoutHelper::Orientation orientation;
+    const LayoutVariantSet variants;
+    QList<BuiltKeyArea> key_areas;
+
+    explicit LayoutEvent(int new_generation,
+                         const QString &new_id,
+                         int new_cache_epoch,
+                         LayoutHelper::Orientation new_orientation,
+                         const LayoutVariantSet &new_variants)
+        : QEvent(layoutEventType())
+        , generation(new_generation)
+        , id(new_id)
+        , cache_epoch(new_cache_epoch)
+        , orientation(new_orientation)
+        , variants(new_variants)
+        , key_areas()
+    {}
+};
+
+//! Returns the key of a key area in the key area cache.
+//! \param parameter Symbols page or dead key, depending on variant.
+QString keyAreaCacheKey(const QString &id,
+                        LayoutHelper::Orientation orientation,
+                        const QString &profile,
+                        KeyAreaVariant variant,
+                        const QString &parameter)
+{
+    // Parameter goes last, so that a dead key cannot clash with other parts.
+    return QString("%1|%2|%3|%4|%5")
+           .arg(id)
+           .arg(orientation)
+           .arg(profile)
+           .arg(variant)
+           .arg(parameter);
+}
+
+//! Rough estimate of the memory used by a key area, in bytes.
+int keyAreaCost(const KeyArea &key_area)
+{
+    int cost(sizeof(CachedKeyArea));
+
+    Q_FOREACH (const Key &key, key_area.keys()) {
+        cost += sizeof(Key) + key.label().text().size() * sizeof(QChar) + key.icon().size();
+    }
+
+    return cost;
+}
+
 Key modifyKey(const Key &key,
               KeyDescription::State state,
               const StyleAttributes *attributes)
@@ -217,6 +312,13 @@ public:
     SharedStyle style;
     bool word_ribbon_visible;
     LayoutHelper::Panel close_extended_on_release;
+    QCache<QString, CachedKeyArea> key_areas;
+    int cache_epoch; //!< Bumped whenever key_areas gets cleared.
+    int layout_revision; //!< KeyboardLoader::layoutRevision() the cached key areas belong to.
+    bool asynchronous;
+    QAtomicInt layout_generation; //!< Read by layout jobs, to skip superseded requests.
+    QString requested_id; //!< Layout that is still being loaded.
+    QThreadPool pool;
 
     explicit LayoutUpdaterPrivate()
         : initialized(false)
@@ -228,7 +330,88 @@ public:
         , style()
         , word_ribbon_visible(false)
         , close_extended_on_release(LayoutHelper::NumPanels) // NumPanels counts as invalid panel.
-    {}
+        , key_areas(DefaultKeyAreaCacheBudget)
+        , cache_epoch(0)
+        , layout_revision(KeyboardLoader::layoutRevision())
+        , asynchronous(false)
+        , layout_generation(0)
+        , requested_id()
+        , pool()
+    {
+        // A single worker keeps layout requests in order:
+        pool.setMaxThreadCount(1);
+    }
+
+    void clearKeyAreas()
+    {
+        ++cache_epoch;
+        key_areas.clear();
+    }
+
+    //! Drops the cached key areas if layouts were parsed again since they
+    //! got built, as they could have been built from a stale layout.
+    void syncLayoutRevision()
+    {
+        const int revision(KeyboardLoader::layoutRevision());
+
+        if (revision != layout_revision) {
+            layout_revision = revision;
+            clearKeyAreas();
+        }
+    }
+
+    //! Returns the center panel key area of the active layout for given
+    //! variant, building it only if it is not cached yet.
+    //! \param page Symbols page, only used by SymbolsVariant.
+    //! \param accent Dead key, only used by DeadVariant and ShiftedDeadVariant.
+    KeyArea centerKeyArea(KeyAreaVariant variant,
+                          LayoutHelper::Orientation orientation,
+                          int page = 0,
+                          const Key &accent = Key())
+    {
+        StyleAttributes * const attributes(style->attributes());
+        const QString parameter(variant == SymbolsVariant ? QString::number(page)
+                                                          : accent.label().text());
+        const QString cache_key(keyAreaCacheKey(loader.activeId(), orientation,
+                                                style->profile(), variant, parameter));
+
+        if (const CachedKeyArea *cached = key_areas.object(cache_key)) {
+            // Magnifier and other lookups depend on the style name set by
+            // the converter.
+            attributes->setStyleName(cached->style_name);
+            return cached->key_area;
+        }
+
+        KeyAreaConverter converter(attributes, &loader);
+        converter.setLayoutOrientation(orientation);
+        KeyArea key_area;
+
+        switch (variant) {
+        case MainVariant:
+            key_area = converter.keyArea();
+            break;
+
+        case ShiftedVariant:
+            key_area = converter.shiftedKeyArea();
+            break;
+
+        case SymbolsVariant:
+            key_area = converter.symbolsKeyArea(page);
+            break;
+
+        case DeadVariant:
+            key_area = converter.deadKeyArea(accent);
+            break;
+
+        case ShiftedDeadVariant:
+            key_area = converter.shiftedDeadKeyArea(accent);
+            break;
+        }
+
+        key_areas.insert(cache_key, new CachedKeyArea(key_area, attributes->styleName()),
+                         keyAreaCost(key_area));
+        return key_area;
+    }
 
     bool inShiftedState() const
     {
@@ -265,6 +448,78 @@ public:
     }
 };
 
+//! \internal
+//! Loads a layout on the layout worker, and converts the key areas that get
+//! shown first. Works on copies only: the variants come from the
+//! process-wide layout cache, and the key areas are styled with a copy of
+//! the style attributes.
+class LayoutJob
+    : public QRunnable
+{
+private:
+    LayoutUpdater *const m_updater;
+    const QAtomicInt *const m_current_generation;
+    const int m_generation;
+    const QString m_id;
+    const int m_cache_epoch;
+    const LayoutHelper::Orientation m_orientation;
+    const QScopedPointer<StyleAttributes> m_attributes; //!< Can be null, then no key areas get converted.
+
+    void appendKeyArea(LayoutEvent *event,
+                       KeyAreaVariant variant,
+                       int page,
+                       const Keyboard &keyboard) const
+    {
+        BuiltKeyArea built;
+        built.variant = variant;
+        built.page = page;
+        built.key_area = KeyAreaConverter::createKeyArea(m_attributes.data(), keyboard, m_orientation);
+        built.style_name = m_attributes->styleName();
+        event->key_areas.append(built);
+    }
+
+public:
+    explicit LayoutJob(LayoutUpdater *updater,
+                       const QAtomicInt *current_generation,
+                       const QString &id,
+                       int cache_epoch,
+                       LayoutHelper::Orientation orientation,
+                       StyleAttributes *attributes)
+        : m_updater(updater)
+        , m_current_generation(current_generation)
+        , m_generation(current_generation->load())
+        , m_id(id)
+        , m_cache_epoch(cache_epoch)
+        , m_orientation(orientation)
+        , m_attributes(attributes)
+    {}
+
+    void run()
+    {
+        // Skip requests that were superseded while waiting in the queue:
+        if (m_current_generation->load() != m_generation) {
+            return;
+        }
+
+        LayoutEvent *const event(new LayoutEvent(m_generation, m_id, m_cache_epoch, m_orientation,
+                                                 KeyboardLoader::loadVariants(m_id)));
+
+        if (not m_attributes.isNull()) {
+            const LayoutVariantSet &variants(event->variants);
+
+            appendKeyArea(event, MainVariant, 0, variants.base);
+            appendKeyArea(event, ShiftedVariant, 0, variants.shifted);
+
+            for (int page = 0; page < variants.symbols.size(); ++page) {
+                appendKeyArea(event, SymbolsVariant, page, variants.symbols.at(page));
+            }
+        }
+
+        QCoreApplication::postEvent(m_updater, event);
+    }
+};
+//! \internal_end
+
 LayoutUpdater::LayoutUpdater(QObject *parent)
     : QObject(parent)
     , d_ptr(new LayoutUpdaterPrivate)
@@ -275,7 +530,13 @@ LayoutUpdater::LayoutUpdater(QObject *parent)
 }
 
 LayoutUpdater::~LayoutUpdater()
-{}
+{
+    Q_D(LayoutUpdater);
+
+    // Drop pending layouts, but let a running job finish:
+    d->layout_generation.ref();
+    d->pool.waitForDone();
+}
 
 void LayoutUpdater::init()
 {
@@ -292,16 +553,118 @@ QStringList LayoutUpdater::keyboardIds() const
     return d->loader.ids();
 }
 
+//! \brief Returns the active layout, or the requested one while it is
+//! still being loaded.
 QString LayoutUpdater::activeKeyboardId() const
 {
     Q_D(const LayoutUpdater);
-    return d->loader.activeId();
+    return (d->requested_id.isEmpty() ? d->loader.activeId() : d->requested_id);
 }
 
+//! \brief Activates a layout.
+//!
+//! In asynchronous mode, the layout is loaded and its main key areas are
+//! converted on a worker thread. The finished key areas are swapped in once
+//! they are available, unless another layout was requested in the meantime.
+//! \param id The layout to activate.
 void LayoutUpdater::setActiveKeyboardId(const QString &id)
 {
     Q_D(LayoutUpdater);
-    d->loader.setActiveId(id);
+
+    // Supersedes pending requests:
+    d->layout_generation.ref();
+    d->requested_id.clear();
+
+    if (not d->asynchronous || id == d->loader.activeId()) {
+        d->loader.setActiveId(id);
+        return;
+    }
+
+    d->requested_id = id;
+
+    const bool convert(d->layout && d->style);
+    d->pool.start(new LayoutJob(this, &d->layout_generation, id, d->cache_epoch,
+                                convert ? d->layout->orientation() : LayoutHelper::Landscape,
+                                convert ? new StyleAttributes(*d->style->attributes()) : 0));
+}
+
+//! \brief Returns whether layouts are loaded on a worker thread.
+bool LayoutUpdater::isAsynchronous() const
+{
+    Q_D(const LayoutUpdater);
+    return d->asynchronous;
+}
+
+//! \brief Sets whether layouts should be loaded on a worker thread.
+//! \param asynchronous If true, setActiveKeyboardId() returns immediately.
+//!                     Switching back to synchronous mode activates the
+//!                     pending layout first.
+void LayoutUpdater::setAsynchronous(bool asynchronous)
+{
+    Q_D(LayoutUpdater);
+
+    if (d->asynchronous != asynchronous) {
+        if (not asynchronous) {
+            waitForLayout();
+        }
+
+        d->asynchronous = asynchronous;
+    }
+}
+
+//! \brief Waits for the requested layout, and activates it.
+//!
+//! Must be called from the thread of the layout updater.
+void LayoutUpdater::waitForLayout()
+{
+    Q_D(LayoutUpdater);
+
+    d->pool.waitForDone();
+    QCoreApplication::sendPostedEvents(this, layoutEventType());
+}
+
+//! \brief Activates a layout that was loaded on the worker thread.
+void LayoutUpdater::customEvent(QEvent *event)
+{
+    if (event->type() != layoutEventType()) {
+        QObject::customEvent(event);
+        return;
+    }
+
+    Q_D(LayoutUpdater);
+    const LayoutEvent *const result(static_cast<const LayoutEvent *>(event));
+
+    // Drop layouts that were superseded while being loaded:
+    if (result->generation != d->layout_generation.load()) {
+        return;
+    }
+
+    d->requested_id.clear();
+
+    // Key areas were converted for a cache that got cleared since, for
+    // instance because the style profile changed:
+    const bool is_cache_current(result->cache_epoch == d->cache_epoch);
+
+    // The key areas were built from the freshly loaded layout, only older
+    // ones are stale:
+    d->syncLayoutRevision();
+
+    if (is_cache_current && d->style) {
+        const QString profile(d->style->profile());
+
+        Q_FOREACH (const BuiltKeyArea &built, result->key_areas) {
+            const QString parameter(built.variant == SymbolsVariant ? QString::number(built.page)
+                                                                    : QString());
+            d->key_areas.insert(keyAreaCacheKey(result->id, result->orientation, profile,
+                                                built.variant, parameter),
+                                new CachedKeyArea(built.key_area, built.style_name),
+                                keyAreaCost(built.key_area));
+        }
+    }
+
+    // Views switched to by the state machines now find their key areas in
+    // the cache, and only these get swapped into the layout:
+    d->loader.setVariants(result->id, result->variants);
 }
 
 QString LayoutUpdater::keyboardTitle(const QString &id) const
@@ -310,10 +673,29 @@ QString LayoutUpdater::keyboardTitle(const QString &id) const
     return d->loader.title(id);
 }
 
+QString LayoutUpdater::keyboardLanguage(const QString &id) const
+{
+    Q_D(const LayoutUpdater);
+    return d->loader.language(id);
+}
+
 void LayoutUpdater::setLayout(LayoutHelper *layout)
 {
     Q_D(LayoutUpdater);
+
+    if (d->layout) {
+        disconnect(d->layout, SIGNAL(screenSizeChanged(QSize)),
+                   this,      SLOT(clearKeyAreaCache()));
+    }
+
     d->layout = layout;
+    d->clearKeyAreas();
+
+    if (d->layout) {
+        connect(d->layout, SIGNAL(screenSizeChanged(QSize)),
+                this,      SLOT(clearKeyAreaCache()),
+                Qt::UniqueConnection);
+    }
 
     if (not d->initialized) {
         init();
@@ -327,11 +709,8 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 
     if (d->layout && d->style && d->layout->orientation() != orientation) {
         d->layout->setOrientation(orientation);
-
-        KeyAreaConverter converter(d->style->attributes(), &d->loader);
-        converter.setLayoutOrientation(orientation);
-        d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                      : converter.keyArea());
+        d->layout->setCenterPanel(d->centerKeyArea(d->inShiftedState() ? ShiftedVariant : MainVariant,
+                                                   orientation));
 
         if (isWordRibbonVisible()) {
             WordRibbon ribbon(d->layout->wordRibbon());
@@ -346,7 +725,45 @@ void LayoutUpdater::setOrientation(LayoutHelper::Orientation orientation)
 void LayoutUpdater::setStyle(const SharedStyle &style)
 {
     Q_D(LayoutUpdater);
+
+    if (d->style) {
+        disconnect(d->style.data(), SIGNAL(profileChanged()),
+                   this,            SLOT(clearKeyAreaCache()));
+    }
+
     d->style = style;
+    d->clearKeyAreas();
+
+    if (d->style) {
+        connect(d->style.data(), SIGNAL(profileChanged()),
+                this,            SLOT(clearKeyAreaCache()),
+                Qt::UniqueConnection);
+    }
+}
+
+//! \brief Returns the memory budget of the key area cache, in bytes.
+int LayoutUpdater::keyAreaCacheBudget() const
+{
+    Q_D(const LayoutUpdater);
+    return d->key_areas.maxCost();
+}
+
+//! \brief Sets the memory budget of the key area cache.
+//!
+//! Finished key areas are cached per layout, variant, orientation and style
+//! profile. Least recently used key areas are dropped once the budget is
+//! exceeded.
+//! \param bytes The budget in bytes. 0 disables the cache.
+void LayoutUpdater::setKeyAreaCacheBudget(int bytes)
+{
+    Q_D(LayoutUpdater);
+    d->key_areas.setMaxCost(qMax(0, bytes));
+}
+
+void LayoutUpdater::clearKeyAreaCache()
+{
+    Q_D(LayoutUpdater);
+    d->clearKeyAreas();
 }
 
 bool LayoutUpdater::isWordRibbonVisible() const
@@ -716,6 +1133,9 @@ void LayoutUpdater::onKeyboardsChanged()
 {
     Q_D(LayoutUpdater);
 
+    // Layouts edited on disk got parsed again:
+    d->syncLayoutRevision();
+
     // Resetting state machines should reset layout also.
     // FIXME: Most probably reloading will happen three
     // times, which is not what we want.
@@ -724,6 +1144,7 @@ void LayoutUpdater::onKeyboardsChanged()
     d->view_machine.restart();
 
     Q_EMIT keyboardTitleChanged(d->loader.title(d->loader.activeId()));
+    Q_EMIT keyboardLanguageChanged(d->loader.language(d->loader.activeId()));
 }
 
 void LayoutUpdater::switchToMainView()
@@ -745,10 +1166,8 @@ void LayoutUpdater::switchToMainView()
         d->layout->setWordRibbon(ribbon);
     }
 
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedKeyArea()
-                                                  : converter.keyArea());
+    d->layout->setCenterPanel(d->centerKeyArea(d->inShiftedState() ? ShiftedVariant : MainVariant,
+                                               orientation));
 }
 
 void LayoutUpdater::switchToPrimarySymView()
@@ -759,10 +1178,7 @@ void LayoutUpdater::switchToPrimarySymView()
         return;
     }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(0));
+    d->layout->setCenterPanel(d->centerKeyArea(SymbolsVariant, d->layout->orientation(), 0));
 
     // Reset shift state machine, also see switchToMainView.
     d->shift_machine.restart();
@@ -776,10 +1192,7 @@ void LayoutUpdater::switchToSecondarySymView()
         return;
     }
 
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    d->layout->setCenterPanel(converter.symbolsKeyArea(1));
+    d->layout->setCenterPanel(d->centerKeyArea(SymbolsVariant, d->layout->orientation(), 1));
 }
 
 void LayoutUpdater::switchToAccentedView()
@@ -790,13 +1203,9 @@ void LayoutUpdater::switchToAccentedView()
         return;
     }
 
-
-    const LayoutHelper::Orientation orientation(d->layout->orientation());
-    KeyAreaConverter converter(d->style->attributes(), &d->loader);
-    converter.setLayoutOrientation(orientation);
-    const Key accent(d->deadkey_machine.accentKey());
-    d->layout->setCenterPanel(d->inShiftedState() ? converter.shiftedDeadKeyArea(accent)
-                                                  : converter.deadKeyArea(accent));
+    d->layout->setCenterPanel(d->centerKeyArea(d->inShiftedState() ? ShiftedDeadVariant : DeadVariant,
+                                               d->layout->orientation(), 0,
+                                               d->deadkey_machine.accentKey()));
 }
 
 }} // namespace Logic, MaliitKeyboard
@@ -67,12 +67,21 @@ public:
     QString activeKeyboardId() const;
     void setActiveKeyboardId(const QString &id);
     QString keyboardTitle(const QString &id) const;
+    QString keyboardLanguage(const QString &id) const;
+
+    bool isAsynchronous() const;
+    void setAsynchronous(bool asynchronous);
+    void waitForLayout();
 
     void setLayout(LayoutHelper *layout);
     Q_SLOT void setOrientation(LayoutHelper::Orientation orientation);
 
     void setStyle(const SharedStyle &style);
 
+    int keyAreaCacheBudget() const;
+    void setKeyAreaCacheBudget(int bytes);
+    Q_SLOT void clearKeyAreaCache();
+
     bool isWordRibbonVisible() const;
     Q_SLOT void setWordRibbonVisible(bool visible);
     Q_SIGNAL void wordRibbonVisibleChanged(bool visible);
@@ -105,6 +114,10 @@ public:
     Q_SIGNAL void addToUserDictionary();
 
     Q_SIGNAL void keyboardTitleChanged(const QString &title);
+    Q_SIGNAL void keyboardLanguageChanged(const QString &language);
+
+protected:
+    virtual void customEvent(QEvent *event);
 
 private:
     Q_SIGNAL void shiftPressed();
@@ -0,0 +1,896 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "ngrammodel.h"
+
+#include <QtEndian>
+
+#include <algorithm>
+#include <cmath>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+const int HeaderWords = 6;
+//! Word ids are packed with an 8 bit score into 32 bit words.
+const quint32 MaxWords = 1 << 24;
+//! Trigrams are counted with three word ids packed into 64 bits.
+const quint32 MaxBuildWords = 1 << 21;
+const quint64 BuildIdMask = MaxBuildWords - 1;
+
+const int QuantaPerBit = 4;
+const int MaxScore = 255;
+//! Stupid backoff weight of 0.4, as quantized negative log probability.
+const int BackoffPenalty = 5;
+//! Prefix ranges up to this size are scanned for unigrams, larger ones are
+//! served from the list of words ordered by frequency.
+const quint32 MaxUnigramScan = 4096;
+
+void appendWord(QByteArray *data,
+                quint32 value)
+{
+    uchar buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    data->append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+void appendPadding(QByteArray *data)
+{
+    while (data->size() % 4) {
+        data->append('\0');
+    }
+}
+
+quint32 readWord(const uchar *data)
+{
+    return qFromLittleEndian<quint32>(data);
+}
+
+qint64 padded(qint64 size)
+{
+    return (size + 3) & ~qint64(3);
+}
+
+bool isWordCharacter(const QChar &c)
+{
+    return (c.isLetterOrNumber() or c == QLatin1Char('\''));
+}
+
+bool isSentenceEnd(const QChar &c)
+{
+    return (c == QLatin1Char('.') or c == QLatin1Char('!') or c == QLatin1Char('?'));
+}
+
+//! @returns lower cased word without surrounding apostrophes, which are
+//!          quotes rather than part of the word.
+QString normalizedWord(const QString &word)
+{
+    int begin(0);
+    int end(word.length());
+
+    while (begin < end and word.at(begin) == QLatin1Char('\'')) {
+        ++begin;
+    }
+
+    while (end > begin and word.at(end - 1) == QLatin1Char('\'')) {
+        --end;
+    }
+
+    return word.mid(begin, end - begin).toLower();
+}
+
+//! Keeps the better (lower) score of a word.
+void addScore(QHash<quint32, int> *scores,
+              quint32 id,
+              int score)
+{
+    const QHash<quint32, int>::iterator found(scores->find(id));
+
+    if (found == scores->end()) {
+        scores->insert(id, score);
+    } else if (score < found.value()) {
+        found.value() = score;
+    }
+}
+
+int quantize(quint64 count,
+             quint64 context_count)
+{
+    if (count == 0 or context_count == 0) {
+        return MaxScore;
+    }
+
+    const double probability(qMin(1.0, double(count) / context_count));
+    return qBound(0, qRound(-std::log(probability) / std::log(2.0) * QuantaPerBit), MaxScore);
+}
+
+//! \internal
+struct Ngram
+{
+    quint64 key; //!< Word ids of the compiled model.
+    quint32 count;
+    quint64 context_count;
+
+    bool operator<(const Ngram &other) const
+    {
+        return key < other.key;
+    }
+};
+
+struct AlphabeticalOrder
+{
+    const QStringList &words;
+
+    explicit AlphabeticalOrder(const QStringList &new_words)
+        : words(new_words)
+    {}
+
+    bool operator()(quint32 a,
+                    quint32 b) const
+    {
+        return words.at(a) < words.at(b);
+    }
+};
+
+struct FrequencyOrder
+{
+    const QByteArray &scores;
+
+    explicit FrequencyOrder(const QByteArray &new_scores)
+        : scores(new_scores)
+    {}
+
+    bool operator()(quint32 a,
+                    quint32 b) const
+    {
+        const uchar score_a(scores.at(a));
+        const uchar score_b(scores.at(b));
+        return (score_a != score_b ? score_a < score_b : a < b);
+    }
+};
+//! \internal_end
+
+} // namespace
+
+const quint32 NgramModel::SentenceBoundary;
+const quint32 NgramModel::UnknownWord;
+
+
+QString NgramModel::fileSuffix()
+{
+    return QString::fromLatin1(".ngram");
+}
+
+
+QStringList NgramModel::tokenize(const QString &text)
+{
+    QStringList tokens;
+    int begin(-1);
+
+    for (int index = 0; index <= text.length(); ++index) {
+        const bool is_word_character(index < text.length() and isWordCharacter(text.at(index)));
+
+        if (is_word_character) {
+            if (begin < 0) {
+                begin = index;
+            }
+
+            continue;
+        }
+
+        if (begin >= 0) {
+            const QString word(normalizedWord(text.mid(begin, index - begin)));
+            begin = -1;
+
+            if (not word.isEmpty()) {
+                tokens.append(word);
+            }
+        }
+
+        if (index < text.length() and isSentenceEnd(text.at(index))
+            and not tokens.isEmpty() and not tokens.last().isEmpty()) {
+            tokens.append(QString());
+        }
+    }
+
+    return tokens;
+}
+
+
+//! \class NgramModelBuilder
+//! \brief Counts n-grams of a text corpus and compiles them into a model.
+
+NgramModelBuilder::NgramModelBuilder()
+    : m_ids()
+    , m_words()
+    , m_counts()
+    , m_bigrams()
+    , m_trigrams()
+{
+    intern(QString());
+    endSentence();
+}
+
+
+//! \brief Counts the words of text. Sentences can span several calls.
+void NgramModelBuilder::addText(const QString &text)
+{
+    Q_FOREACH (const QString &token, NgramModel::tokenize(text)) {
+        if (token.isEmpty()) {
+            endSentence();
+            continue;
+        }
+
+        const quint32 id(intern(token));
+
+        if (id == NgramModel::UnknownWord) {
+            m_history[0] = m_history[1] = NgramModel::UnknownWord;
+            continue;
+        }
+
+        ++m_counts[id];
+
+        if (m_history[1] != NgramModel::UnknownWord) {
+            if (m_history[1] == NgramModel::SentenceBoundary) {
+                ++m_counts[NgramModel::SentenceBoundary];
+            }
+
+            ++m_bigrams[(quint64(m_history[1]) << 32) | id];
+
+            if (m_history[0] != NgramModel::UnknownWord) {
+                ++m_trigrams[(quint64(m_history[0]) << 42) | (quint64(m_history[1]) << 21) | id];
+            }
+        }
+
+        m_history[0] = m_history[1];
+        m_history[1] = id;
+    }
+}
+
+
+void NgramModelBuilder::endSentence()
+{
+    m_history[0] = NgramModel::UnknownWord;
+    m_history[1] = NgramModel::SentenceBoundary;
+}
+
+
+int NgramModelBuilder::wordCount() const
+{
+    return m_words.size() - 1;
+}
+
+
+//! \brief Serializes the counted n-grams.
+//! \param min_count Bi- and trigrams seen less often are left out.
+QByteArray NgramModelBuilder::compile(quint32 min_count) const
+{
+    const quint32 word_count(m_words.size());
+
+    // Alphabetical word ids, the sentence boundary sorts first:
+    QVector<quint32> order(word_count);
+    for (quint32 id = 0; id < word_count; ++id) {
+        order[id] = id;
+    }
+    std::sort(order.begin(), order.end(), AlphabeticalOrder(m_words));
+
+    QVector<quint32> ids(word_count);
+    for (quint32 index = 0; index < word_count; ++index) {
+        ids[order.at(index)] = index;
+    }
+
+    quint64 total(0);
+    for (quint32 id = 1; id < word_count; ++id) {
+        total += m_counts.at(id);
+    }
+
+    QByteArray unigrams(word_count, char(MaxScore));
+    for (quint32 id = 1; id < word_count; ++id) {
+        unigrams[ids.at(id)] = char(quantize(m_counts.at(id), total));
+    }
+
+    QVector<quint32> by_frequency;
+    by_frequency.reserve(word_count - 1);
+    for (quint32 index = 1; index < word_count; ++index) {
+        by_frequency.append(index);
+    }
+    std::sort(by_frequency.begin(), by_frequency.end(), FrequencyOrder(unigrams));
+
+    QVector<Ngram> bigrams;
+    for (QHash<quint64, quint32>::const_iterator it = m_bigrams.constBegin(); it != m_bigrams.constEnd(); ++it) {
+        if (it.value() < min_count) {
+            continue;
+        }
+
+        const quint32 first(it.key() >> 32);
+        const quint32 second(it.key() & 0xffffffff);
+        const Ngram bigram = {(quint64(ids.at(first)) << 32) | ids.at(second), it.value(), m_counts.at(first)};
+        bigrams.append(bigram);
+    }
+    std::sort(bigrams.begin(), bigrams.end());
+
+    QVector<Ngram> trigrams;
+    for (QHash<quint64, quint32>::const_iterator it = m_trigrams.constBegin(); it != m_trigrams.constEnd(); ++it) {
+        const quint64 first(it.key() >> 42);
+        const quint64 second((it.key() >> 21) & BuildIdMask);
+        const quint64 third(it.key() & BuildIdMask);
+        const quint32 context_count(m_bigrams.value((first << 32) | second));
+
+        // Trigrams are stored below their leading bigram, which has to exist:
+        if (it.value() < min_count or context_count < min_count) {
+            continue;
+        }
+
+        const Ngram trigram = {(quint64(ids.at(first)) << 42) | (quint64(ids.at(second)) << 21) | ids.at(third),
+                               it.value(), context_count};
+        trigrams.append(trigram);
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+
+    QByteArray result;
+    QString strings;
+
+    appendWord(&result, NgramModel::Magic);
+    appendWord(&result, NgramModel::Version);
+    appendWord(&result, word_count);
+    appendWord(&result, bigrams.size());
+    appendWord(&result, trigrams.size());
+
+    for (quint32 index = 0; index < word_count; ++index) {
+        strings.append(m_words.at(order.at(index)));
+    }
+    appendWord(&result, strings.length());
+
+    // String offsets:
+    quint32 offset(0);
+    appendWord(&result, offset);
+    for (quint32 index = 0; index < word_count; ++index) {
+        offset += m_words.at(order.at(index)).length();
+        appendWord(&result, offset);
+    }
+
+    result.append(unigrams);
+    appendPadding(&result);
+
+    // Bigram offsets:
+    int bigram(0);
+    appendWord(&result, 0);
+    for (quint32 first = 0; first < word_count; ++first) {
+        while (bigram < bigrams.size() and (bigrams.at(bigram).key >> 32) == first) {
+            ++bigram;
+        }
+        appendWord(&result, bigram);
+    }
+
+    Q_FOREACH (const Ngram &entry, bigrams) {
+        appendWord(&result, ((entry.key & 0xffffffff) << 8) | quantize(entry.count, entry.context_count));
+    }
+
+    // Trigram offsets, per bigram:
+    int trigram(0);
+    appendWord(&result, 0);
+    Q_FOREACH (const Ngram &entry, bigrams) {
+        const quint64 leading(((entry.key >> 32) << 21) | (entry.key & 0xffffffff));
+
+        while (trigram < trigrams.size() and (trigrams.at(trigram).key >> 21) == leading) {
+            ++trigram;
+        }
+        appendWord(&result, trigram);
+    }
+
+    Q_FOREACH (const Ngram &entry, trigrams) {
+        appendWord(&result, ((entry.key & BuildIdMask) << 8) | quantize(entry.count, entry.context_count));
+    }
+
+    Q_FOREACH (quint32 index, by_frequency) {
+        appendWord(&result, index);
+    }
+
+    for (int index = 0; index < strings.length(); ++index) {
+        uchar buffer[2];
+        qToLittleEndian<quint16>(strings.at(index).unicode(), buffer);
+        result.append(reinterpret_cast<const char *>(buffer), 2);
+    }
+    appendPadding(&result);
+
+    return result;
+}
+
+
+//! \internal
+quint32 NgramModelBuilder::intern(const QString &word)
+{
+    const QHash<QString, quint32>::const_iterator found(m_ids.constFind(word));
+
+    if (found != m_ids.constEnd()) {
+        return found.value();
+    }
+
+    if (quint32(m_words.size()) >= MaxBuildWords) {
+        return NgramModel::UnknownWord;
+    }
+
+    const quint32 id(m_words.size());
+    m_ids.insert(word, id);
+    m_words.append(word);
+    m_counts.append(0);
+
+    return id;
+}
+//! \internal_end
+
+
+//! \class NgramModelReader
+//! \brief Predicts words from a compiled model.
+
+NgramModelReader::NgramModelReader(const uchar *data,
+                                   qint64 size)
+    : m_word_count(0)
+    , m_bigram_count(0)
+    , m_trigram_count(0)
+    , m_string_size(0)
+    , m_string_offsets(0)
+    , m_unigrams(0)
+    , m_bigram_offsets(0)
+    , m_bigrams(0)
+    , m_trigram_offsets(0)
+    , m_trigrams(0)
+    , m_unigram_order(0)
+    , m_strings(0)
+    , m_error_string()
+{
+    if (not data or size < HeaderWords * 4) {
+        error("Truncated header.");
+        return;
+    }
+
+    if (readWord(data) != static_cast<quint32>(NgramModel::Magic)) {
+        error("Not a compiled language model.");
+        return;
+    }
+
+    if (readWord(data + 4) != static_cast<quint32>(NgramModel::Version)) {
+        error(QString("Unsupported version %1.").arg(readWord(data + 4)));
+        return;
+    }
+
+    m_word_count = readWord(data + 8);
+    m_bigram_count = readWord(data + 12);
+    m_trigram_count = readWord(data + 16);
+    m_string_size = readWord(data + 20);
+
+    if (m_word_count < 1 or m_word_count > MaxWords) {
+        error(QString("Invalid number of words: %1.").arg(m_word_count));
+        return;
+    }
+
+    const qint64 string_offsets_size((qint64(m_word_count) + 1) * 4);
+    const qint64 unigrams_size(padded(m_word_count));
+    const qint64 bigram_offsets_size((qint64(m_word_count) + 1) * 4);
+    const qint64 bigrams_size(qint64(m_bigram_count) * 4);
+    const qint64 trigram_offsets_size((qint64(m_bigram_count) + 1) * 4);
+    const qint64 trigrams_size(qint64(m_trigram_count) * 4);
+    const qint64 unigram_order_size((qint64(m_word_count) - 1) * 4);
+    const qint64 strings_size(padded(qint64(m_string_size) * 2));
+    const qint64 expected_size(HeaderWords * 4 + string_offsets_size + unigrams_size + bigram_offsets_size
+                               + bigrams_size + trigram_offsets_size + trigrams_size + unigram_order_size
+                               + strings_size);
+
+    if (size != expected_size) {
+        error(QString("Expected %1 bytes, got %2.").arg(expected_size).arg(size));
+        return;
+    }
+
+    const uchar *position(data + HeaderWords * 4);
+    m_string_offsets = position;
+    position += string_offsets_size;
+    m_unigrams = position;
+    position += unigrams_size;
+    m_bigram_offsets = position;
+    position += bigram_offsets_size;
+    m_bigrams = position;
+    position += bigrams_size;
+    m_trigram_offsets = position;
+    position += trigram_offsets_size;
+    m_trigrams = position;
+    position += trigrams_size;
+    m_unigram_order = position;
+    position += unigram_order_size;
+    m_strings = position;
+
+    // Offsets have to be ascending and word ids in range:
+    const struct {
+        const uchar *offsets;
+        quint32 count;
+        quint32 last;
+    } tables[] = {
+        {m_string_offsets, m_word_count, m_string_size},
+        {m_bigram_offsets, m_word_count, m_bigram_count},
+        {m_trigram_offsets, m_bigram_count, m_trigram_count}
+    };
+
+    for (unsigned int table = 0; table < sizeof(tables) / sizeof(tables[0]); ++table) {
+        quint32 previous(0);
+
+        for (quint32 index = 0; index <= tables[table].count; ++index) {
+            const quint32 offset(readWord(tables[table].offsets + qint64(index) * 4));
+
+            if (offset < previous or (index == 0 and offset != 0) or offset > tables[table].last
+                or (index == tables[table].count and offset != tables[table].last)) {
+                error(QString("Invalid offset table %1.").arg(table));
+                return;
+            }
+
+            previous = offset;
+        }
+    }
+
+    const struct {
+        const uchar *entries;
+        quint32 count;
+        int shift;
+    } lists[] = {
+        {m_bigrams, m_bigram_count, 8},
+        {m_trigrams, m_trigram_count, 8},
+        {m_unigram_order, m_word_count - 1, 0}
+    };
+
+    for (unsigned int list = 0; list < sizeof(lists) / sizeof(lists[0]); ++list) {
+        for (quint32 index = 0; index < lists[list].count; ++index) {
+            if ((readWord(lists[list].entries + qint64(index) * 4) >> lists[list].shift) >= m_word_count) {
+                error(QString("Invalid word id in list %1.").arg(list));
+                return;
+            }
+        }
+    }
+}
+
+
+bool NgramModelReader::isValid() const
+{
+    return m_error_string.isEmpty();
+}
+
+
+const QString NgramModelReader::errorString() const
+{
+    return m_error_string;
+}
+
+
+//! @returns number of words, not counting the sentence boundary.
+int NgramModelReader::wordCount() const
+{
+    return (isValid() ? m_word_count - 1 : 0);
+}
+
+
+//! @returns id of the lower case word, or NgramModel::UnknownWord.
+quint32 NgramModelReader::wordId(const QString &word) const
+{
+    if (not isValid()) {
+        return NgramModel::UnknownWord;
+    }
+
+    quint32 first(0);
+    quint32 last(m_word_count);
+
+    while (first < last) {
+        const quint32 middle(first + (last - first) / 2);
+        const int comparison(compareWord(middle, word, false));
+
+        if (comparison == 0) {
+            return middle;
+        }
+
+        if (comparison < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    return NgramModel::UnknownWord;
+}
+
+
+QString NgramModelReader::word(quint32 id) const
+{
+    if (not isValid() or id >= m_word_count) {
+        return QString();
+    }
+
+    const quint32 begin(readWord(m_string_offsets + qint64(id) * 4));
+    const quint32 end(readWord(m_string_offsets + (qint64(id) + 1) * 4));
+    QString result(end - begin, Qt::Uninitialized);
+
+    for (quint32 index = begin; index < end; ++index) {
+        result[index - begin] = QChar(qFromLittleEndian<quint16>(m_strings + qint64(index) * 2));
+    }
+
+    return result;
+}
+
+
+//! \brief Looks up the prediction context.
+//! \param words Last words before the predicted word, oldest first. Empty
+//!              strings mark the start of a sentence, see
+//!              Model::Text::context().
+//! @returns ids of up to two context words, oldest first. The start of a
+//!          sentence is represented by NgramModel::SentenceBoundary.
+QVector<quint32> NgramModelReader::context(const QStringList &words) const
+{
+    QVector<quint32> result;
+
+    for (int index = qMax(0, words.size() - 2); index < words.size(); ++index) {
+        const QString &word(words.at(index));
+
+        // Words of a previous sentence are no context:
+        if (word.isEmpty()) {
+            result.clear();
+            result.append(NgramModel::SentenceBoundary);
+        } else {
+            result.append(wordId(normalizedWord(word)));
+        }
+    }
+
+    return result;
+}
+
+
+//! \brief Predicts the next word.
+//! \param context Context word ids, oldest first, see context().
+//! \param prefix Already typed part of the next word. Matched case
+//!               insensitively.
+//! \param limit Maximum number of words, or -1 for all matching words.
+//! @returns lower case words, most likely first.
+QStringList NgramModelReader::predict(const QVector<quint32> &context,
+                                      const QString &prefix,
+                                      int limit) const
+{
+    QStringList result;
+
+    if (not isValid() or limit == 0) {
+        return result;
+    }
+
+    quint32 first_id;
+    quint32 last_id;
+    prefixRange(prefix.toLower(), &first_id, &last_id);
+
+    if (first_id >= last_id) {
+        return result;
+    }
+
+    QHash<quint32, int> scores;
+    const int size(context.size());
+    const quint32 previous(size > 0 ? context.at(size - 1) : NgramModel::UnknownWord);
+    const quint32 before_previous(size > 1 ? context.at(size - 2) : NgramModel::UnknownWord);
+
+    if (previous < m_word_count) {
+        if (before_previous < m_word_count) {
+            const quint32 bigram(findBigram(before_previous, previous));
+
+            if (bigram != NgramModel::UnknownWord) {
+                collect(m_trigrams,
+                        readWord(m_trigram_offsets + qint64(bigram) * 4),
+                        readWord(m_trigram_offsets + (qint64(bigram) + 1) * 4),
+                        first_id, last_id, 0, &scores);
+            }
+        }
+
+        collect(m_bigrams,
+                readWord(m_bigram_offsets + qint64(previous) * 4),
+                readWord(m_bigram_offsets + (qint64(previous) + 1) * 4),
+                first_id, last_id, BackoffPenalty, &scores);
+    }
+
+    // The best unigrams of the prefix range are enough, as a word ranks at
+    // least as good as its unigram score:
+    const int unigram_penalty(2 * BackoffPenalty);
+
+    if (limit < 0 or last_id - first_id <= MaxUnigramScan) {
+        for (quint32 id = first_id; id < last_id; ++id) {
+            addScore(&scores, id, m_unigrams[id] + unigram_penalty);
+        }
+    } else {
+        int found_count(0);
+
+        for (quint32 index = 0; index < m_word_count - 1 and found_count < limit; ++index) {
+            const quint32 id(readWord(m_unigram_order + qint64(index) * 4));
+
+            if (id < first_id or id >= last_id) {
+                continue;
+            }
+
+            addScore(&scores, id, m_unigrams[id] + unigram_penalty);
+
+            ++found_count;
+        }
+    }
+
+    QVector<QPair<int, quint32> > ranked;
+    ranked.reserve(scores.size());
+
+    for (QHash<quint32, int>::const_iterator it = scores.constBegin(); it != scores.constEnd(); ++it) {
+        ranked.append(qMakePair(it.value(), it.key()));
+    }
+
+    std::sort(ranked.begin(), ranked.end());
+
+    for (int index = 0; index < ranked.size() and (limit < 0 or index < limit); ++index) {
+        result.append(word(ranked.at(index).second));
+    }
+
+    return result;
+}
+
+
+//! \internal
+int NgramModelReader::compareWord(quint32 id,
+                                  const QString &word,
+                                  bool prefix_only) const
+{
+    const quint32 begin(readWord(m_string_offsets + qint64(id) * 4));
+    const int length(readWord(m_string_offsets + (qint64(id) + 1) * 4) - begin);
+    const int common(qMin(length, word.length()));
+
+    for (int index = 0; index < common; ++index) {
+        const ushort unit(qFromLittleEndian<quint16>(m_strings + (qint64(begin) + index) * 2));
+        const ushort other(word.at(index).unicode());
+
+        if (unit != other) {
+            return (unit < other ? -1 : 1);
+        }
+    }
+
+    if (prefix_only and length >= word.length()) {
+        return 0;
+    }
+
+    return (length < word.length() ? -1 : (length > word.length() ? 1 : 0));
+}
+
+
+//! Finds the range of word ids starting with prefix. Words with a common
+//! prefix are adjacent, as ids are assigned alphabetically.
+void NgramModelReader::prefixRange(const QString &prefix,
+                                   quint32 *begin,
+                                   quint32 *end) const
+{
+    if (prefix.isEmpty()) {
+        *begin = NgramModel::SentenceBoundary + 1;
+        *end = m_word_count;
+        return;
+    }
+
+    quint32 first(0);
+    quint32 last(m_word_count);
+
+    while (first < last) {
+        const quint32 middle(first + (last - first) / 2);
+
+        if (compareWord(middle, prefix, true) < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    *begin = first;
+    last = m_word_count;
+
+    while (first < last) {
+        const quint32 middle(first + (last - first) / 2);
+
+        if (compareWord(middle, prefix, true) <= 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    *end = first;
+}
+
+
+//! @returns index of the bigram, or NgramModel::UnknownWord.
+quint32 NgramModelReader::findBigram(quint32 first,
+                                     quint32 second) const
+{
+    quint32 begin(readWord(m_bigram_offsets + qint64(first) * 4));
+    quint32 end(readWord(m_bigram_offsets + (qint64(first) + 1) * 4));
+
+    while (begin < end) {
+        const quint32 middle(begin + (end - begin) / 2);
+        const quint32 id(readWord(m_bigrams + qint64(middle) * 4) >> 8);
+
+        if (id == second) {
+            return middle;
+        }
+
+        if (id < second) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+
+    return NgramModel::UnknownWord;
+}
+
+
+//! Adds the entries with word ids in [first_id, last_id) to scores, unless
+//! they already scored better.
+void NgramModelReader::collect(const uchar *entries,
+                               quint32 begin,
+                               quint32 end,
+                               quint32 first_id,
+                               quint32 last_id,
+                               int penalty,
+                               QHash<quint32, int> *scores) const
+{
+    quint32 first(begin);
+    quint32 last(end);
+
+    while (first < last) {
+        const quint32 middle(first + (last - first) / 2);
+
+        if ((readWord(entries + qint64(middle) * 4) >> 8) < first_id) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    for (quint32 index = first; index < end; ++index) {
+        const quint32 entry(readWord(entries + qint64(index) * 4));
+        const quint32 id(entry >> 8);
+
+        if (id >= last_id) {
+            break;
+        }
+
+        addScore(scores, id, (entry & 0xff) + penalty);
+    }
+}
+
+
+void NgramModelReader::error(const QString &message)
+{
+    m_error_string = message;
+}
+//! \internal_end
+
+}} // namespace Logic, MaliitKeyboard
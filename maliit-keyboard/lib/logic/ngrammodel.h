@@ -0,0 +1,160 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_NGRAMMODEL_H
+#define MALIIT_KEYBOARD_NGRAMMODEL_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \brief Compiled trigram language model, used for word prediction.
+//!
+//! Words are lower cased and numbered in alphabetical order, so that all
+//! words sharing a prefix form a range of word ids. Word 0 is the empty
+//! string and marks sentence boundaries. Uni-, bi- and trigram scores are
+//! quantized negative log probabilities, stored next to the word id in one
+//! little endian 32 bit word. Lists of bi- and trigrams are sorted by word
+//! id. Scores are combined with stupid backoff.
+class NgramModel
+{
+public:
+    enum {
+        Magic = 0x4d474e4d, // "MNGM"
+        Version = 1
+    };
+
+    //! Id of the sentence boundary.
+    static const quint32 SentenceBoundary = 0;
+    //! Id of words not in the model.
+    static const quint32 UnknownWord = 0xffffffff;
+
+    //! @returns file name suffix of compiled models.
+    static QString fileSuffix();
+    //! \brief Splits text into lower case words, with empty strings for
+    //! sentence boundaries.
+    static QStringList tokenize(const QString &text);
+};
+
+//! \brief Counts n-grams of a text corpus and compiles them into a model.
+class NgramModelBuilder
+{
+    Q_DISABLE_COPY(NgramModelBuilder)
+
+public:
+    explicit NgramModelBuilder();
+
+    void addText(const QString &text);
+    void endSentence();
+
+    int wordCount() const;
+    QByteArray compile(quint32 min_count) const;
+
+private:
+    QHash<QString, quint32> m_ids;
+    QStringList m_words;
+    QVector<quint64> m_counts;
+    QHash<quint64, quint32> m_bigrams;
+    QHash<quint64, quint32> m_trigrams;
+    quint32 m_history[2];
+
+    quint32 intern(const QString &word);
+};
+
+//! \brief Predicts words from a compiled model, usually a memory mapped file.
+//!
+//! The data is validated once, when constructing the reader. Predictions
+//! never copy the model and are safe to run from several threads at once.
+class NgramModelReader
+{
+    Q_DISABLE_COPY(NgramModelReader)
+
+public:
+    //! \param data Compiled model. Needs to stay valid for the lifetime of
+    //!             the reader.
+    //! \param size Size of data in bytes.
+    explicit NgramModelReader(const uchar *data,
+                              qint64 size);
+
+    bool isValid() const;
+    const QString errorString() const;
+
+    int wordCount() const;
+    quint32 wordId(const QString &word) const;
+    QString word(quint32 id) const;
+
+    QVector<quint32> context(const QStringList &words) const;
+    QStringList predict(const QVector<quint32> &context,
+                        const QString &prefix,
+                        int limit) const;
+
+private:
+    quint32 m_word_count;
+    quint32 m_bigram_count;
+    quint32 m_trigram_count;
+    quint32 m_string_size;
+    const uchar *m_string_offsets;
+    const uchar *m_unigrams;
+    const uchar *m_bigram_offsets;
+    const uchar *m_bigrams;
+    const uchar *m_trigram_offsets;
+    const uchar *m_trigrams;
+    const uchar *m_unigram_order;
+    const uchar *m_strings;
+    QString m_error_string;
+
+    int compareWord(quint32 id,
+                    const QString &word,
+                    bool prefix_only) const;
+    void prefixRange(const QString &prefix,
+                     quint32 *begin,
+                     quint32 *end) const;
+    quint32 findBigram(quint32 first,
+                       quint32 second) const;
+    void collect(const uchar *entries,
+                 quint32 begin,
+                 quint32 end,
+                 quint32 first_id,
+                 quint32 last_id,
+                 int penalty,
+                 QHash<quint32, int> *scores) const;
+
+    void error(const QString &message);
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_NGRAMMODEL_H
@@ -0,0 +1,378 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "proximitycorrector.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#endif
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+//! Number of candidates scored at once, one per 16 bit lane.
+const int LaneCount = 8;
+//! Substituting a neighbouring key still costs something.
+const int MinSubstitutionCost = 2;
+
+//! \internal
+#if defined(__SSE2__)
+typedef __m128i Lanes;
+
+inline Lanes loadLanes(const qint16 *data)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+}
+
+inline void storeLanes(qint16 *data,
+                       Lanes lanes)
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(data), lanes);
+}
+
+inline Lanes splatLanes(qint16 value)
+{
+    return _mm_set1_epi16(value);
+}
+
+inline Lanes addLanes(Lanes a,
+                      Lanes b)
+{
+    return _mm_adds_epi16(a, b);
+}
+
+inline Lanes minLanes(Lanes a,
+                      Lanes b)
+{
+    return _mm_min_epi16(a, b);
+}
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+typedef int16x8_t Lanes;
+
+inline Lanes loadLanes(const qint16 *data)
+{
+    return vld1q_s16(data);
+}
+
+inline void storeLanes(qint16 *data,
+                       Lanes lanes)
+{
+    vst1q_s16(data, lanes);
+}
+
+inline Lanes splatLanes(qint16 value)
+{
+    return vdupq_n_s16(value);
+}
+
+inline Lanes addLanes(Lanes a,
+                      Lanes b)
+{
+    return vqaddq_s16(a, b);
+}
+
+inline Lanes minLanes(Lanes a,
+                      Lanes b)
+{
+    return vminq_s16(a, b);
+}
+#else
+struct Lanes
+{
+    qint16 values[LaneCount];
+};
+
+inline Lanes loadLanes(const qint16 *data)
+{
+    Lanes result;
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        result.values[lane] = data[lane];
+    }
+    return result;
+}
+
+inline void storeLanes(qint16 *data,
+                       const Lanes &lanes)
+{
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        data[lane] = lanes.values[lane];
+    }
+}
+
+inline Lanes splatLanes(qint16 value)
+{
+    Lanes result;
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        result.values[lane] = value;
+    }
+    return result;
+}
+
+inline Lanes addLanes(const Lanes &a,
+                      const Lanes &b)
+{
+    Lanes result;
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        result.values[lane] = qMin(a.values[lane] + b.values[lane], 0x7fff);
+    }
+    return result;
+}
+
+inline Lanes minLanes(const Lanes &a,
+                      const Lanes &b)
+{
+    Lanes result;
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        result.values[lane] = qMin(a.values[lane], b.values[lane]);
+    }
+    return result;
+}
+#endif
+
+//! Computes the weighted edit distances between the typed word and up to
+//! LaneCount candidates. Each lane holds one candidate, the matrix is
+//! filled one candidate character (column) at a time.
+//! \param rows Length of the typed word.
+//! \param columns Length of the longest candidate.
+//! \param substitutions Cost of substituting typed character i by character
+//!                      j of each candidate, at ((j * rows) + i) * LaneCount.
+//! \param lengths Length of each candidate.
+//! \param results Distance of each candidate.
+//! \param previous Scratch space of (rows + 1) * LaneCount values.
+//! \param current Scratch space of (rows + 1) * LaneCount values.
+void batchDistances(int rows,
+                    int columns,
+                    const qint16 *substitutions,
+                    const int *lengths,
+                    int *results,
+                    qint16 *previous,
+                    qint16 *current)
+{
+    const Lanes edit_cost(splatLanes(ProximityCorrector::EditCost));
+
+    for (int row = 0; row <= rows; ++row) {
+        storeLanes(previous + row * LaneCount, splatLanes(row * ProximityCorrector::EditCost));
+    }
+
+    for (int lane = 0; lane < LaneCount; ++lane) {
+        if (lengths[lane] == 0) {
+            results[lane] = rows * ProximityCorrector::EditCost;
+        }
+    }
+
+    for (int column = 1; column <= columns; ++column) {
+        const qint16 *const column_substitutions(substitutions + (column - 1) * rows * LaneCount);
+        Lanes upper(splatLanes(column * ProximityCorrector::EditCost)); // (row - 1, column)
+        Lanes diagonal(loadLanes(previous)); // (row - 1, column - 1)
+
+        storeLanes(current, upper);
+
+        for (int row = 1; row <= rows; ++row) {
+            const Lanes left(loadLanes(previous + row * LaneCount)); // (row, column - 1)
+            const Lanes substituted(addLanes(diagonal, loadLanes(column_substitutions + (row - 1) * LaneCount)));
+
+            upper = minLanes(substituted, addLanes(minLanes(left, upper), edit_cost));
+            storeLanes(current + row * LaneCount, upper);
+            diagonal = left;
+        }
+
+        for (int lane = 0; lane < LaneCount; ++lane) {
+            if (lengths[lane] == column) {
+                results[lane] = current[rows * LaneCount + lane];
+            }
+        }
+
+        qSwap(previous, current);
+    }
+}
+//! \internal_end
+
+} // namespace
+
+//! \brief Constructor. Without key area, all substitutions cost EditCost.
+ProximityCorrector::ProximityCorrector()
+    : m_key_indices()
+    , m_key_count(0)
+    , m_costs()
+{}
+
+
+//! \brief Derives substitution costs from the key geometry.
+//!
+//! Keys inserting a single character are taken into account. Substituting
+//! a key by another costs EditCost, scaled by the distance between their
+//! centers relative to two key widths.
+//! \param key_area The key area the user types on.
+void ProximityCorrector::setKeyArea(const KeyArea &key_area)
+{
+    QVector<QPointF> centers;
+    qreal total_width(0);
+
+    m_key_indices.clear();
+
+    Q_FOREACH (const Key &key, key_area.keys()) {
+        const QString &label(key.label().text());
+
+        if (key.action() != Key::ActionInsert or label.length() != 1) {
+            continue;
+        }
+
+        const ushort character(label.at(0).toLower().unicode());
+
+        if (m_key_indices.contains(character)) {
+            continue;
+        }
+
+        m_key_indices.insert(character, centers.size());
+        centers.append(QRectF(key.rect()).center());
+        total_width += key.rect().width();
+    }
+
+    m_key_count = centers.size();
+    m_costs.fill(EditCost, m_key_count * m_key_count);
+
+    const qreal key_width(m_key_count > 0 ? qMax<qreal>(1, total_width / m_key_count) : 1);
+
+    for (int typed = 0; typed < m_key_count; ++typed) {
+        for (int intended = 0; intended < m_key_count; ++intended) {
+            const QPointF delta(centers.at(typed) - centers.at(intended));
+            const qreal distance(qSqrt(delta.x() * delta.x() + delta.y() * delta.y()));
+
+            m_costs[typed * m_key_count + intended] =
+                (typed == intended ? 0 : qBound<int>(MinSubstitutionCost,
+                                                     qRound(EditCost * distance / (2 * key_width)),
+                                                     EditCost));
+        }
+    }
+}
+
+
+//! @returns cost of typing typed instead of intended, between 0 and
+//!          EditCost. Ignores case.
+int ProximityCorrector::substitutionCost(const QChar &typed,
+                                         const QChar &intended) const
+{
+    const ushort typed_character(typed.toLower().unicode());
+    const ushort intended_character(intended.toLower().unicode());
+
+    return cost(typed_character, m_key_indices.value(typed_character, -1),
+                intended_character, m_key_indices.value(intended_character, -1));
+}
+
+
+//! \brief Computes the weighted edit distances of candidates to the typed
+//! word. Ignores case.
+//! \param typed The typed word.
+//! \param candidates The correction candidates.
+//! @returns one distance per candidate, in units of EditCost.
+QVector<int> ProximityCorrector::distances(const QString &typed,
+                                           const QStringList &candidates) const
+{
+    QVector<int> result(candidates.size());
+    const QString typed_lower(typed.toLower());
+    const int rows(typed_lower.length());
+
+    QVector<int> typed_keys(rows);
+    for (int row = 0; row < rows; ++row) {
+        typed_keys[row] = m_key_indices.value(typed_lower.at(row).unicode(), -1);
+    }
+
+    QVector<qint16> substitutions;
+    QVector<qint16> previous((rows + 1) * LaneCount);
+    QVector<qint16> current((rows + 1) * LaneCount);
+
+    for (int first = 0; first < candidates.size(); first += LaneCount) {
+        QString batch[LaneCount];
+        int lengths[LaneCount];
+        int columns(0);
+
+        for (int lane = 0; lane < LaneCount; ++lane) {
+            if (first + lane < candidates.size()) {
+                batch[lane] = candidates.at(first + lane).toLower();
+            }
+
+            lengths[lane] = batch[lane].length();
+            columns = qMax(columns, lengths[lane]);
+        }
+
+        // Lanes of shorter candidates are padded, their results are taken
+        // at their own length:
+        substitutions.fill(EditCost, columns * rows * LaneCount);
+        qint16 *const data(substitutions.data());
+
+        for (int lane = 0; lane < LaneCount; ++lane) {
+            for (int column = 0; column < lengths[lane]; ++column) {
+                const ushort intended(batch[lane].at(column).unicode());
+                const int intended_key(m_key_indices.value(intended, -1));
+
+                for (int row = 0; row < rows; ++row) {
+                    data[(column * rows + row) * LaneCount + lane] =
+                        cost(typed_lower.at(row).unicode(), typed_keys.at(row), intended, intended_key);
+                }
+            }
+        }
+
+        int distances[LaneCount];
+        batchDistances(rows, columns, data, lengths, distances, previous.data(), current.data());
+
+        for (int lane = 0; lane < LaneCount and first + lane < candidates.size(); ++lane) {
+            result[first + lane] = distances[lane];
+        }
+    }
+
+    return result;
+}
+
+
+//! \internal
+qint16 ProximityCorrector::cost(ushort typed,
+                                int typed_key,
+                                ushort intended,
+                                int intended_key) const
+{
+    if (typed == intended) {
+        return 0;
+    }
+
+    if (typed_key < 0 or intended_key < 0) {
+        return EditCost;
+    }
+
+    return m_costs.at(typed_key * m_key_count + intended_key);
+}
+//! \internal_end
+
+}} // namespace Logic, MaliitKeyboard
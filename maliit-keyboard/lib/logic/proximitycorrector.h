@@ -0,0 +1,78 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_PROXIMITYCORRECTOR_H
+#define MALIIT_KEYBOARD_PROXIMITYCORRECTOR_H
+
+#include "models/keyarea.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \brief Scores correction candidates by how likely they were mistyped on
+//! the current key area.
+//!
+//! Replacing a character by the one on a neighbouring key is cheaper than
+//! any other edit. Candidates are scored in batches by a weighted edit
+//! distance that runs on SIMD registers where available (SSE2, NEON).
+class ProximityCorrector
+{
+public:
+    enum {
+        EditCost = 8 //!< Cost of an insertion, deletion or unrelated substitution.
+    };
+
+    explicit ProximityCorrector();
+
+    void setKeyArea(const KeyArea &key_area);
+
+    int substitutionCost(const QChar &typed,
+                         const QChar &intended) const;
+    QVector<int> distances(const QString &typed,
+                           const QStringList &candidates) const;
+
+private:
+    QHash<ushort, int> m_key_indices; //!< lower case key labels to cost matrix rows.
+    int m_key_count;
+    QVector<qint16> m_costs; //!< substitution costs between keys.
+
+    qint16 cost(ushort typed,
+                int typed_key,
+                ushort intended,
+                int intended_key) const;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_PROXIMITYCORRECTOR_H
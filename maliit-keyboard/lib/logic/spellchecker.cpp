@@ -31,6 +31,7 @@
  */
 
 #include "spellchecker.h"
+#include "userdictionary.h"
 
 #ifdef HAVE_HUNSPELL
 #include "hunspell/hunspell.hxx"
@@ -53,18 +54,105 @@ private:
 };
 #endif
 
-#include <QFile>
-#include <QTextStream>
 #include <QTextCodec>
 #include <QStringList>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QWaitCondition>
 
 namespace MaliitKeyboard {
 namespace Logic {
+namespace {
+
+const int MaxCachedSpellings = 1024;
+const int MaxCachedSuggestions = 256;
+const int MaxSuggestionWorkers = 2;
+
+//! Asks a Hunspell instance for suggestions.
+//! \param hunspell The Hunspell instance to use.
+//! \param codec The codec of the Hunspell dictionary.
+//! \param word Base for suggestions.
+//! \param result Receives all suggestions.
+//! \return \c false if Hunspell failed to provide suggestions.
+bool suggestWith(Hunspell *hunspell,
+                 QTextCodec *codec,
+                 const QString &word,
+                 QStringList *result)
+{
+    char** suggestions = NULL;
+    const int suggestions_count = hunspell->suggest(&suggestions, codec->fromUnicode(word));
+
+    // Less than zero means some error.
+    if (suggestions_count < 0) {
+        qWarning() << __PRETTY_FUNCTION__ << ": Failed to get suggestions for" << word << ".";
+        return false;
+    }
+
+    for (int index(0); index < suggestions_count; ++index) {
+        result->append(codec->toUnicode(suggestions[index]));
+    }
+    hunspell->free_list(&suggestions, suggestions_count);
+
+    return true;
+}
+
+QStringList limited(const QStringList &suggestions,
+                    int limit)
+{
+    return (limit < 0) ? suggestions : suggestions.mid(0, limit);
+}
+
+//! A Hunspell instance owned by one suggestion worker thread.
+struct SuggestionWorker
+{
+    Hunspell hunspell;
+    int applied_user_words; //!< How many user words were added to this instance.
+
+    explicit SuggestionWorker(const QByteArray &aff_file,
+                              const QByteArray &dic_file)
+        : hunspell(aff_file.constData(), dic_file.constData())
+        , applied_user_words(0)
+    {}
+};
+
+//! State shared between a suggest() call and its worker job.
+struct SuggestionRequest
+{
+    const QString word;
+    const int cache_generation; //!< Results of outdated requests are not cached.
+    QMutex mutex;
+    QWaitCondition finished_condition;
+    bool finished;
+    bool cancelled;
+    QStringList result;
+
+    explicit SuggestionRequest(const QString &new_word,
+                               int new_cache_generation)
+        : word(new_word)
+        , cache_generation(new_cache_generation)
+        , mutex()
+        , finished_condition()
+        , finished(false)
+        , cancelled(false)
+        , result()
+    {}
+};
+
+typedef QSharedPointer<SuggestionRequest> SharedSuggestionRequest;
+
+} // namespace
 
 //! \class SpellChecker
 //! Checks spelling and suggest words. Currently Spellchecker is
 //! implemented by using Hunspell.
+//!
+//! Results of spell() and suggest() are kept in least recently used caches,
+//! as users tend to retype the same words and typos. Changing the user
+//! dictionary or the ignored words drops the cached results.
+//!
+//! Suggestions with a deadline run on a small pool of worker threads, each
+//! with its own Hunspell instance, so that a slow suggestion does not block
+//! the caller beyond the deadline.
 
 struct SpellCheckerPrivate
 {
@@ -72,42 +160,136 @@ struct SpellCheckerPrivate
     QTextCodec *codec; //!< Which codec to use.
     bool enabled; //!< Whether the spellchecker is enabled.
     QSet<QString> ignored_words; //!< The words to ignore.
-    QString user_dictionary_file;
+    UserDictionary user_dictionary; //!< Stores added user words in the background.
+    QByteArray aff_file; //!< Affix file, for worker Hunspell instances.
+    QByteArray dic_file; //!< Dictionary file, for worker Hunspell instances.
+    QStringList user_words; //!< User words, for worker Hunspell instances.
+    QCache<QString, bool> spellings; //!< Cached spell() results.
+    QCache<QString, QStringList> suggestions; //!< Cached, unlimited suggest() results.
+    int cache_generation; //!< Increased whenever the caches are dropped.
+    SpellChecker::CacheStatistics statistics;
+    mutable QMutex mutex; //!< Guards everything shared with worker threads.
+    QThreadStorage<SuggestionWorker *> workers;
+    QThreadPool pool; //!< Declared last, so that workers finish first.
 
     SpellCheckerPrivate(const QString &dictionary_path,
-                        const QString &user_dictionary);
+                        const QString &user_dictionary_file);
 };
 
 
+namespace {
+
+//! \internal
+class SuggestionJob
+    : public QRunnable
+{
+private:
+    SpellCheckerPrivate *const d;
+    const SharedSuggestionRequest m_request;
+
+public:
+    explicit SuggestionJob(SpellCheckerPrivate *spell_checker,
+                           const SharedSuggestionRequest &request)
+        : d(spell_checker)
+        , m_request(request)
+    {}
+
+    void run();
+};
+//! \internal_end
+
+} // namespace
+
+
 SpellCheckerPrivate::SpellCheckerPrivate(const QString &dictionary_path,
-                                         const QString &user_dictionary)
+                                         const QString &user_dictionary_file)
     // XXX: toUtf8? toLatin1? toAscii? toLocal8Bit?
     : hunspell((dictionary_path + ".aff").toUtf8().constData(),
                (dictionary_path + ".dic").toUtf8().constData())
     , codec(QTextCodec::codecForName(hunspell.get_dic_encoding()))
     , enabled(false)
     , ignored_words()
-    , user_dictionary_file(user_dictionary)
+    , user_dictionary(user_dictionary_file)
+    , aff_file((dictionary_path + ".aff").toUtf8())
+    , dic_file((dictionary_path + ".dic").toUtf8())
+    , user_words()
+    , spellings(MaxCachedSpellings)
+    , suggestions(MaxCachedSuggestions)
+    , cache_generation(0)
+    , statistics()
+    , mutex()
+    , workers()
+    , pool()
 {
+    // Loading a dictionary is expensive, so keep the workers around:
+    pool.setMaxThreadCount(MaxSuggestionWorkers);
+    pool.setExpiryTimeout(-1);
+
     if (not codec) {
         qWarning () << __PRETTY_FUNCTION__ << ":Could not find codec for" << hunspell.get_dic_encoding() << "- turning off spellchecking and suggesting.";
         return;
     }
 
-    if (not user_dictionary.isEmpty() and QFile::exists(user_dictionary)) {
-        QFile file(user_dictionary);
-        if (file.open(QFile::ReadOnly)) {
-            QTextStream stream(&file);
-            while (!stream.atEnd()) {
-                hunspell.add(codec->fromUnicode(stream.readLine()));
-            }
-        }
+    user_words = user_dictionary.load();
+
+    Q_FOREACH (const QString &word, user_words) {
+        hunspell.add(codec->fromUnicode(word));
     }
 
     enabled = true;
 }
 
 
+void SuggestionJob::run()
+{
+    {
+        QMutexLocker locker(&m_request->mutex);
+
+        // The caller gave up before this job started:
+        if (m_request->cancelled) {
+            return;
+        }
+    }
+
+    if (not d->workers.hasLocalData()) {
+        d->workers.setLocalData(new SuggestionWorker(d->aff_file, d->dic_file));
+    }
+
+    SuggestionWorker *const worker(d->workers.localData());
+    QStringList new_user_words;
+    int cache_generation;
+
+    {
+        QMutexLocker locker(&d->mutex);
+        new_user_words = d->user_words.mid(worker->applied_user_words);
+        cache_generation = d->cache_generation;
+    }
+
+    Q_FOREACH (const QString &word, new_user_words) {
+        worker->hunspell.add(d->codec->fromUnicode(word));
+    }
+    worker->applied_user_words += new_user_words.count();
+
+    QStringList result;
+    const bool valid(suggestWith(&worker->hunspell, d->codec, m_request->word, &result));
+
+    if (valid) {
+        QMutexLocker locker(&d->mutex);
+
+        // Even if the caller gave up meanwhile, a later request can use it:
+        if (d->cache_generation == cache_generation
+            && m_request->cache_generation == cache_generation) {
+            d->suggestions.insert(m_request->word, new QStringList(result));
+        }
+    }
+
+    QMutexLocker locker(&m_request->mutex);
+    m_request->result = result;
+    m_request->finished = true;
+    m_request->finished_condition.wakeAll();
+}
+
+
 SpellChecker::~SpellChecker()
 {}
 
@@ -130,20 +312,43 @@ bool SpellChecker::spell(const QString &word)
 {
     Q_D(SpellChecker);
 
-    if (not d->enabled or d->ignored_words.contains(word)) {
+    if (not d->enabled) {
+        return true;
+    }
+
+    QMutexLocker locker(&d->mutex);
+
+    if (d->ignored_words.contains(word)) {
         return true;
     }
 
-    return d->hunspell.spell(d->codec->fromUnicode(word));
+    if (const bool *const cached = d->spellings.object(word)) {
+        ++d->statistics.spell_hits;
+        return *cached;
+    }
+
+    ++d->statistics.spell_misses;
+    const bool result(d->hunspell.spell(d->codec->fromUnicode(word)));
+    d->spellings.insert(word, new bool(result));
+
+    return result;
 }
 
 
 //! \brief Gives suggestions for a given word.
 //! \param word Base for suggestions.
 //! \param limit Suggestion count limit (-1 for no limits).
+//! \param deadline Time in milliseconds to wait for suggestions (-1 for no
+//!                 deadline). With a deadline, suggestions are computed on a
+//!                 worker thread; if they are not ready in time, an empty
+//!                 list is returned. Late results still get cached, unless
+//!                 their computation did not even start before the deadline.
+//!                 A deadline of 0 does not wait at all, and only computes
+//!                 the suggestions for the cache.
 //! \return a list of suggestions.
 QStringList SpellChecker::suggest(const QString &word,
-                                  int limit)
+                                  int limit,
+                                  int deadline)
 {
     Q_D(SpellChecker);
 
@@ -151,23 +356,78 @@ QStringList SpellChecker::suggest(const QString &word,
         return QStringList();
     }
 
-    char** suggestions = NULL;
-    const int suggestions_count = d->hunspell.suggest(&suggestions, d->codec->fromUnicode(word));
+    int cache_generation;
 
-    // Less than zero means some error.
-    if (suggestions_count < 0) {
-        qWarning() << __PRETTY_FUNCTION__ << ": Failed to get suggestions for" << word << ".";
+    {
+        QMutexLocker locker(&d->mutex);
+
+        if (const QStringList *const cached = d->suggestions.object(word)) {
+            ++d->statistics.suggest_hits;
+            return limited(*cached, limit);
+        }
+
+        ++d->statistics.suggest_misses;
+        cache_generation = d->cache_generation;
+    }
+
+    if (deadline < 0) {
+        // The Hunspell instance is shared with spell() and
+        // addToUserWordlist(), which might run on other threads:
+        QMutexLocker locker(&d->mutex);
+        QStringList result;
+
+        if (not suggestWith(&d->hunspell, d->codec, word, &result)) {
+            return QStringList();
+        }
+
+        if (d->cache_generation == cache_generation) {
+            d->suggestions.insert(word, new QStringList(result));
+        }
+
+        return limited(result, limit);
+    }
+
+    const SharedSuggestionRequest request(new SuggestionRequest(word, cache_generation));
+    d->pool.start(new SuggestionJob(d, request));
+
+    if (deadline == 0) {
+        QMutexLocker statistics_locker(&d->mutex);
+        ++d->statistics.suggest_timeouts;
         return QStringList();
     }
 
-    QStringList result;
-    const int final_limit((limit < 0) ? suggestions_count : qMin(limit, suggestions_count));
+    QMutexLocker locker(&request->mutex);
+    QElapsedTimer timer;
+    timer.start();
+
+    while (not request->finished) {
+        const qint64 remaining(deadline - timer.elapsed());
 
-    for (int index(0); index < final_limit; ++index) {
-        result << d->codec->toUnicode(suggestions[index]);
+        if (remaining <= 0
+            || not request->finished_condition.wait(&request->mutex, remaining)) {
+            break;
+        }
     }
-    d->hunspell.free_list(&suggestions, suggestions_count);
-    return result;
+
+    if (not request->finished) {
+        request->cancelled = true;
+        locker.unlock();
+
+        QMutexLocker statistics_locker(&d->mutex);
+        ++d->statistics.suggest_timeouts;
+        return QStringList();
+    }
+
+    return limited(request->result, limit);
+}
+
+
+//! \brief Waits until all suggestions computed on worker threads are done,
+//! and cached.
+void SpellChecker::waitForSuggestions()
+{
+    Q_D(SpellChecker);
+    d->pool.waitForDone();
 }
 
 
@@ -181,7 +441,12 @@ void SpellChecker::ignoreWord(const QString &word)
         return;
     }
 
-    d->ignored_words.insert(word);
+    {
+        QMutexLocker locker(&d->mutex);
+        d->ignored_words.insert(word);
+    }
+
+    clearCache();
 }
 
 //! \brief Adds a given word to user dictionary.
@@ -195,17 +460,52 @@ void SpellChecker::addToUserWordlist(const QString &word)
         return;
     }
 
-    QFile user_dictionary(d->user_dictionary_file);
-    QDir::home().mkpath(QFileInfo(user_dictionary).absolutePath());
-    if (user_dictionary.open(QFile::Append)) {
-        QTextStream stream(&user_dictionary);
-        stream << word << endl;
-    }
+    // Written on a background thread:
+    d->user_dictionary.append(word);
 
-    // Non-zero return value means some error.
-    if (d->hunspell.add(d->codec->fromUnicode(word))) {
-        qWarning() << __PRETTY_FUNCTION__ << ": Failed to add '" << word << "' to user dictionary.";
+    {
+        QMutexLocker locker(&d->mutex);
+
+        // Non-zero return value means some error.
+        if (d->hunspell.add(d->codec->fromUnicode(word))) {
+            qWarning() << __PRETTY_FUNCTION__ << ": Failed to add '" << word << "' to user dictionary.";
+        }
+
+        // Worker instances pick up new user words before their next request:
+        d->user_words.append(word);
     }
+
+    clearCache();
+}
+
+//! \brief Returns the words of the user dictionary, including the ones
+//! added since construction, which might contain duplicates.
+QStringList SpellChecker::userWords() const
+{
+    Q_D(const SpellChecker);
+    QMutexLocker locker(&d->mutex);
+    return d->user_words;
+}
+
+//! \brief Returns hit and miss counters of the spell and suggest caches.
+SpellChecker::CacheStatistics SpellChecker::cacheStatistics() const
+{
+    Q_D(const SpellChecker);
+    QMutexLocker locker(&d->mutex);
+    return d->statistics;
+}
+
+//! \brief Drops all cached spell and suggest results.
+//!
+//! Statistics are kept.
+void SpellChecker::clearCache()
+{
+    Q_D(SpellChecker);
+    QMutexLocker locker(&d->mutex);
+
+    d->spellings.clear();
+    d->suggestions.clear();
+    ++d->cache_generation;
 }
 
 // static
@@ -214,4 +514,41 @@ QString SpellChecker::dictPath()
     return QString(HUNSPELL_DICT_PATH);
 }
 
+//! \brief Finds the Hunspell dictionary for a layout language.
+//! \param language The language, as declared by a layout, like "de", "en_gb"
+//!                 or "sr@latin".
+//! \param directory The directory containing the dictionaries.
+//! @returns the dictionary path, without the .aff and .dic suffixes, or an
+//!          empty string if there is no dictionary for language. A language
+//!          without region prefers the dictionary of its main region, like
+//!          de_DE for "de".
+// static
+QString SpellChecker::findDictionary(const QString &language,
+                                     const QString &directory)
+{
+    const QString &locale(language.section('@', 0, 0));
+    const QString &code(locale.section('_', 0, 0).toLower());
+    const QString &region(locale.section('_', 1).toUpper());
+
+    if (code.isEmpty()) {
+        return QString();
+    }
+
+    QStringList names;
+    names.append(region.isEmpty() ? code + '_' + code.toUpper()
+                                  : code + '_' + region);
+    names.append(code);
+
+    const QDir dir(directory);
+    names += dir.entryList(QStringList(code + "_*.aff"), QDir::Files, QDir::Name).replaceInStrings(".aff", "");
+
+    Q_FOREACH (const QString &name, names) {
+        if (dir.exists(name + ".aff") and dir.exists(name + ".dic")) {
+            return dir.filePath(name);
+        }
+    }
+
+    return QString();
+}
+
 }} // namespace Logic, MaliitKeyboard
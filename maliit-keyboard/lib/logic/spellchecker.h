@@ -45,6 +45,16 @@ class SpellChecker
     Q_DISABLE_COPY(SpellChecker)
     Q_DECLARE_PRIVATE(SpellChecker)
 public:
+    //! Hit and miss counters of the spell and suggest result caches.
+    struct CacheStatistics
+    {
+        int spell_hits;
+        int spell_misses;
+        int suggest_hits;
+        int suggest_misses;
+        int suggest_timeouts; //!< Suggestions that missed their deadline.
+    };
+
     // FIXME: Find better way to discover default dictionaries.
     // FIXME: Allow changing languages in between.
     explicit SpellChecker(const QString &dictionary_path = QString("%1/en_GB").arg(SpellChecker::dictPath()),
@@ -54,11 +64,19 @@ public:
 
     bool spell(const QString &word);
     QStringList suggest(const QString &word,
-                        int limit = -1);
+                        int limit = -1,
+                        int deadline = -1);
+    void waitForSuggestions();
     void ignoreWord(const QString &word);
     void addToUserWordlist(const QString &word);
+    QStringList userWords() const;
+
+    CacheStatistics cacheStatistics() const;
+    void clearCache();
 
     static QString dictPath();
+    static QString findDictionary(const QString &language,
+                                  const QString &directory = dictPath());
 
 private:
     const QScopedPointer<SpellCheckerPrivate> d_ptr;
@@ -0,0 +1,352 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "swipedecoder.h"
+#include "dawg.h"
+
+#include <cmath>
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+namespace {
+
+const int MaxSamples = 128;
+const int MaxWordLength = 32;
+const int BeamWidth = 64;
+//! Path samples per key width.
+const int SamplesPerKey = 4;
+//! Samples on either side of a sample, for measuring turns.
+const int TurnSpan = 2;
+//! Turns sharper than this, in radians, should have a letter.
+const qreal CornerAngle = 1.0;
+//! Cost of passing a sharp turn without letter.
+const qreal CornerCost = 0.5;
+//! Letters further away from the path, in key widths, are rejected.
+const qreal MaxKeyDistance = 1.2;
+//! Weighs word frequencies against squared key distances.
+const qreal FrequencyWeight = 0.1;
+//! Weighs the difference between path length and the distance between the
+//! letters of a word.
+const qreal LengthWeight = 0.5;
+//! Cost of characters without key, such as apostrophes.
+const qreal SkipCost = 0.5;
+
+//! \internal
+struct Hypothesis
+{
+    int parent; //!< Hypothesis one character shorter, -1 for none.
+    ushort label; //!< Last character.
+    quint32 node; //!< Word graph node reached.
+    int sample; //!< Path sample the last letter was matched to.
+    int key; //!< Key of the last letter, -1 before the first letter.
+    qreal cost; //!< Sum of squared key distances.
+    qreal length; //!< Distance between the letters so far.
+    qreal priority;
+};
+
+bool lessThanPriority(const Hypothesis &a,
+                      const Hypothesis &b)
+{
+    return a.priority < b.priority;
+}
+
+qreal squaredLength(const QPointF &vector)
+{
+    return vector.x() * vector.x() + vector.y() * vector.y();
+}
+
+//! @returns points along path, step apart.
+QVector<QPointF> resample(const QVector<QPointF> &path,
+                          qreal step)
+{
+    QVector<QPointF> result;
+    qreal carried(0); // Distance covered since the last sample.
+
+    result.append(path.first());
+
+    for (int index = 1; index < path.size(); ++index) {
+        QPointF from(path.at(index - 1));
+        const QPointF &to(path.at(index));
+        qreal segment(std::sqrt(squaredLength(to - from)));
+
+        while (carried + segment >= step) {
+            from += (to - from) * ((step - carried) / segment);
+            result.append(from);
+            segment = std::sqrt(squaredLength(to - from));
+            carried = 0;
+        }
+
+        carried += segment;
+    }
+
+    if (carried > 0) {
+        result.append(path.last());
+    }
+
+    return result;
+}
+
+QString wordOf(const QVector<Hypothesis> &hypotheses,
+               int index,
+               ushort label)
+{
+    QString result(QChar(label));
+
+    for (; index >= 0 and hypotheses.at(index).parent >= 0; index = hypotheses.at(index).parent) {
+        result.prepend(QChar(hypotheses.at(index).label));
+    }
+
+    return result;
+}
+//! \internal_end
+
+} // namespace
+
+//! \brief Constructor. Decodes nothing until a key area is set.
+SwipeDecoder::SwipeDecoder()
+    : m_key_indices()
+    , m_centers()
+    , m_key_width(1)
+{}
+
+
+//! \brief Takes the key centers from key_area. Only keys inserting a single
+//! character are used.
+void SwipeDecoder::setKeyArea(const KeyArea &key_area)
+{
+    qreal total_width(0);
+
+    m_key_indices.clear();
+    m_centers.clear();
+
+    Q_FOREACH (const Key &key, key_area.keys()) {
+        const QString &label(key.label().text());
+
+        if (key.action() != Key::ActionInsert || label.length() != 1
+            || m_key_indices.contains(label.at(0).unicode())) {
+            continue;
+        }
+
+        m_key_indices.insert(label.at(0).toLower().unicode(), m_centers.size());
+        m_key_indices.insert(label.at(0).toUpper().unicode(), m_centers.size());
+        m_centers.append(QRectF(key.rect()).center());
+        total_width += key.rect().width();
+    }
+
+    m_key_width = (m_centers.isEmpty() ? 1 : qMax<qreal>(1, total_width / m_centers.size()));
+}
+
+
+//! \brief Finds the words that fit a swipe path best.
+//! \param reader The word list to choose words from.
+//! \param path The touch points of the swipe, in key area coordinates.
+//! \param limit Maximum number of words, or -1 for all words found.
+//! @returns words ordered by how well they fit the path and how frequent
+//!          they are, best first.
+QStringList SwipeDecoder::decode(const DawgReader &reader,
+                                 const QVector<QPointF> &path,
+                                 int limit) const
+{
+    QStringList result;
+
+    if (not reader.isValid() or m_centers.isEmpty() or path.size() < 2 or limit == 0) {
+        return result;
+    }
+
+    qreal path_length(0);
+
+    for (int index = 1; index < path.size(); ++index) {
+        path_length += std::sqrt(squaredLength(path.at(index) - path.at(index - 1)));
+    }
+
+    if (path_length <= 0) {
+        return result;
+    }
+
+    const QVector<QPointF> &samples(resample(path, qMax(m_key_width / SamplesPerKey,
+                                                        path_length / (MaxSamples - 2))));
+    const int count(samples.size());
+
+    QVector<qreal> turns(count, 0);
+
+    for (int index = TurnSpan; index < count - TurnSpan; ++index) {
+        const QPointF in(samples.at(index) - samples.at(index - TurnSpan));
+        const QPointF out(samples.at(index + TurnSpan) - samples.at(index));
+        const qreal norm(std::sqrt(squaredLength(in) * squaredLength(out)));
+
+        if (norm > 0) {
+            turns[index] = std::acos(qBound<qreal>(-1, (in.x() * out.x() + in.y() * out.y()) / norm, 1));
+        }
+    }
+
+    // corners[i] sums up the cost of the sharp turns before sample i, so
+    // passing the turns between samples i and j costs corners[j] - corners[i + 1]:
+    QVector<qreal> corners(count + 1, 0);
+
+    for (int index = 0; index < count; ++index) {
+        const bool is_corner(index > 0 and index < count - 1 and turns.at(index) > CornerAngle
+                             and turns.at(index) >= turns.at(index - 1) and turns.at(index) > turns.at(index + 1));
+        corners[index + 1] = corners.at(index) + (is_corner ? CornerCost : 0);
+    }
+
+    // Squared distance of each key to each sample, in key widths, and the
+    // sample a letter fits best after each sample:
+    const int key_count(m_centers.size());
+    const qreal scale(1 / (m_key_width * m_key_width));
+    QVector<qreal> distances(key_count * count);
+    QVector<int> closest(key_count * count);
+    QVector<int> ahead(count);
+
+    for (int key = 0; key < key_count; ++key) {
+        qreal *const key_distances(distances.data() + key * count);
+        int *const key_closest(closest.data() + key * count);
+
+        for (int index = 0; index < count; ++index) {
+            key_distances[index] = squaredLength(samples.at(index) - m_centers.at(key)) * scale;
+        }
+
+        // ahead[i] minimizes distance plus passed turns over samples >= i:
+        ahead[count - 1] = count - 1;
+
+        for (int index = count - 2; index >= 0; --index) {
+            const int next(ahead.at(index + 1));
+            ahead[index] = (key_distances[index] + corners.at(index)
+                            <= key_distances[next] + corners.at(next) ? index : next);
+        }
+
+        key_closest[count - 1] = count - 1;
+
+        for (int index = 0; index < count - 1; ++index) {
+            const int next(ahead.at(index + 1));
+            key_closest[index] = (key_distances[index]
+                                  <= key_distances[next] + corners.at(next) - corners.at(index + 1) ? index : next);
+        }
+    }
+
+    const qreal max_distance(MaxKeyDistance * MaxKeyDistance);
+    const qreal max_length(path_length + 2 * m_key_width);
+    QVector<Hypothesis> hypotheses;
+    QVector<int> beam;
+    QList<QPair<qreal, QString> > words;
+
+    const Hypothesis start = {-1, 0, reader.rootNode(), 0, -1, 0, 0, 0};
+    hypotheses.append(start);
+    beam.append(0);
+
+    for (int depth = 0; depth < MaxWordLength and not beam.isEmpty(); ++depth) {
+        QVector<Hypothesis> next;
+
+        Q_FOREACH (int index, beam) {
+            const Hypothesis current(hypotheses.at(index));
+            const int edge_count(reader.edgeCount(current.node));
+
+            for (int edge = 0; edge < edge_count; ++edge) {
+                Hypothesis child(current);
+                child.parent = index;
+                child.label = reader.edgeLabel(current.node, edge);
+                child.node = reader.edgeTarget(current.node, edge);
+
+                const int key(m_key_indices.value(child.label, -1));
+                const qreal *const key_distances(key < 0 ? 0 : distances.constData() + key * count);
+
+                if (key < 0) {
+                    // Characters without key are skipped over:
+                    child.cost += SkipCost;
+                } else {
+                    child.sample = (current.key < 0 ? 0 : closest.at(key * count + current.sample));
+                    child.key = key;
+
+                    if (key_distances[child.sample] > max_distance) {
+                        continue;
+                    }
+
+                    child.cost += key_distances[child.sample];
+
+                    if (child.sample > current.sample) {
+                        child.cost += corners.at(child.sample) - corners.at(current.sample + 1);
+                    }
+
+                    if (current.key >= 0) {
+                        child.length += std::sqrt(squaredLength(m_centers.at(key) - m_centers.at(current.key)));
+                    }
+
+                    if (child.length > max_length) {
+                        continue;
+                    }
+                }
+
+                // The last letter is matched to the end of the path:
+                const quint32 frequency(reader.wordFrequency(child.node));
+
+                if (frequency > 0 and key >= 0 and current.key >= 0
+                    and key_distances[count - 1] <= max_distance) {
+                    const qreal length_error((path_length - child.length) / m_key_width);
+                    const qreal score(current.cost + key_distances[count - 1]
+                                      + (count - 1 > current.sample ? corners.at(count - 1) - corners.at(current.sample + 1) : 0)
+                                      + LengthWeight * length_error * length_error
+                                      - FrequencyWeight * std::log(qreal(frequency)));
+
+                    words.append(qMakePair(score, wordOf(hypotheses, index, child.label)));
+                }
+
+                if (reader.edgeCount(child.node) > 0) {
+                    child.priority = child.cost - FrequencyWeight * std::log(qreal(qMax<quint32>(1, reader.maxFrequency(child.node))));
+                    next.append(child);
+                }
+            }
+        }
+
+        qSort(next.begin(), next.end(), lessThanPriority);
+
+        if (next.size() > BeamWidth) {
+            next.resize(BeamWidth);
+        }
+
+        beam.clear();
+
+        Q_FOREACH (const Hypothesis &hypothesis, next) {
+            beam.append(hypotheses.size());
+            hypotheses.append(hypothesis);
+        }
+    }
+
+    qSort(words);
+
+    for (int index = 0; index < words.size() and (limit < 0 or index < limit); ++index) {
+        result.append(words.at(index).second);
+    }
+
+    return result;
+}
+
+}} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,405 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "userdictionary.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MaliitKeyboard {
+namespace Logic {
+namespace {
+
+//! Reads a word list, one UTF-8 encoded word per line, from a memory mapped
+//! file.
+//! \param file_name The word list.
+//! \param words Receives the words, in file order.
+//! @returns the number of words read.
+int readWords(const QString &file_name,
+              QStringList *words)
+{
+    QFile file(file_name);
+
+    if (file.size() <= 0 or not file.open(QFile::ReadOnly)) {
+        return 0;
+    }
+
+    uchar *const data(file.map(0, file.size()));
+    QByteArray contents;
+
+    // Some file systems do not support mapping:
+    if (not data) {
+        contents = file.readAll();
+    }
+
+    const char *const begin(data ? reinterpret_cast<const char *>(data) : contents.constData());
+    const char *const end(begin + (data ? file.size() : contents.size()));
+    int count(0);
+
+    for (const char *line = begin; line < end;) {
+        const char *line_end(static_cast<const char *>(std::memchr(line, '\n', end - line)));
+
+        if (not line_end) {
+            line_end = end;
+        }
+
+        int length(line_end - line);
+
+        if (length > 0 and line[length - 1] == '\r') {
+            --length;
+        }
+
+        if (length > 0) {
+            words->append(QString::fromUtf8(line, length));
+            ++count;
+        }
+
+        line = line_end + 1;
+    }
+
+    if (data) {
+        file.unmap(data);
+    }
+
+    return count;
+}
+
+
+//! Serializes words, one per line.
+QByteArray wordLines(const QStringList &words)
+{
+    QByteArray result;
+
+    Q_FOREACH (const QString &word, words) {
+        result.append(word.toUtf8());
+        result.append('\n');
+    }
+
+    return result;
+}
+
+} // namespace
+
+//! \class UserDictionary
+//! \brief Stores the words a user added to the spellchecker.
+//!
+//! The dictionary is a snapshot file, one word per line, plus a journal of
+//! words added since the snapshot was written. Added words are appended to
+//! the journal on a writer thread, in batches of all words added within
+//! FlushDelay milliseconds. Once the journal holds CompactionThreshold
+//! words, it is merged into a new, sorted and deduplicated snapshot.
+//!
+//! Older versions appended to the snapshot file directly, which is still
+//! readable as an unsorted snapshot.
+//!
+//! Several spell checkers can use the same user dictionary. All instances
+//! for the same file share one journal writer, so that a compaction never
+//! drops words another instance journaled meanwhile.
+
+//! \internal
+struct UserDictionaryPrivate
+{
+    const QString file_name;
+    const QString journal_file_name;
+    QMutex mutex; //!< Guards pending_words and flush_requested.
+    QWaitCondition flush_condition; //!< Ends the wait for more words to write.
+    QStringList pending_words; //!< Added, but not yet journaled words.
+    bool flush_requested;
+    int journaled_words; //!< -1 until counted. Only used by the writer.
+    QThreadPool writer; //!< Declared last, so that writes finish first.
+
+    explicit UserDictionaryPrivate(const QString &new_file_name);
+
+    void writePendingWords();
+    void compact();
+};
+
+
+namespace {
+
+class WriterJob
+    : public QRunnable
+{
+public:
+    enum Task {
+        WritePendingWords,
+        Compact
+    };
+
+private:
+    UserDictionaryPrivate *const d;
+    const Task m_task;
+
+public:
+    explicit WriterJob(UserDictionaryPrivate *user_dictionary,
+                       Task task)
+        : d(user_dictionary)
+        , m_task(task)
+    {}
+
+    void run()
+    {
+        if (m_task == Compact) {
+            d->compact();
+        } else {
+            d->writePendingWords();
+        }
+    }
+};
+
+} // namespace
+
+
+UserDictionaryPrivate::UserDictionaryPrivate(const QString &new_file_name)
+    : file_name(new_file_name)
+    , journal_file_name(new_file_name.isEmpty() ? QString() : new_file_name + ".journal")
+    , mutex()
+    , flush_condition()
+    , pending_words()
+    , flush_requested(false)
+    , journaled_words(-1)
+    , writer()
+{
+    // A single writer keeps the journal and the snapshot consistent:
+    writer.setMaxThreadCount(1);
+}
+
+
+void UserDictionaryPrivate::writePendingWords()
+{
+    QStringList words;
+
+    {
+        QMutexLocker locker(&mutex);
+
+        // Words added in quick succession get written at once:
+        if (not flush_requested) {
+            flush_condition.wait(&mutex, UserDictionary::FlushDelay);
+        }
+
+        words.swap(pending_words);
+    }
+
+    if (words.isEmpty()) {
+        return;
+    }
+
+    QDir().mkpath(QFileInfo(journal_file_name).absolutePath());
+    QFile journal(journal_file_name);
+    const QByteArray &data(wordLines(words));
+
+    if (not journal.open(QFile::WriteOnly | QFile::Append)
+        or journal.write(data) != data.size()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << ": Failed to write" << words << "to" << journal_file_name << ".";
+        return;
+    }
+
+    journal.close();
+
+    if (journaled_words < 0) {
+        QStringList journal_words;
+        journaled_words = readWords(journal_file_name, &journal_words);
+    } else {
+        journaled_words += words.count();
+    }
+
+    if (journaled_words >= UserDictionary::CompactionThreshold) {
+        compact();
+    }
+}
+
+
+void UserDictionaryPrivate::compact()
+{
+    QStringList words;
+    readWords(file_name, &words);
+    readWords(journal_file_name, &words);
+
+    std::sort(words.begin(), words.end());
+    words.erase(std::unique(words.begin(), words.end()), words.end());
+
+    QDir().mkpath(QFileInfo(file_name).absolutePath());
+    QSaveFile snapshot(file_name);
+
+    // The snapshot gets replaced atomically, so the journal can only be
+    // dropped afterwards:
+    if (not snapshot.open(QFile::WriteOnly)
+        or snapshot.write(wordLines(words)) < 0
+        or not snapshot.commit()) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << ": Failed to write" << file_name << ":" << snapshot.errorString();
+        return;
+    }
+
+    QFile::remove(journal_file_name);
+    journaled_words = 0;
+}
+
+
+namespace {
+
+//! @returns the state of the user dictionary stored in file_name, shared
+//!          by all instances for that file.
+QSharedPointer<UserDictionaryPrivate> sharedDictionary(const QString &file_name)
+{
+    // Dictionaries that are not stored have nothing to share:
+    if (file_name.isEmpty()) {
+        return QSharedPointer<UserDictionaryPrivate>(new UserDictionaryPrivate(file_name));
+    }
+
+    static QMutex mutex;
+    static QHash<QString, QWeakPointer<UserDictionaryPrivate> > dictionaries;
+    QMutexLocker locker(&mutex);
+
+    QSharedPointer<UserDictionaryPrivate> result(dictionaries.value(file_name).toStrongRef());
+
+    if (not result) {
+        result = QSharedPointer<UserDictionaryPrivate>(new UserDictionaryPrivate(file_name));
+        dictionaries.insert(file_name, result);
+    }
+
+    return result;
+}
+
+} // namespace
+//! \internal_end
+
+
+//! \param file_name The snapshot file of the user dictionary. Can be empty
+//!                  for a dictionary that is not stored.
+UserDictionary::UserDictionary(const QString &file_name)
+    : d_ptr(sharedDictionary(file_name))
+{}
+
+
+//! \brief Destructor. Writes pending words.
+UserDictionary::~UserDictionary()
+{
+    flush();
+}
+
+
+//! @returns the snapshot file of the user dictionary.
+QString UserDictionary::fileName() const
+{
+    Q_D(const UserDictionary);
+    return d->file_name;
+}
+
+
+//! @returns the journal file of the user dictionary.
+QString UserDictionary::journalFileName() const
+{
+    Q_D(const UserDictionary);
+    return d->journal_file_name;
+}
+
+
+//! \brief Reads the words of the snapshot and of the journal.
+//!
+//! Both files are memory mapped, instead of being read line by line. A
+//! journal with too many words gets compacted in the background.
+//! @returns the user words, which might contain duplicates.
+QStringList UserDictionary::load()
+{
+    Q_D(UserDictionary);
+    QStringList words;
+
+    if (d->file_name.isEmpty()) {
+        return words;
+    }
+
+    d->writer.waitForDone();
+    readWords(d->file_name, &words);
+
+    if (readWords(d->journal_file_name, &words) >= CompactionThreshold) {
+        d->writer.start(new WriterJob(d, WriterJob::Compact));
+    }
+
+    return words;
+}
+
+
+//! \brief Adds a word to the journal, on the writer thread.
+//! \param word The word to add.
+void UserDictionary::append(const QString &word)
+{
+    Q_D(UserDictionary);
+
+    if (d->file_name.isEmpty() or word.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&d->mutex);
+    const bool write_scheduled(not d->pending_words.isEmpty());
+    d->pending_words.append(word);
+
+    if (not write_scheduled) {
+        d->writer.start(new WriterJob(d, WriterJob::WritePendingWords));
+    }
+}
+
+
+//! \brief Writes pending words right away and waits until they are written.
+void UserDictionary::flush()
+{
+    Q_D(UserDictionary);
+
+    {
+        QMutexLocker locker(&d->mutex);
+        d->flush_requested = true;
+        d->flush_condition.wakeAll();
+    }
+
+    d->writer.waitForDone();
+
+    QMutexLocker locker(&d->mutex);
+    d->flush_requested = false;
+}
+
+
+//! \brief Merges the journal into the snapshot and waits until it is
+//! written.
+void UserDictionary::compact()
+{
+    Q_D(UserDictionary);
+
+    if (d->file_name.isEmpty()) {
+        return;
+    }
+
+    d->writer.start(new WriterJob(d, WriterJob::Compact));
+    flush();
+}
+
+}} // namespace Logic, MaliitKeyboard
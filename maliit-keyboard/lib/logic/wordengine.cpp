@@ -31,9 +31,17 @@
  */
 
 #include "wordengine.h"
+#include "addressindex.h"
+#include "cachingpredictionbackend.h"
+#include "candidateranker.h"
+#include "proximitycorrector.h"
 #include "spellchecker.h"
+#include "wordenginebackend.h"
+#include "coreutils.h"
 
-#ifdef HAVE_PRESAGE
+#if defined(HAVE_NGRAM)
+#include "ngrammodel.h"
+#elif defined(HAVE_PRESAGE)
 #include <presage.h>
 #endif
 
@@ -42,36 +50,75 @@ namespace Logic {
 
 namespace {
 
-void appendToCandidates(WordCandidateList *candidates,
-                        WordCandidate::Source source,
-                        const QString &candidate,
-                        bool is_preedit_capitalized)
+//! Milliseconds to wait for spelling corrections, before giving up on them.
+const int SpellingCorrectionDeadline = 30;
+//! Dictionaries kept loaded, for users switching languages while typing.
+const int MaxDictionaries = 3;
+
+//! Candidate costs, see CandidateRanker. Predictions and user words take
+//! turns, by rank. Spelling corrections only fill the remaining places, as
+//! every incomplete word looks misspelled.
+const int PredictionCost = 0;
+const int UserWordCost = 1;
+const int RankCost = 2;
+const int CorrectionCost = 1 << 16;
+//! Known addresses go before email addresses completed with a known domain.
+const int AddressCost = 0;
+const int DomainCost = 1;
+
+//! \internal
+//! A loaded Hunspell dictionary.
+struct Dictionary
 {
-    if (not candidates) {
-        return;
-    }
+    QString path; //!< dictionary path, without the .aff and .dic suffixes.
+    QSharedPointer<SpellChecker> spell_checker;
+};
 
-    QString changed_candidate(candidate);
+//! Spell checking result of one dictionary.
+struct SpellingResult
+{
+    bool correct;
+    QStringList corrections; //!< best first, only for misspelled words.
+};
 
-    if (not changed_candidate.isEmpty() && is_preedit_capitalized) {
-        changed_candidate[0] = changed_candidate.at(0).toUpper();
-    }
+//! Checks the spelling of a word with one dictionary, on a thread of the
+//! dictionary pool.
+class SpellingJob
+    : public QRunnable
+{
+private:
+    SpellChecker *const m_spell_checker;
+    const QString m_word;
+    const int m_limit;
+    SpellingResult *const m_result;
+    QSemaphore *const m_finished;
 
-    WordCandidate word_candidate(source, changed_candidate);
+public:
+    explicit SpellingJob(SpellChecker *spell_checker,
+                         const QString &word,
+                         int limit,
+                         SpellingResult *result,
+                         QSemaphore *finished)
+        : m_spell_checker(spell_checker)
+        , m_word(word)
+        , m_limit(limit)
+        , m_result(result)
+        , m_finished(finished)
+    {}
+
+    void run()
+    {
+        m_result->correct = m_spell_checker->spell(m_word);
+
+        if (not m_result->correct) {
+            m_result->corrections = m_spell_checker->suggest(m_word, m_limit, SpellingCorrectionDeadline);
+        }
 
-    if (not candidates->contains(word_candidate)) {
-        candidates->append(word_candidate);
+        m_finished->release();
     }
-}
-
-} // namespace
-
-//! \class WordEngine
-//! \brief Provides error correction (based on Hunspell) and word
-//! prediction (based on Presage).
+};
 
-//! \internal
-#ifdef HAVE_PRESAGE
+#if defined(HAVE_PRESAGE) && !defined(HAVE_NGRAM)
 class CandidatesCallback
     : public PresageCallback
 {
@@ -101,121 +148,539 @@ std::string CandidatesCallback::get_future_stream() const
     return m_empty;
 }
 #endif
-//! \internal_end
 
-class WordEnginePrivate
+#if defined(HAVE_NGRAM) || defined(HAVE_PRESAGE)
+//! Predicts words with a memory mapped n-gram model (see NgramModel), or
+//! with Presage. Prediction pools are cached per preedit, see
+//! CachingPredictionBackend.
+class PredictionBackend
+    : public CachingPredictionBackend
 {
+private:
+#if defined(HAVE_NGRAM)
+    QFile m_ngram_file;
+    uchar *m_ngram_data;
+    QScopedPointer<NgramModelReader> m_ngram;
+    QVector<quint32> m_ngram_context; //!< ids of the prediction context words.
+#elif defined(HAVE_PRESAGE)
+    QString m_past_context; //!< the prediction context, as text.
+    std::string m_candidates_context;
+    CandidatesCallback m_presage_candidates;
+    Presage m_presage;
+    int m_presage_pool_size; //!< configured number of presage suggestions.
+#endif
+
 public:
-    SpellChecker spell_checker;
-#ifdef HAVE_PRESAGE
-    std::string candidates_context;
-    CandidatesCallback presage_candidates;
-    Presage presage;
+    explicit PredictionBackend();
+    virtual ~PredictionBackend();
+
+    virtual Verdict fetchCandidates(const Model::Text &text,
+                                    CandidateRanker *ranker);
+    virtual void fetchNextWordCandidates(const Model::Text &text,
+                                         CandidateRanker *ranker);
+
+private:
+    virtual void setPredictionContext(const QStringList &context);
+    virtual QStringList predict(const QString &preedit,
+                                int pool_size);
+};
 #endif
 
-    explicit WordEnginePrivate();
+//! Checks spelling against the Hunspell dictionaries of the last few active
+//! layouts, so that users can mix languages. A dictionary is loaded by the
+//! first request after its layout became active, and the least recently
+//! active one is unloaded once there are more than MaxDictionaries. The
+//! dictionaries are queried in parallel, so checking several of them takes
+//! as long as checking the slowest one. Once the key area is known, the
+//! corrections are re-ranked by key proximity, see ProximityCorrector.
+class SpellingBackend
+    : public WordEngineBackend
+{
+private:
+    QMutex m_mutex; //!< guards the dictionaries.
+    QList<Dictionary> m_dictionaries; //!< most recently active first.
+    QThreadPool m_dictionary_pool; //!< declared after dictionaries, so that jobs finish first.
+    mutable QMutex m_language_mutex; //!< guards m_active_dictionary and m_user_words.
+    QString m_active_dictionary; //!< dictionary of the active layout, loaded by the next request.
+    QStringList m_user_words; //!< user words of the most recently active dictionary.
+    QMutex m_corrector_mutex; //!< guards m_corrector and m_has_key_area.
+    ProximityCorrector m_corrector;
+    bool m_has_key_area;
+
+public:
+    explicit SpellingBackend();
+
+    virtual Verdict fetchCandidates(const Model::Text &text,
+                                    CandidateRanker *ranker);
+    virtual void addToUserDictionary(const QString &word);
+    virtual void setActiveLanguage(const QString &language);
+    virtual void setKeyArea(const KeyArea &key_area);
+
+    QStringList userWords() const;
+
+private:
+    void activateDictionary();
+};
+
+//! Completes the preedit with words of the user dictionary.
+class UserWordsBackend
+    : public WordEngineBackend
+{
+private:
+    const SpellingBackend *const m_spelling;
+
+public:
+    explicit UserWordsBackend(const SpellingBackend *spelling);
+
+    virtual Verdict fetchCandidates(const Model::Text &text,
+                                    CandidateRanker *ranker);
+};
+
+//! Completes addresses in URL and email fields, with the addresses and host
+//! names the user committed in such fields before.
+class AddressBackend
+    : public WordEngineBackend
+{
+private:
+    AddressIndex m_index;
+
+public:
+    explicit AddressBackend();
+
+    virtual bool supportsContentType(Model::Text::ContentType content_type) const;
+    virtual Verdict fetchCandidates(const Model::Text &text,
+                                    CandidateRanker *ranker);
+    virtual void learnWord(const Model::Text &text);
 };
+//! \internal_end
 
-WordEnginePrivate::WordEnginePrivate()
-    : spell_checker()
-#ifdef HAVE_PRESAGE
-    , candidates_context()
-    , presage_candidates(CandidatesCallback(candidates_context))
-    , presage(&presage_candidates)
+
+#if defined(HAVE_NGRAM) || defined(HAVE_PRESAGE)
+PredictionBackend::PredictionBackend()
+#if defined(HAVE_NGRAM)
+    // Lookups in the memory mapped model take microseconds:
+    : CachingPredictionBackend(Cheap)
+    , m_ngram_file(CoreUtils::maliitKeyboardDataDirectory() + "/dictionaries/words" + NgramModel::fileSuffix())
+    , m_ngram_data(0)
+    , m_ngram()
+    , m_ngram_context()
+#elif defined(HAVE_PRESAGE)
+    : CachingPredictionBackend(Expensive)
+    , m_past_context()
+    , m_candidates_context()
+    , m_presage_candidates(CandidatesCallback(m_candidates_context))
+    , m_presage(&m_presage_candidates)
+    , m_presage_pool_size(0)
 #endif
 {
-    // FIXME: Check whether spellchecker is enabled, and update enabled flag!
-#ifdef HAVE_PRESAGE
-    presage.config("Presage.Selector.SUGGESTIONS", "6");
-    presage.config("Presage.Selector.REPEAT_SUGGESTIONS", "yes");
+#if defined(HAVE_NGRAM)
+    if (m_ngram_file.open(QIODevice::ReadOnly)) {
+        m_ngram_data = m_ngram_file.map(0, m_ngram_file.size());
+    }
+
+    if (m_ngram_data) {
+        m_ngram.reset(new NgramModelReader(m_ngram_data, m_ngram_file.size()));
+
+        if (not m_ngram->isValid()) {
+            qWarning() << __PRETTY_FUNCTION__ << "Invalid language model:" << m_ngram_file.fileName()
+                       << "error:" << m_ngram->errorString();
+            m_ngram.reset();
+        }
+    } else {
+        qWarning() << __PRETTY_FUNCTION__ << "Could not load language model:" << m_ngram_file.fileName();
+    }
+
+#elif defined(HAVE_PRESAGE)
+    m_presage.config("Presage.Selector.REPEAT_SUGGESTIONS", "yes");
 #endif
 }
 
+PredictionBackend::~PredictionBackend()
+{
+#if defined(HAVE_NGRAM)
+    m_ngram.reset();
 
-//! \brief Constructor.
-//! \param parent The owner of this instance. Can be 0, in case QObject
-//!               ownership is not required.
-WordEngine::WordEngine(QObject *parent)
-    : AbstractWordEngine(parent)
-    , d_ptr(new WordEnginePrivate)
-{}
+    if (m_ngram_data) {
+        m_ngram_file.unmap(m_ngram_data);
+    }
+#endif
+}
 
-//! \brief Destructor.
-WordEngine::~WordEngine()
-{}
+WordEngineBackend::Verdict PredictionBackend::fetchCandidates(const Model::Text &text,
+                                                              CandidateRanker *ranker)
+{
+    const QString &preedit(text.preedit());
 
+#if not defined(HAVE_NGRAM)
+    // Presage predicts words without any context, too, which are not worth
+    // showing in an empty field:
+    if (preedit.isEmpty() and text.surroundingLeft().isEmpty()) {
+        return NoVerdict;
+    }
+#endif
 
-void WordEngine::setEnabled(bool enabled)
+    const bool is_preedit_capitalized(not preedit.isEmpty() && preedit.at(0).isUpper());
+    const QStringList &pool(predictions(text.context(), preedit, ranker->limit()));
+
+    // TODO: Fine-tune prediction to also perform error correction, not just word prediction.
+    for (int rank = 0; rank < pool.count(); ++rank) {
+        ranker->add(WordCandidate::SourcePrediction, CoreUtils::capitalized(pool.at(rank), is_preedit_capitalized),
+                    PredictionCost + rank * RankCost);
+    }
+
+    return NoVerdict;
+}
+
+void PredictionBackend::fetchNextWordCandidates(const Model::Text &text,
+                                                CandidateRanker *ranker)
 {
- // Don't allow to enable word engine if no backends are available:
-#if defined(HAVE_PRESAGE) || defined(HAVE_HUNSPELL)
-#else
-    if (enabled) {
-        qWarning() << __PRETTY_FUNCTION__
-                   << "No backend available, cannot enable word engine!";
+#if not defined(HAVE_NGRAM)
+    // See fetchCandidates():
+    if (text.surroundingLeft().isEmpty()) {
+        return;
     }
+#endif
 
-    enabled = false;
+    const QStringList &pool(predictions(text.context(), QString(), ranker->limit()));
+
+    for (int rank = 0; rank < pool.count(); ++rank) {
+        ranker->add(WordCandidate::SourcePrediction, pool.at(rank), PredictionCost + rank * RankCost);
+    }
+}
+
+void PredictionBackend::setPredictionContext(const QStringList &context)
+{
+#if defined(HAVE_NGRAM)
+    if (m_ngram) {
+        m_ngram_context = m_ngram->context(context);
+    }
+#elif defined(HAVE_PRESAGE)
+    m_past_context.clear();
+
+    Q_FOREACH (const QString &word, context) {
+        m_past_context.append(word.isEmpty() ? QString(". ") : word + " ");
+    }
 #endif
-    AbstractWordEngine::setEnabled(enabled);
 }
 
+QStringList PredictionBackend::predict(const QString &preedit,
+                                       int pool_size)
+{
+    QStringList predictions;
+
+#if defined(HAVE_NGRAM)
+    if (m_ngram) {
+        predictions = m_ngram->predict(m_ngram_context, preedit, pool_size);
+    }
+#elif defined(HAVE_PRESAGE)
+    if (m_presage_pool_size != pool_size) {
+        m_presage.config("Presage.Selector.SUGGESTIONS", QByteArray::number(pool_size).constData());
+        m_presage_pool_size = pool_size;
+    }
+
+    m_candidates_context = (m_past_context + preedit).toStdString();
+    const std::vector<std::string> presage_predictions = m_presage.predict();
+
+    for (unsigned int index = 0; index < presage_predictions.size(); ++index) {
+        predictions.append(QString::fromStdString(presage_predictions.at(index)));
+    }
+#endif
+
+    return predictions;
+}
+#endif
+
 
-WordCandidateList WordEngine::fetchCandidates(Model::Text *text)
+SpellingBackend::SpellingBackend()
+    : WordEngineBackend(Expensive)
+    , m_mutex()
+    , m_dictionaries()
+    , m_dictionary_pool()
+    , m_language_mutex()
+    , m_active_dictionary(SpellChecker::dictPath() + "/en_GB")
+    , m_user_words()
+    , m_corrector_mutex()
+    , m_corrector()
+    , m_has_key_area(false)
 {
-    WordCandidateList candidates;
- 
-#ifdef DISABLE_PREEDIT
-    Q_UNUSED(text)
-    return candidates;
-#else
-    Q_D(WordEngine);
+    // FIXME: Check whether spellchecker is enabled, and update enabled flag!
+    m_dictionary_pool.setMaxThreadCount(MaxDictionaries);
+}
+
+//! Checks the preedit with all loaded dictionaries, in parallel. If no
+//! dictionary knows it, the corrections closest to the preedit on the key
+//! area come first. Ties keep the order of Hunspell, and those of the most
+//! recently active dictionary go first among them.
+WordEngineBackend::Verdict SpellingBackend::fetchCandidates(const Model::Text &text,
+                                                            CandidateRanker *ranker)
+{
+    QMutexLocker locker(&m_mutex);
+    activateDictionary();
+
+    const QString &preedit(text.preedit());
+    QVector<SpellingResult> results(m_dictionaries.count());
+    QSemaphore finished;
+
+    for (int index = 0; index < m_dictionaries.count(); ++index) {
+        m_dictionary_pool.start(new SpellingJob(m_dictionaries.at(index).spell_checker.data(), preedit,
+                                                ranker->limit(), &results[index], &finished));
+    }
+
+    // Each job waits for its corrections at most until the deadline:
+    finished.acquire(m_dictionaries.count());
+
+    // Without dictionaries, every word is spelled correctly:
+    Q_FOREACH (const SpellingResult &result, results) {
+        if (result.correct) {
+            return KnownWord;
+        }
+    }
+
+    if (results.isEmpty()) {
+        return KnownWord;
+    }
 
-    const QString &preedit(text->preedit());
     const bool is_preedit_capitalized(not preedit.isEmpty() && preedit.at(0).isUpper());
+    bool has_key_area;
+    ProximityCorrector corrector;
+
+    {
+        // Copying is cheap, the cost tables are implicitly shared:
+        QMutexLocker corrector_locker(&m_corrector_mutex);
+        has_key_area = m_has_key_area;
+        corrector = m_corrector;
+    }
+
+    // Hunspell only ranks its own corrections, so merge them by rank, after
+    // their proximity to the preedit:
+    for (int index = 0; index < results.count(); ++index) {
+        const QStringList &corrections(results.at(index).corrections);
+        const QVector<int> &distances(has_key_area ? corrector.distances(preedit, corrections)
+                                                   : QVector<int>(corrections.count(), 0));
 
-#ifdef HAVE_PRESAGE
-    const QString &context = (text->surroundingLeft() + preedit);
-    d->candidates_context = context.toStdString();
-    const std::vector<std::string> predictions = d->presage.predict();
-
-    // TODO: Fine-tune presage behaviour to also perform error correction, not just word prediction.
-    if (not context.isEmpty()) {
-        // FIXME: max_candidates should come from style, too:
-        const static unsigned int max_candidates = 7;
-        const int count(qMin<int>(predictions.size(), max_candidates));
-        for (int index = 0; index < count; ++index) {
-            appendToCandidates(&candidates, WordCandidate::SourcePrediction, QString::fromStdString(predictions.at(index)),
-                               is_preedit_capitalized);
+        for (int rank = 0; rank < corrections.count(); ++rank) {
+            ranker->add(WordCandidate::SourceSpellChecking, CoreUtils::capitalized(corrections.at(rank), is_preedit_capitalized),
+                        CorrectionCost + (distances.at(rank) * ranker->limit() + rank) * MaxDictionaries + index);
         }
     }
-#endif
 
-    const bool correct_spelling(d->spell_checker.spell(preedit));
+    return UnknownWord;
+}
+
+void SpellingBackend::addToUserDictionary(const QString &word)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // Words known to any dictionary count as correct, so adding to the most
+    // recently active one is enough:
+    activateDictionary();
+
+    if (not m_dictionaries.isEmpty()) {
+        m_dictionaries.first().spell_checker->addToUserWordlist(word);
+
+        QMutexLocker language_locker(&m_language_mutex);
+        m_user_words = m_dictionaries.first().spell_checker->userWords();
+    }
+}
+
+//! Makes the Hunspell dictionary for language the active one. It is loaded
+//! by the next candidate request, off the GUI thread in asynchronous mode.
+//! Languages without dictionary keep the previous one active.
+void SpellingBackend::setActiveLanguage(const QString &language)
+{
+    const QString &path(SpellChecker::findDictionary(language));
+
+    if (not path.isEmpty()) {
+        QMutexLocker locker(&m_language_mutex);
+        m_active_dictionary = path;
+    }
+}
+
+//! Rebuilds the key proximity costs corrections get ranked by.
+void SpellingBackend::setKeyArea(const KeyArea &key_area)
+{
+    QMutexLocker locker(&m_corrector_mutex);
+    m_corrector.setKeyArea(key_area);
+    m_has_key_area = not key_area.keys().isEmpty();
+}
+
+//! @returns the user words of the most recently active dictionary, without
+//!          waiting for running spelling checks.
+QStringList SpellingBackend::userWords() const
+{
+    QMutexLocker locker(&m_language_mutex);
+    return m_user_words;
+}
+
+//! Loads the dictionary of the active layout, if needed, and makes it the
+//! most recently active one.
+void SpellingBackend::activateDictionary()
+{
+    QString path;
+
+    {
+        QMutexLocker locker(&m_language_mutex);
+        path = m_active_dictionary;
+    }
+
+    if (path.isEmpty() or (not m_dictionaries.isEmpty() and m_dictionaries.first().path == path)) {
+        return;
+    }
+
+    Dictionary dictionary;
+
+    for (int index = 0; index < m_dictionaries.count(); ++index) {
+        if (m_dictionaries.at(index).path == path) {
+            dictionary = m_dictionaries.takeAt(index);
+            break;
+        }
+    }
+
+    if (not dictionary.spell_checker) {
+        dictionary.path = path;
+        dictionary.spell_checker = QSharedPointer<SpellChecker>(new SpellChecker(path));
+    }
+
+    m_dictionaries.prepend(dictionary);
+
+    while (m_dictionaries.count() > MaxDictionaries) {
+        m_dictionaries.removeLast();
+    }
+
+    const QStringList &user_words(dictionary.spell_checker->userWords());
+    QMutexLocker locker(&m_language_mutex);
+    m_user_words = user_words;
+}
+
 
-    if (candidates.isEmpty() and not correct_spelling) {
-        Q_FOREACH(const QString &correction, d->spell_checker.suggest(preedit, 5)) {
-            appendToCandidates(&candidates, WordCandidate::SourceSpellChecking, correction, is_preedit_capitalized);
+UserWordsBackend::UserWordsBackend(const SpellingBackend *spelling)
+    : WordEngineBackend(Cheap)
+    , m_spelling(spelling)
+{}
+
+WordEngineBackend::Verdict UserWordsBackend::fetchCandidates(const Model::Text &text,
+                                                             CandidateRanker *ranker)
+{
+    const QString &preedit(text.preedit());
+    const bool is_preedit_capitalized(not preedit.isEmpty() && preedit.at(0).isUpper());
+    int rank(0);
+
+    Q_FOREACH (const QString &user_word, m_spelling->userWords()) {
+        if (rank >= ranker->limit()) {
+            break;
+        }
+
+        if (user_word.startsWith(preedit, Qt::CaseInsensitive)) {
+            ranker->add(WordCandidate::SourcePrediction, CoreUtils::capitalized(user_word, is_preedit_capitalized),
+                        UserWordCost + rank * RankCost);
+            ++rank;
+        }
+    }
+
+    return NoVerdict;
+}
+
+
+
+AddressBackend::AddressBackend()
+    // Completions are binary searches in a memory mapped index:
+    : WordEngineBackend(Cheap)
+    , m_index(QString("%1/.config/maliit/addresses.idx").arg(QDir::homePath()))
+{}
+
+bool AddressBackend::supportsContentType(Model::Text::ContentType content_type) const
+{
+    return (content_type == Model::Text::UrlContent or content_type == Model::Text::EmailContent);
+}
+
+WordEngineBackend::Verdict AddressBackend::fetchCandidates(const Model::Text &text,
+                                                           CandidateRanker *ranker)
+{
+    const QString &preedit(text.preedit());
+    const bool is_email(text.contentType() == Model::Text::EmailContent);
+    const QStringList &addresses(m_index.complete(preedit,
+                                                  is_email ? AddressIndex::EmailAddress
+                                                           : AddressIndex::WebAddress | AddressIndex::HostName,
+                                                  ranker->limit()));
+
+    for (int rank = 0; rank < addresses.count(); ++rank) {
+        ranker->add(WordCandidate::SourcePrediction, addresses.at(rank), AddressCost + rank * RankCost);
+    }
+
+    const int at(preedit.lastIndexOf('@'));
+
+    // Email addresses to new recipients still have known domains:
+    if (is_email and at > 0) {
+        const QString &local_part(preedit.left(at + 1));
+        const QStringList &domains(m_index.complete(preedit.mid(at + 1), AddressIndex::HostName,
+                                                    ranker->limit()));
+
+        for (int rank = 0; rank < domains.count(); ++rank) {
+            ranker->add(WordCandidate::SourcePrediction, local_part + domains.at(rank),
+                        DomainCost + rank * RankCost);
         }
     }
 
-    text->setPreeditFace(candidates.isEmpty() ? (correct_spelling ? Model::Text::PreeditDefault
-                                                                  : Model::Text::PreeditNoCandidates)
-                                              : Model::Text::PreeditActive);
+    // Addresses are not misspelled, just unknown:
+    return NoVerdict;
+}
 
-    text->setPrimaryCandidate(candidates.isEmpty() ? QString()
-                                                   : candidates.first().label().text());
+void AddressBackend::learnWord(const Model::Text &text)
+{
+    m_index.learn(text.preedit());
+}
 
+} // namespace
 
-    return candidates;
+//! \class WordEngine
+//! \brief Provides error correction (based on Hunspell) and word
+//! prediction (based on a memory mapped n-gram model, see NgramModel, or
+//! on Presage).
+//!
+//! Each of them is a backend, see WordEngineBackend: word prediction,
+//! spelling correction and completion from the user dictionary. Spelling
+//! corrections only fill places that predictions and user words leave.
+//! URL and email fields get none of these, but completions from the
+//! addresses the user committed in such fields, see AddressIndex.
+
+//! \brief Constructor.
+//! \param parent The owner of this instance. Can be 0, in case QObject
+//!               ownership is not required.
+WordEngine::WordEngine(QObject *parent)
+    : AbstractWordEngine(parent)
+{
+#ifndef DISABLE_PREEDIT
+#if defined(HAVE_NGRAM) || defined(HAVE_PRESAGE)
+    addBackend(new PredictionBackend);
+#endif
+
+    SpellingBackend *const spelling(new SpellingBackend);
+    addBackend(spelling);
+    addBackend(new UserWordsBackend(spelling));
+    addBackend(new AddressBackend);
 #endif
 }
 
-void WordEngine::addToUserDictionary(const QString &word)
+//! \brief Destructor.
+WordEngine::~WordEngine()
 {
-    Q_D(WordEngine);
+    waitForCandidates();
+}
 
-    d->spell_checker.addToUserWordlist(word);
+
+void WordEngine::setEnabled(bool enabled)
+{
+ // Don't allow to enable word engine if no backends are available:
+#if defined(HAVE_NGRAM) || defined(HAVE_PRESAGE) || defined(HAVE_HUNSPELL)
+#else
+    if (enabled) {
+        qWarning() << __PRETTY_FUNCTION__
+                   << "No backend available, cannot enable word engine!";
+    }
+
+    enabled = false;
+#endif
+    AbstractWordEngine::setEnabled(enabled);
 }
 
 }} // namespace Logic, MaliitKeyboard
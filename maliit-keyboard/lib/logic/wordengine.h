@@ -41,14 +41,11 @@
 namespace MaliitKeyboard {
 namespace Logic {
 
-class WordEnginePrivate;
-
 class WordEngine
     : public AbstractWordEngine
 {
     Q_OBJECT
     Q_DISABLE_COPY(WordEngine)
-    Q_DECLARE_PRIVATE(WordEngine)
 
 public:
     explicit WordEngine(QObject *parent = 0);
@@ -56,16 +53,7 @@ public:
 
     //! \reimp
     virtual void setEnabled(bool enabled);
-
-    virtual void addToUserDictionary(const QString &word);
-    //! \reimp_end
-
-private:
-    //! \reimp
-    virtual WordCandidateList fetchCandidates(Model::Text *text);
     //! \reimp_end
-
-    const QScopedPointer<WordEnginePrivate> d_ptr;
 };
 
 }} // namespace Logic, MaliitKeyboard
@@ -0,0 +1,144 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "wordenginebackend.h"
+
+namespace MaliitKeyboard {
+namespace Logic {
+
+//! \class WordEngineBackend
+//! \brief One source of word candidates, for instance a predictor or a
+//! spellchecker, that a word engine runs next to other backends.
+//!
+//! Backends are registered with AbstractWordEngine::addBackend(). For each
+//! request, all backends run in parallel on a thread pool and add scored
+//! candidates to a shared CandidateRanker. Results of the cheap backends are
+//! shown first, the expensive ones refine them once they finish.
+//!
+//! Costs of all backends share one scale, so backends of one word engine
+//! need to agree on it. Methods can be called from several threads at once,
+//! for successive requests, so backends need to guard their state.
+
+//! \fn WordEngineBackend::Verdict WordEngineBackend::fetchCandidates(const Model::Text &text, CandidateRanker *ranker)
+//! \brief Adds candidates for the preedit of the text model.
+//! \param text The text model, with a non-empty preedit.
+//! \param ranker Receives the candidates.
+//! @returns whether the preedit is a word, as far as the backend knows.
+//!          Without candidates, unknown words get the
+//!          Model::Text::PreeditNoCandidates face.
+
+
+//! \param cost_class How long the backend takes to answer.
+WordEngineBackend::WordEngineBackend(CostClass cost_class)
+    : m_cost_class(cost_class)
+{}
+
+
+WordEngineBackend::~WordEngineBackend()
+{}
+
+
+//! @returns how long the backend takes to answer.
+WordEngineBackend::CostClass WordEngineBackend::costClass() const
+{
+    return m_cost_class;
+}
+
+
+//! \brief Returns whether the backend serves fields of a content type.
+//! \param content_type The content type of the edited field.
+//!
+//! Can be reimplemented in derived classes. This serves natural language,
+//! that is, all fields but URL and email fields.
+bool WordEngineBackend::supportsContentType(Model::Text::ContentType content_type) const
+{
+    return (content_type != Model::Text::UrlContent and content_type != Model::Text::EmailContent);
+}
+
+
+//! \brief Adds predictions for the word following the text.
+//! \param text The text model, without preedit.
+//! \param ranker Receives the predictions.
+//!
+//! Can be reimplemented in derived classes. This predicts nothing.
+void WordEngineBackend::fetchNextWordCandidates(const Model::Text &text,
+                                                CandidateRanker *ranker)
+{
+    Q_UNUSED(text);
+    Q_UNUSED(ranker);
+}
+
+
+//! \brief Learns from a word the user committed.
+//! \param text The text model, with the committed word as preedit.
+//!
+//! Can be reimplemented in derived classes. This does nothing. Called on the
+//! thread of the word engine, only if the backend supports the content type
+//! of the text.
+void WordEngineBackend::learnWord(const Model::Text &text)
+{
+    Q_UNUSED(text);
+}
+
+
+//! \brief Adds a word to the user dictionary.
+//! \param word The word.
+//!
+//! Can be reimplemented in derived classes. This does nothing.
+void WordEngineBackend::addToUserDictionary(const QString &word)
+{
+    Q_UNUSED(word);
+}
+
+
+//! \brief Tells the backend the language of the active layout.
+//! \param language The language, as declared by the layout.
+//!
+//! Can be reimplemented in derived classes. This does nothing. Called on the
+//! thread of the word engine.
+void WordEngineBackend::setActiveLanguage(const QString &language)
+{
+    Q_UNUSED(language);
+}
+
+
+//! \brief Tells the backend which key area the user types on.
+//! \param key_area The current key area.
+//!
+//! Can be reimplemented in derived classes. This does nothing. Called on the
+//! thread of the word engine.
+void WordEngineBackend::setKeyArea(const KeyArea &key_area)
+{
+    Q_UNUSED(key_area);
+}
+
+}} // namespace Logic, MaliitKeyboard
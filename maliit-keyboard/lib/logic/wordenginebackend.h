@@ -0,0 +1,85 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_WORDENGINEBACKEND_H
+#define MALIIT_KEYBOARD_WORDENGINEBACKEND_H
+
+#include "models/text.h"
+
+#include <QtCore>
+
+namespace MaliitKeyboard {
+
+class KeyArea;
+
+namespace Logic {
+
+class CandidateRanker;
+
+class WordEngineBackend
+{
+    Q_DISABLE_COPY(WordEngineBackend)
+
+public:
+    enum CostClass {
+        Cheap, //!< Answers within a few milliseconds, e.g. lookups in memory mapped files.
+        Expensive //!< Might take longer, e.g. spelling corrections.
+    };
+
+    enum Verdict {
+        NoVerdict, //!< The backend does not know whether the preedit is a word.
+        KnownWord, //!< The preedit is a word.
+        UnknownWord //!< The preedit is misspelled.
+    };
+
+    explicit WordEngineBackend(CostClass cost_class);
+    virtual ~WordEngineBackend();
+
+    CostClass costClass() const;
+    virtual bool supportsContentType(Model::Text::ContentType content_type) const;
+
+    virtual Verdict fetchCandidates(const Model::Text &text,
+                                    CandidateRanker *ranker) = 0;
+    virtual void fetchNextWordCandidates(const Model::Text &text,
+                                         CandidateRanker *ranker);
+    virtual void learnWord(const Model::Text &text);
+    virtual void addToUserDictionary(const QString &word);
+    virtual void setActiveLanguage(const QString &language);
+    virtual void setKeyArea(const KeyArea &key_area);
+
+private:
+    const CostClass m_cost_class;
+};
+
+}} // namespace Logic, MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_WORDENGINEBACKEND_H
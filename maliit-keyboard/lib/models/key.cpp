@@ -171,4 +171,14 @@ bool operator!=(const Key &lhs,
     return (not (lhs == rhs));
 }
 
+//! \brief Hash function, consistent with operator==.
+uint qHash(const Key &key)
+{
+    const QRect &rect(key.rect());
+
+    return (qHash(key.label().text())
+            ^ (uint(rect.x()) << 16) ^ uint(rect.y())
+            ^ (uint(rect.width()) << 8) ^ (uint(rect.height()) << 24));
+}
+
 } // namespace MaliitKeyboard
@@ -138,6 +138,8 @@ bool operator==(const Key &lhs,
 bool operator!=(const Key &lhs,
                 const Key &rhs);
 
+uint qHash(const Key &key);
+
 } // namespace MaliitKeyboard
 
 Q_DECLARE_METATYPE(MaliitKeyboard::Key)
@@ -194,10 +194,54 @@ QVariant lookup(const QScopedPointer<const QSettings> &store,
 StyleAttributes::StyleAttributes(const QSettings *store)
     : m_store(store)
     , m_style_name()
+    , m_resolved_styles()
+    , m_active(0)
 {
     if (m_store.isNull()) {
         qFatal("QSettings store cannot be null!");
     }
+
+    resolve();
+}
+
+//! \brief Copies already resolved attributes.
+//!
+//! The copy has no settings store, as all attributes were resolved when
+//! \a other got created. Copies are independent of each other, so each
+//! thread creating key areas can select styles on its own copy.
+//! @param other The attributes to copy.
+StyleAttributes::StyleAttributes(const StyleAttributes &other)
+    : m_store()
+    , m_style_name()
+    , m_resolved_styles(other.m_resolved_styles)
+    , m_active(0)
+    , m_word_ribbon_background(other.m_word_ribbon_background)
+    , m_key_area_background(other.m_key_area_background)
+    , m_magnifier_key_background(other.m_magnifier_key_background)
+    , m_word_ribbon_background_borders(other.m_word_ribbon_background_borders)
+    , m_key_area_background_borders(other.m_key_area_background_borders)
+    , m_magnifier_key_background_borders(other.m_magnifier_key_background_borders)
+    , m_key_background_borders(other.m_key_background_borders)
+    , m_custom_icons(other.m_custom_icons)
+    , m_font_files(other.m_font_files)
+    , m_key_press_sound(other.m_key_press_sound)
+    , m_key_release_sound(other.m_key_release_sound)
+    , m_layout_change_sound(other.m_layout_change_sound)
+    , m_keyboard_hide_sound(other.m_keyboard_hide_sound)
+{
+    for (int style = Key::StyleNormalKey; style <= Key::StyleActivated; ++style) {
+        for (int state = KeyDescription::NormalState; state <= KeyDescription::HighlightedState; ++state) {
+            m_key_backgrounds[style][state] = other.m_key_backgrounds[style][state];
+        }
+    }
+
+    for (int icon = KeyDescription::NoIcon; icon <= KeyDescription::CustomIcon; ++icon) {
+        for (int state = KeyDescription::NormalState; state <= KeyDescription::HighlightedState; ++state) {
+            m_icons[icon][state] = other.m_icons[icon][state];
+        }
+    }
+
+    setStyleName(other.m_style_name);
 }
 
 //! \brief Destructor
@@ -216,17 +260,166 @@ StyleAttributes::~StyleAttributes()
 //!
 //! \param name The style name. Works similar to HTML/CSS class and maps it to
 //!             a section within the INI file. There is no check whether such
-//!             a section exists!
+//!             a section exists! Unknown names use the 'default' section.
 void StyleAttributes::setStyleName(const QString &name)
 {
     m_style_name = name;
+
+    QHash<QString, ResolvedStyle>::const_iterator it(m_resolved_styles.constFind(name));
+    if (it == m_resolved_styles.constEnd()) {
+        it = m_resolved_styles.constFind(QString::fromLatin1("default"));
+    }
+
+    m_active = &it.value();
+}
+
+//! \brief Returns the active style name.
+QString StyleAttributes::styleName() const
+{
+    return m_style_name;
+}
+
+
+//! \brief Reads all attributes from the settings store.
+//!
+//! Every style section is resolved once, for both orientations, with the
+//! fallback to the 'default' section already applied. Getters then only
+//! read the resolved values, instead of querying QSettings on each call.
+void StyleAttributes::resolve()
+{
+    m_word_ribbon_background = m_store->value("background/word-ribbon").toByteArray();
+    m_key_area_background = m_store->value("background/key-area").toByteArray();
+    m_magnifier_key_background = m_store->value("background/magnifier-key").toByteArray();
+
+    for (int style = Key::StyleNormalKey; style <= Key::StyleActivated; ++style) {
+        for (int state = KeyDescription::NormalState; state <= KeyDescription::HighlightedState; ++state) {
+            QByteArray key("background/");
+            key.append(fromKeyStyle(static_cast<Key::Style>(style)));
+            key.append(fromKeyState(static_cast<KeyDescription::State>(state)));
+
+            m_key_backgrounds[style][state] = m_store->value(key).toByteArray();
+        }
+    }
+
+    m_word_ribbon_background_borders = fromByteArray(m_store->value("background/word-ribbon-borders").toByteArray());
+    m_key_area_background_borders = fromByteArray(m_store->value("background/key-area-borders").toByteArray());
+    m_magnifier_key_background_borders = fromByteArray(m_store->value("background/magnifier-key-borders").toByteArray());
+    m_key_background_borders = fromByteArray(m_store->value("background/key-borders").toByteArray());
+
+    for (int icon = KeyDescription::NoIcon; icon <= KeyDescription::CustomIcon; ++icon) {
+        for (int state = KeyDescription::NormalState; state <= KeyDescription::HighlightedState; ++state) {
+            QByteArray key("icon/");
+            key.append(fromKeyIcon(static_cast<KeyDescription::Icon>(icon)));
+            key.append(fromKeyState(static_cast<KeyDescription::State>(state)));
+
+            m_icons[icon][state] = m_store->value(key).toByteArray();
+        }
+    }
+
+    m_font_files = m_store->value("font/font-files").toStringList();
+
+    m_key_press_sound = m_store->value("sound/key-press").toByteArray();
+    m_key_release_sound = m_store->value("sound/key-release").toByteArray();
+    m_layout_change_sound = m_store->value("sound/layout-change").toByteArray();
+    m_keyboard_hide_sound = m_store->value("sound/keyboard-hide").toByteArray();
+
+    // Style sections are those holding orientation-dependent attributes, as
+    // in "${style}/${orientation}/${attribute}". The 'default' section is
+    // always resolved, as unknown style names fall back to it.
+    const QString icon_prefix(QString::fromLatin1("icon/"));
+    QSet<QString> sections;
+    sections.insert(QString::fromLatin1("default"));
+
+    Q_FOREACH (const QString &key, m_store->allKeys()) {
+        if (key.startsWith(icon_prefix)) {
+            m_custom_icons.insert(key.mid(icon_prefix.length()), m_store->value(key).toByteArray());
+            continue;
+        }
+
+        const QStringList &tokens(key.split('/'));
+        if (tokens.count() == 3
+            && (tokens.at(1) == QLatin1String("landscape")
+                || tokens.at(1) == QLatin1String("portrait"))) {
+            sections.insert(tokens.at(0));
+        }
+    }
+
+    Q_FOREACH (const QString &section, sections) {
+        const QByteArray style_name(section.toLocal8Bit());
+        ResolvedStyle resolved_style;
+        resolved_style.orientations[Logic::LayoutHelper::Landscape]
+            = resolveOrientation(Logic::LayoutHelper::Landscape, style_name);
+        resolved_style.orientations[Logic::LayoutHelper::Portrait]
+            = resolveOrientation(Logic::LayoutHelper::Portrait, style_name);
+
+        m_resolved_styles.insert(section, resolved_style);
+    }
+
+    setStyleName(m_style_name);
+}
+
+
+//! \brief Reads the orientation-dependent attributes of a style section.
+//! @param orientation The layout orientation (landscape or portrait).
+//! @param style_name The style name, maps to INI file sections.
+//! @returns The attributes, falling back to the 'default' section for
+//!          missing values.
+StyleAttributes::ResolvedOrientation
+StyleAttributes::resolveOrientation(Logic::LayoutHelper::Orientation orientation,
+                                    const QByteArray &style_name) const
+{
+    ResolvedOrientation result;
+
+    result.font_name = lookup(m_store, orientation, style_name, "font-name").toByteArray();
+    if (result.font_name.isEmpty()) {
+        result.font_name = "Nokia Pure";
+    }
+
+    result.font_color = lookup(m_store, orientation, style_name, "font-color").toByteArray();
+    result.font_size = lookup(m_store, orientation, style_name, "font-size").toReal();
+    result.small_font_size = lookup(m_store, orientation, style_name, "small-font-size").toReal();
+    result.candidate_font_size = lookup(m_store, orientation, style_name, "candidate-font-size").toReal();
+    result.magnifier_font_size = lookup(m_store, orientation, style_name, "magnifier-font-size").toReal();
+    result.candidate_font_stretch = lookup(m_store, orientation, style_name, "candidate-font-stretch").toReal();
+    result.word_ribbon_height = lookup(m_store, orientation, style_name, "word-ribbon-height").toReal();
+    result.max_candidates = lookup(m_store, orientation, style_name, "max-candidates").toInt();
+    result.magnifier_key_height = lookup(m_store, orientation, style_name, "magnifier-key-height").toReal();
+    result.key_height = lookup(m_store, orientation, style_name, "key-height").toReal();
+    result.key_top_row_height = lookup(m_store, orientation, style_name, "key-top-row-height").toReal();
+    result.key_bottom_row_height = lookup(m_store, orientation, style_name, "key-bottom-row-height").toReal();
+    result.magnifier_key_width = lookup(m_store, orientation, style_name, "magnifier-key-width").toReal();
+
+    for (int width = KeyDescription::XXSmall; width <= KeyDescription::Stretched; ++width) {
+        const QByteArray attribute_name(QByteArray("key-width")
+                                        .append(fromKeyWidth(static_cast<KeyDescription::Width>(width))));
+        result.key_widths[width] = lookup(m_store, orientation, style_name, attribute_name).toReal();
+    }
+
+    result.key_area_width = lookup(m_store, orientation, style_name, "key-area-width").toReal();
+    result.key_margin = lookup(m_store, orientation, style_name, "key-margins").toReal();
+    result.key_area_padding = lookup(m_store, orientation, style_name, "key-area-paddings").toReal();
+    result.vertical_offset = lookup(m_store, orientation, style_name, "vertical-offset").toReal();
+    result.magnifier_key_label_vertical_offset
+        = lookup(m_store, orientation, style_name, "magnifier-key-label-vertical-offset").toReal();
+    result.safety_margin = lookup(m_store, orientation, style_name, "safety-margin").toReal();
+
+    return result;
+}
+
+
+//! \brief Returns the resolved attributes of the active style.
+//! @param orientation The layout orientation (landscape or portrait).
+const StyleAttributes::ResolvedOrientation &
+StyleAttributes::resolved(Logic::LayoutHelper::Orientation orientation) const
+{
+    return m_active->orientations[orientation];
 }
 
 //! \brief Looks up the background image name for word ribbons.
 //! @returns Value of "background\word-ribbon".
 QByteArray StyleAttributes::wordRibbonBackground() const
 {
-    return m_store->value("background/word-ribbon").toByteArray();
+    return m_word_ribbon_background;
 }
 
 
@@ -234,7 +427,7 @@ QByteArray StyleAttributes::wordRibbonBackground() const
 //! @returns Value of "background\key-area".
 QByteArray StyleAttributes::keyAreaBackground() const
 {
-    return m_store->value("background/key-area").toByteArray();
+    return m_key_area_background;
 }
 
 
@@ -242,7 +435,7 @@ QByteArray StyleAttributes::keyAreaBackground() const
 //! @returns Value of "background\magnifier-key"
 QByteArray StyleAttributes::magnifierKeyBackground() const
 {
-    return m_store->value("background/magnifier-key").toByteArray();
+    return m_magnifier_key_background;
 }
 
 
@@ -254,11 +447,7 @@ QByteArray StyleAttributes::magnifierKeyBackground() const
 QByteArray StyleAttributes::keyBackground(Key::Style style,
                                           KeyDescription::State state) const
 {
-    QByteArray key("background/");
-    key.append(fromKeyStyle(style));
-    key.append(fromKeyState(state));
-
-    return m_store->value(key).toByteArray();
+    return m_key_backgrounds[style][state];
 }
 
 
@@ -266,7 +455,7 @@ QByteArray StyleAttributes::keyBackground(Key::Style style,
 //! @returns Value of "background\word-ribbon-borders".
 QMargins StyleAttributes::wordRibbonBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/word-ribbon-borders").toByteArray());
+    return m_word_ribbon_background_borders;
 }
 
 
@@ -274,7 +463,7 @@ QMargins StyleAttributes::wordRibbonBackgroundBorders() const
 //! @returns Value of "background\key-area-borders".
 QMargins StyleAttributes::keyAreaBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/key-area-borders").toByteArray());
+    return m_key_area_background_borders;
 }
 
 
@@ -282,7 +471,7 @@ QMargins StyleAttributes::keyAreaBackgroundBorders() const
 //! @returns Value of "background\magnifier-key-borders".
 QMargins StyleAttributes::magnifierKeyBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/magnifier-key-borders").toByteArray());
+    return m_magnifier_key_background_borders;
 }
 
 
@@ -290,7 +479,7 @@ QMargins StyleAttributes::magnifierKeyBackgroundBorders() const
 //! @returns Value of "background\key-borders".
 QMargins StyleAttributes::keyBackgroundBorders() const
 {
-    return fromByteArray(m_store->value("background/key-borders").toByteArray());
+    return m_key_background_borders;
 }
 
 
@@ -301,11 +490,7 @@ QMargins StyleAttributes::keyBackgroundBorders() const
 QByteArray StyleAttributes::icon(KeyDescription::Icon icon,
                                  KeyDescription::State state) const
 {
-    QByteArray key("icon/");
-    key.append(fromKeyIcon(icon));
-    key.append(fromKeyState(state));
-
-    return m_store->value(key).toByteArray();
+    return m_icons[icon][state];
 }
 
 
@@ -314,10 +499,7 @@ QByteArray StyleAttributes::icon(KeyDescription::Icon icon,
 //! \returns Value of "icon\${icon_name}".
 QByteArray StyleAttributes::customIcon(const QString &icon_name) const
 {
-    QByteArray key("icon/");
-    key.append(icon_name.toUtf8());
-
-    return m_store->value(key).toByteArray();
+    return m_custom_icons.value(icon_name);
 }
 
 
@@ -327,15 +509,7 @@ QByteArray StyleAttributes::customIcon(const QString &icon_name) const
 //! Pure" if there was no such value in style.ini.
 QByteArray StyleAttributes::fontName(Logic::LayoutHelper::Orientation orientation) const
 {
-    const QByteArray font_name(lookup(m_store, orientation,
-                                      m_style_name.toLocal8Bit(),
-                                      QByteArray("font-name")).toByteArray());
-
-    if (font_name.isEmpty()) {
-        return "Nokia Pure";
-    }
-
-    return font_name;
+    return resolved(orientation).font_name;
 }
 
 
@@ -344,7 +518,7 @@ QByteArray StyleAttributes::fontName(Logic::LayoutHelper::Orientation orientatio
 //! \returns Value of "font\font-files"
 QStringList StyleAttributes::fontFiles() const
 {
-    return m_store->value("font/font-files").toStringList();
+    return m_font_files;
 }
 
 
@@ -353,9 +527,7 @@ QStringList StyleAttributes::fontFiles() const
 //! @returns Value of "${style}\${orientation}\font-color".
 QByteArray StyleAttributes::fontColor(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("font-color")).toByteArray();
+    return resolved(orientation).font_color;
 }
 
 
@@ -364,9 +536,7 @@ QByteArray StyleAttributes::fontColor(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\font-size".
 qreal StyleAttributes::fontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("font-size")).toReal();
+    return resolved(orientation).font_size;
 }
 
 
@@ -375,9 +545,7 @@ qreal StyleAttributes::fontSize(Logic::LayoutHelper::Orientation orientation) co
 //! @returns Value of "${style}\${orientation}\small-font-size".
 qreal StyleAttributes::smallFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("small-font-size")).toReal();
+    return resolved(orientation).small_font_size;
 }
 
 
@@ -386,9 +554,7 @@ qreal StyleAttributes::smallFontSize(Logic::LayoutHelper::Orientation orientatio
 //! @returns Value of "${style}\${orientation}\candidates-font-size".
 qreal StyleAttributes::candidateFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("candidate-font-size")).toReal();
+    return resolved(orientation).candidate_font_size;
 }
 
 
@@ -397,9 +563,7 @@ qreal StyleAttributes::candidateFontSize(Logic::LayoutHelper::Orientation orient
 //! @returns Value of "${style}\${orientation}\magnifier-font-size".
 qreal StyleAttributes::magnifierFontSize(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-font-size")).toReal();
+    return resolved(orientation).magnifier_font_size;
 }
 
 
@@ -412,9 +576,7 @@ qreal StyleAttributes::magnifierFontSize(Logic::LayoutHelper::Orientation orient
 //! @returns Value of "${style}\${orientation}\candidate-font-stretch".
 qreal StyleAttributes::candidateFontStretch(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("candidate-font-stretch")).toReal();
+    return resolved(orientation).candidate_font_stretch;
 }
 
 
@@ -423,9 +585,17 @@ qreal StyleAttributes::candidateFontStretch(Logic::LayoutHelper::Orientation ori
 //! @returns Value of "${style}\${orientation}\word-ribbon-height".
 qreal StyleAttributes::wordRibbonHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("word-ribbon-height")).toReal();
+    return resolved(orientation).word_ribbon_height;
+}
+
+
+//! \brief Looks up how many word candidates fit into the word ribbon.
+//! @param orientation The layout orientation (landscape or portrait).
+//! @returns Value of "${style}\${orientation}\max-candidates", or 0 if the
+//!          style does not tell.
+int StyleAttributes::maxCandidates(Logic::LayoutHelper::Orientation orientation) const
+{
+    return resolved(orientation).max_candidates;
 }
 
 
@@ -434,9 +604,7 @@ qreal StyleAttributes::wordRibbonHeight(Logic::LayoutHelper::Orientation orienta
 //! @returns Value of "${style}\${orientation}\magnifier-key-height".
 qreal StyleAttributes::magnifierKeyHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-height")).toReal();
+    return resolved(orientation).magnifier_key_height;
 }
 
 
@@ -445,9 +613,7 @@ qreal StyleAttributes::magnifierKeyHeight(Logic::LayoutHelper::Orientation orien
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-height")).toReal();
+    return resolved(orientation).key_height;
 }
 
 
@@ -456,9 +622,7 @@ qreal StyleAttributes::keyHeight(Logic::LayoutHelper::Orientation orientation) c
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyTopRowHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-top-row-height")).toReal();
+    return resolved(orientation).key_top_row_height;
 }
 
 
@@ -467,9 +631,7 @@ qreal StyleAttributes::keyTopRowHeight(Logic::LayoutHelper::Orientation orientat
 //! @returns Value of "${style}\${orientation}\key-height".
 qreal StyleAttributes::keyBottomRowHeight(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-bottom-row-height")).toReal();
+    return resolved(orientation).key_bottom_row_height;
 }
 
 
@@ -478,9 +640,7 @@ qreal StyleAttributes::keyBottomRowHeight(Logic::LayoutHelper::Orientation orien
 //! @returns Value of "${style}\${orientation}\magnifier-key-width".
 qreal StyleAttributes::magnifierKeyWidth(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-width")).toReal();
+    return resolved(orientation).magnifier_key_width;
 }
 
 
@@ -491,9 +651,7 @@ qreal StyleAttributes::magnifierKeyWidth(Logic::LayoutHelper::Orientation orient
 qreal StyleAttributes::keyWidth(Logic::LayoutHelper::Orientation orientation,
                                 KeyDescription::Width width) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-width").append(fromKeyWidth(width))).toReal();
+    return resolved(orientation).key_widths[width];
 }
 
 
@@ -502,9 +660,7 @@ qreal StyleAttributes::keyWidth(Logic::LayoutHelper::Orientation orientation,
 //! @returns Value of "${style}\${orientation}\key-area-width".
 qreal StyleAttributes::keyAreaWidth(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-area-width")).toReal();
+    return resolved(orientation).key_area_width;
 }
 
 
@@ -517,9 +673,7 @@ qreal StyleAttributes::keyAreaWidth(Logic::LayoutHelper::Orientation orientation
 //! @returns Value of "${style}\${orientation}\key-margins".
 qreal StyleAttributes::keyMargin(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-margins")).toReal();
+    return resolved(orientation).key_margin;
 }
 
 //! \brief Looks up the key area paddings.
@@ -532,9 +686,7 @@ qreal StyleAttributes::keyMargin(Logic::LayoutHelper::Orientation orientation) c
 //! @returns Value of "${style}\${orientation}\key-area-paddings".
 qreal StyleAttributes::keyAreaPadding(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("key-area-paddings")).toReal();
+    return resolved(orientation).key_area_padding;
 }
 
 
@@ -546,9 +698,7 @@ qreal StyleAttributes::keyAreaPadding(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\vertical-offset".
 qreal StyleAttributes::verticalOffset(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("vertical-offset")).toReal();
+    return resolved(orientation).vertical_offset;
 }
 
 
@@ -557,9 +707,7 @@ qreal StyleAttributes::verticalOffset(Logic::LayoutHelper::Orientation orientati
 //! @returns Value of "${style}\${orientation}\magnifier-key-label-vertical-offset".
 qreal StyleAttributes::magnifierKeyLabelVerticalOffset(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("magnifier-key-label-vertical-offset")).toReal();
+    return resolved(orientation).magnifier_key_label_vertical_offset;
 }
 
 
@@ -571,9 +719,7 @@ qreal StyleAttributes::magnifierKeyLabelVerticalOffset(Logic::LayoutHelper::Orie
 //! @returns Value of "${style}\${orientation}\safety-margin".
 qreal StyleAttributes::safetyMargin(Logic::LayoutHelper::Orientation orientation) const
 {
-    return lookup(m_store, orientation,
-                  m_style_name.toLocal8Bit(),
-                  QByteArray("safety-margin")).toReal();
+    return resolved(orientation).safety_margin;
 }
 
 
@@ -581,7 +727,7 @@ qreal StyleAttributes::safetyMargin(Logic::LayoutHelper::Orientation orientation
 //! @returns Value of "sound/key-press".
 QByteArray StyleAttributes::keyPressSound() const
 {
-    return m_store->value("sound/key-press").toByteArray();
+    return m_key_press_sound;
 }
 
 
@@ -589,7 +735,7 @@ QByteArray StyleAttributes::keyPressSound() const
 //! @returns Value of "sound/key-release".
 QByteArray StyleAttributes::keyReleaseSound() const
 {
-    return m_store->value("sound/key-release").toByteArray();
+    return m_key_release_sound;
 }
 
 
@@ -597,7 +743,7 @@ QByteArray StyleAttributes::keyReleaseSound() const
 //! @returns Value of "sound/layout-change".
 QByteArray StyleAttributes::layoutChangeSound() const
 {
-    return m_store->value("sound/layout-change").toByteArray();
+    return m_layout_change_sound;
 }
 
 
@@ -605,7 +751,7 @@ QByteArray StyleAttributes::layoutChangeSound() const
 //! @returns Value of "sound/keyboard-hide".
 QByteArray StyleAttributes::keyboardHideSound() const
 {
-    return m_store->value("sound/keyboard-hide").toByteArray();
+    return m_keyboard_hide_sound;
 }
 
 } // namespace MaliitKeyboard
@@ -43,14 +43,73 @@ namespace MaliitKeyboard {
 class StyleAttributes
 {
 private:
+    //! Attributes of one style section for one orientation, with the
+    //! fallback to the 'default' section already applied.
+    struct ResolvedOrientation
+    {
+        QByteArray font_name;
+        QByteArray font_color;
+        qreal font_size;
+        qreal small_font_size;
+        qreal candidate_font_size;
+        qreal magnifier_font_size;
+        qreal candidate_font_stretch;
+        qreal word_ribbon_height;
+        int max_candidates;
+        qreal magnifier_key_height;
+        qreal key_height;
+        qreal key_top_row_height;
+        qreal key_bottom_row_height;
+        qreal magnifier_key_width;
+        qreal key_widths[KeyDescription::Stretched + 1];
+        qreal key_area_width;
+        qreal key_margin;
+        qreal key_area_padding;
+        qreal vertical_offset;
+        qreal magnifier_key_label_vertical_offset;
+        qreal safety_margin;
+    };
+
+    //! All orientation-dependent attributes of one style section, indexed
+    //! by Logic::LayoutHelper::Orientation.
+    struct ResolvedStyle
+    {
+        ResolvedOrientation orientations[Logic::LayoutHelper::Portrait + 1];
+    };
+
     const QScopedPointer<const QSettings> m_store;
     QString m_style_name;
+    QHash<QString, ResolvedStyle> m_resolved_styles;
+    const ResolvedStyle *m_active;
+
+    QByteArray m_word_ribbon_background;
+    QByteArray m_key_area_background;
+    QByteArray m_magnifier_key_background;
+    QByteArray m_key_backgrounds[Key::StyleActivated + 1][KeyDescription::HighlightedState + 1];
+    QMargins m_word_ribbon_background_borders;
+    QMargins m_key_area_background_borders;
+    QMargins m_magnifier_key_background_borders;
+    QMargins m_key_background_borders;
+    QByteArray m_icons[KeyDescription::CustomIcon + 1][KeyDescription::HighlightedState + 1];
+    QHash<QString, QByteArray> m_custom_icons;
+    QStringList m_font_files;
+    QByteArray m_key_press_sound;
+    QByteArray m_key_release_sound;
+    QByteArray m_layout_change_sound;
+    QByteArray m_keyboard_hide_sound;
+
+    void resolve();
+    ResolvedOrientation resolveOrientation(Logic::LayoutHelper::Orientation orientation,
+                                           const QByteArray &style_name) const;
+    const ResolvedOrientation &resolved(Logic::LayoutHelper::Orientation orientation) const;
 
 public:
     explicit StyleAttributes(const QSettings *store);
+    StyleAttributes(const StyleAttributes &other);
     virtual ~StyleAttributes();
 
     virtual void setStyleName(const QString &name);
+    QString styleName() const;
     QByteArray wordRibbonBackground() const;
     QByteArray keyAreaBackground() const;
     QByteArray magnifierKeyBackground() const;
@@ -78,6 +137,7 @@ public:
     qreal candidateFontStretch(Logic::LayoutHelper::Orientation orientation) const;
 
     qreal wordRibbonHeight(Logic::LayoutHelper::Orientation orientation) const;
+    int maxCandidates(Logic::LayoutHelper::Orientation orientation) const;
     qreal magnifierKeyHeight(Logic::LayoutHelper::Orientation orientation) const;
     qreal keyHeight(Logic::LayoutHelper::Orientation orientation) const;
     qreal keyTopRowHeight(Logic::LayoutHelper::Orientation orientation) const;
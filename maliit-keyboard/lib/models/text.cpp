@@ -32,6 +32,20 @@
 
 #include "text.h"
 
+namespace {
+
+bool isWordCharacter(const QChar &c)
+{
+    return (c.isLetterOrNumber() or c == QLatin1Char('\''));
+}
+
+bool isSentenceEnd(const QChar &c)
+{
+    return (c == QLatin1Char('.') or c == QLatin1Char('!') or c == QLatin1Char('?'));
+}
+
+} // namespace
+
 //! \class Text
 //! \brief Represents the text state of the editor
 //!
@@ -41,6 +55,8 @@
 namespace MaliitKeyboard {
 namespace Model {
 
+const int Text::MaxContextWords;
+
 //! C'tor
 Text::Text()
     : m_preedit()
@@ -48,6 +64,10 @@ Text::Text()
     , m_surrounding_offset(0)
     , m_face(PreeditDefault)
     , m_cursor_position(0)
+    // A new text starts a sentence, which an empty entry marks, as in
+    // setContext():
+    , m_context(QStringList() << QString())
+    , m_content_type(FreeTextContent)
 {}
 
 //! Returns current preedit.
@@ -91,6 +111,7 @@ void Text::commitPreedit()
     // we would expect the text editor to just update the surrounding text.
     // Raises the question whether we should have commitPreedit here at all,
     // but it does preserve some consistency at least.
+    appendToContext(m_preedit);
     m_surrounding = m_preedit;
     m_surrounding_offset = m_preedit.length();
     m_preedit.clear();
@@ -151,6 +172,80 @@ void Text::setSurroundingOffset(uint offset)
     m_surrounding_offset = offset;
 }
 
+//! Returns the last words left of preedit, oldest first, at most
+//! MaxContextWords. Empty strings mark the start of a sentence.
+//!
+//! The context is kept up to date incrementally, so word engines can use
+//! it without looking at the whole surrounding text.
+QStringList Text::context() const
+{
+    return m_context;
+}
+
+//! Replaces context by the words of text left of position.
+//! \param text the text containing preedit. Only read backwards from
+//!             position up to the last MaxContextWords words or the start
+//!             of the last sentence.
+//! \param position the position of preedit in text. If lower than 0 or
+//!                 larger than text, the end of text is used.
+void Text::setContext(const QString &text,
+                      int position /* = -1 */)
+{
+    m_context.clear();
+    int index((position < 0 or position > text.length()) ? text.length() : position);
+
+    while (m_context.size() < MaxContextWords) {
+        while (index > 0 and not isWordCharacter(text.at(index - 1))
+               and not isSentenceEnd(text.at(index - 1))) {
+            --index;
+        }
+
+        if (index == 0 or isSentenceEnd(text.at(index - 1))) {
+            m_context.prepend(QString());
+            break;
+        }
+
+        const int end(index);
+
+        while (index > 0 and isWordCharacter(text.at(index - 1))) {
+            --index;
+        }
+
+        m_context.prepend(text.mid(index, end - index));
+    }
+}
+
+//! Appends the words of text to context, dropping the oldest words.
+//! \param text committed text.
+void Text::appendToContext(const QString &text)
+{
+    int begin(-1);
+
+    for (int index = 0; index <= text.length(); ++index) {
+        if (index < text.length() and isWordCharacter(text.at(index))) {
+            if (begin < 0) {
+                begin = index;
+            }
+
+            continue;
+        }
+
+        if (begin >= 0) {
+            m_context.append(text.mid(begin, index - begin));
+            begin = -1;
+        }
+
+        if (index < text.length() and isSentenceEnd(text.at(index))
+            and not m_context.isEmpty() and not m_context.last().isEmpty()) {
+            m_context.append(QString());
+        }
+    }
+
+    while (m_context.size() > MaxContextWords) {
+        m_context.removeFirst();
+    }
+}
+
 //! Returns face of preedit.
 Text::PreeditFace Text::preeditFace() const
 {
@@ -177,4 +272,17 @@ void Text::setCursorPosition(int cursor_position)
     m_cursor_position = cursor_position;
 }
 
+//! Returns the kind of text the edited field expects.
+Text::ContentType Text::contentType() const
+{
+    return m_content_type;
+}
+
+//! Sets the kind of text the edited field expects. Survives commits.
+//! \param content_type new content type.
+void Text::setContentType(ContentType content_type)
+{
+    m_content_type = content_type;
+}
+
 }} // namespace Model, MaliitKeyboard
@@ -49,6 +49,17 @@ public:
         PreeditActive         //!< Preedit region with active suggestions.
     };
 
+    enum ContentType {
+        FreeTextContent,    //!< Natural language, used when none of below cases applies.
+        NumberContent,      //!< Numbers only.
+        PhoneNumberContent, //!< Phone numbers.
+        EmailContent,       //!< Email addresses.
+        UrlContent          //!< Web addresses.
+    };
+
+    //! Maximum number of words kept in context().
+    static const int MaxContextWords = 4;
+
 private:
     QString m_preedit; //!< current text segment that is edited.
     QString m_surrounding; //!< text to left and right side of cursor position, in current text block.
@@ -56,6 +67,8 @@ private:
     uint m_surrounding_offset; //!< offset of cursor position in surrounding text.
     PreeditFace m_face; //!< face of preedit.
     int m_cursor_position; //!< position of cursor in preedit string.
+    QStringList m_context; //!< last words left of preedit, oldest first.
+    ContentType m_content_type; //!< kind of text the edited field expects.
 
 public:
     explicit Text();
@@ -77,11 +90,19 @@ public:
     uint surroundingOffset() const;
     void setSurroundingOffset(uint offset);
 
+    QStringList context() const;
+    void setContext(const QString &text,
+                    int position = -1);
+    void appendToContext(const QString &text);
+
     PreeditFace preeditFace() const;
     void setPreeditFace(PreeditFace face);
 
     int cursorPosition() const;
     void setCursorPosition(int cursor_position);
+
+    ContentType contentType() const;
+    void setContentType(ContentType content_type);
 };
 
 }} // namespace Model, MaliitKeyboard
@@ -142,4 +142,14 @@ bool operator!=(const WordCandidate &lhs,
     return (not (lhs == rhs));
 }
 
+//! \brief Hash function, consistent with operator==.
+uint qHash(const WordCandidate &candidate)
+{
+    const QRect &rect(candidate.rect());
+
+    return (qHash(candidate.label().text())
+            ^ (uint(rect.x()) << 16) ^ uint(rect.y())
+            ^ (uint(rect.width()) << 8) ^ (uint(rect.height()) << 24));
+}
+
 } // namespace MaliitKeyboard
@@ -91,6 +91,8 @@ bool operator==(const WordCandidate &lhs,
 bool operator!=(const WordCandidate &lhs,
                 const WordCandidate &rhs);
 
+uint qHash(const WordCandidate &candidate);
+
 } // namespace MaliitKeyboard
 
 #endif // MALIIT_KEYBOARD_WORDCANDIDATE_H
@@ -0,0 +1,548 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include "layoutblob.h"
+#include "layoutparser.h"
+
+#include <QtEndian>
+#include <QHash>
+
+namespace MaliitKeyboard {
+
+namespace {
+
+const int HeaderWords = 5;
+
+void appendWord(QByteArray *out,
+                quint32 value)
+{
+    uchar bytes[4];
+
+    qToLittleEndian<quint32>(value, bytes);
+    out->append(reinterpret_cast<const char *>(bytes), 4);
+}
+
+class BlobWriter
+{
+public:
+    QByteArray strings;
+    quint32 string_count;
+    QByteArray tree;
+    QHash<QString, quint32> string_ids;
+
+    BlobWriter()
+        : strings()
+        , string_count(0)
+        , tree()
+        , string_ids()
+    {}
+
+    void put(quint32 value)
+    {
+        appendWord(&tree, value);
+    }
+
+    void putString(const QString &string)
+    {
+        QHash<QString, quint32>::const_iterator it(string_ids.constFind(string));
+
+        if (it != string_ids.constEnd()) {
+            put(it.value());
+            return;
+        }
+
+        const quint32 id(string_count++);
+
+        string_ids.insert(string, id);
+        appendWord(&strings, string.size());
+
+        for (int iter(0); iter < string.size(); ++iter) {
+            uchar bytes[2];
+
+            qToLittleEndian<quint16>(string.at(iter).unicode(), bytes);
+            strings.append(reinterpret_cast<const char *>(bytes), 2);
+        }
+
+        // Keep words aligned.
+        if (string.size() % 2) {
+            strings.append("\0\0", 2);
+        }
+
+        put(id);
+    }
+
+    void putStringList(const QStringList &list)
+    {
+        put(list.size());
+
+        Q_FOREACH (const QString &string, list) {
+            putString(string);
+        }
+    }
+
+    void putBinding(const TagBindingPtr &binding)
+    {
+        put(binding ? 1 : 0);
+
+        if (not binding) {
+            return;
+        }
+
+        put(binding->action());
+        putString(binding->label());
+        putString(binding->secondary_label());
+        putString(binding->accents());
+        putString(binding->accented_labels());
+        putString(binding->cycle_set());
+        putString(binding->sequence());
+        putString(binding->icon());
+        put(binding->dead());
+        put(binding->quick_pick());
+        put(binding->rtl());
+        put(binding->enlarge());
+
+        const TagModifiersPtrs all_modifiers(binding->modifiers());
+
+        put(all_modifiers.size());
+
+        Q_FOREACH (const TagModifiersPtr &modifiers, all_modifiers) {
+            put(modifiers->keys());
+            putBinding(modifiers->binding());
+        }
+    }
+
+    void putRows(const TagRowPtrs &rows)
+    {
+        put(rows.size());
+
+        Q_FOREACH (const TagRowPtr &row, rows) {
+            const TagRowElementPtrs elements(row->elements());
+
+            put(row->height());
+            put(elements.size());
+
+            Q_FOREACH (const TagRowElementPtr &element, elements) {
+                put(element->element_type());
+
+                if (element->element_type() != TagRowElement::Key) {
+                    continue;
+                }
+
+                const TagKeyPtr key(element.staticCast<TagKey>());
+                const TagExtendedPtr extended(key->extended());
+
+                put(key->style());
+                put(key->width());
+                put(key->rtl());
+                putString(key->id());
+                putBinding(key->binding());
+                put(extended ? 1 : 0);
+
+                if (extended) {
+                    putRows(extended->rows());
+                }
+            }
+        }
+    }
+
+    void putKeyboard(const TagKeyboardPtr &keyboard)
+    {
+        putString(keyboard->version());
+        putString(keyboard->title());
+        putString(keyboard->language());
+        putString(keyboard->catalog());
+        put(keyboard->autocapitalization());
+
+        const TagLayoutPtrs layouts(keyboard->layouts());
+
+        put(layouts.size());
+
+        Q_FOREACH (const TagLayoutPtr &layout, layouts) {
+            const TagSectionPtrs sections(layout->sections());
+
+            put(layout->type());
+            put(layout->orientation());
+            put(layout->uniform_font_size());
+            put(sections.size());
+
+            Q_FOREACH (const TagSectionPtr &section, sections) {
+                putString(section->id());
+                put(section->movable());
+                put(section->type());
+                putString(section->style());
+                putRows(section->rows());
+            }
+        }
+    }
+};
+
+} // anonymous namespace
+
+QByteArray LayoutBlob::compile(const LayoutParser &parser)
+{
+    const TagKeyboardPtr keyboard(parser.keyboard());
+
+    if (not keyboard) {
+        return QByteArray();
+    }
+
+    BlobWriter writer;
+
+    writer.putStringList(parser.imports());
+    writer.putStringList(parser.symviews());
+    writer.putStringList(parser.numbers());
+    writer.putStringList(parser.phonenumbers());
+    writer.putKeyboard(keyboard);
+
+    QByteArray blob;
+
+    blob.reserve(HeaderWords * 4 + writer.strings.size() + writer.tree.size());
+    appendWord(&blob, Magic);
+    appendWord(&blob, Version);
+    appendWord(&blob, writer.string_count);
+    appendWord(&blob, writer.strings.size() / 4);
+    appendWord(&blob, writer.tree.size() / 4);
+    blob.append(writer.strings);
+    blob.append(writer.tree);
+
+    return blob;
+}
+
+QString LayoutBlob::fileSuffix()
+{
+    return QString::fromLatin1(".blob");
+}
+
+LayoutBlobReader::LayoutBlobReader(const uchar *data,
+                                   qint64 size)
+    : m_data(data)
+    , m_size(size)
+    , m_pos(0)
+    , m_strings()
+    , m_error_string()
+    , m_keyboard()
+    , m_imports()
+    , m_symviews()
+    , m_numbers()
+    , m_phonenumbers()
+{}
+
+bool LayoutBlobReader::read()
+{
+    m_pos = 0;
+
+    if (not m_data or m_size < HeaderWords * 4) {
+        error(QString::fromLatin1("Blob too short."));
+        return false;
+    }
+
+    const quint32 magic(next());
+    const quint32 version(next());
+    const quint32 string_count(next());
+    const quint32 string_words(next());
+    const quint32 tree_words(next());
+
+    if (magic != LayoutBlob::Magic) {
+        error(QString::fromLatin1("Not a compiled layout."));
+    } else if (version != LayoutBlob::Version) {
+        error(QString::fromLatin1("Expected version %1, but got %2.").arg(LayoutBlob::Version).arg(version));
+    } else if ((HeaderWords + qint64(string_words) + tree_words) * 4 != m_size) {
+        error(QString::fromLatin1("Blob size does not match its header."));
+    } else if (readStrings(string_count)) {
+        if (m_pos != (HeaderWords + qint64(string_words)) * 4) {
+            error(QString::fromLatin1("String table size does not match its header."));
+        } else {
+            m_imports = nextStringList();
+            m_symviews = nextStringList();
+            m_numbers = nextStringList();
+            m_phonenumbers = nextStringList();
+            readKeyboard();
+        }
+    }
+
+    if (not m_error_string.isEmpty()) {
+        m_keyboard.clear();
+        return false;
+    }
+
+    return true;
+}
+
+const QString LayoutBlobReader::errorString() const
+{
+    return m_error_string;
+}
+
+const TagKeyboardPtr LayoutBlobReader::keyboard() const
+{
+    return m_keyboard;
+}
+
+const QStringList LayoutBlobReader::imports() const
+{
+    return m_imports;
+}
+
+const QStringList LayoutBlobReader::symviews() const
+{
+    return m_symviews;
+}
+
+const QStringList LayoutBlobReader::numbers() const
+{
+    return m_numbers;
+}
+
+const QStringList LayoutBlobReader::phonenumbers() const
+{
+    return m_phonenumbers;
+}
+
+template <class E>
+E LayoutBlobReader::nextEnum(E last)
+{
+    const quint32 value(next());
+
+    if (value > static_cast<quint32>(last)) {
+        error(QString::fromLatin1("Invalid enum value %1.").arg(value));
+        return static_cast<E>(0);
+    }
+
+    return static_cast<E>(value);
+}
+
+bool LayoutBlobReader::readStrings(quint32 count)
+{
+    m_strings.clear();
+
+    if (count > m_size / 4) {
+        error(QString::fromLatin1("Invalid string count."));
+        return false;
+    }
+
+    m_strings.reserve(count);
+
+    for (quint32 iter(0); iter < count and m_error_string.isEmpty(); ++iter) {
+        const quint32 length(next());
+        const qint64 padded_bytes((qint64(length) * 2 + 3) & ~qint64(3));
+
+        if (m_pos + padded_bytes > m_size) {
+            error(QString::fromLatin1("String %1 exceeds blob size.").arg(iter));
+            break;
+        }
+
+        QString string(length, Qt::Uninitialized);
+        QChar *characters(string.data());
+        const uchar *source(m_data + m_pos);
+
+        for (quint32 index(0); index < length; ++index) {
+            characters[index] = QChar(qFromLittleEndian<quint16>(source + index * 2));
+        }
+
+        m_strings.append(string);
+        m_pos += padded_bytes;
+    }
+
+    return m_error_string.isEmpty();
+}
+
+void LayoutBlobReader::readKeyboard()
+{
+    const QString version(nextString());
+    const QString title(nextString());
+    const QString language(nextString());
+    const QString catalog(nextString());
+    const bool autocapitalization(nextBool());
+    const TagKeyboardPtr keyboard(new TagKeyboard(version, title, language,
+                                                  catalog, autocapitalization));
+    const quint32 layout_count(next());
+
+    for (quint32 iter(0); iter < layout_count and m_error_string.isEmpty(); ++iter) {
+        readLayout(keyboard);
+    }
+
+    m_keyboard = keyboard;
+}
+
+void LayoutBlobReader::readLayout(const TagKeyboardPtr &keyboard)
+{
+    const TagLayout::LayoutType type(nextEnum(TagLayout::Common));
+    const TagLayout::LayoutOrientation orientation(nextEnum(TagLayout::Portrait));
+    const bool uniform_font_size(nextBool());
+    const TagLayoutPtr layout(new TagLayout(type, orientation, uniform_font_size));
+    const quint32 section_count(next());
+
+    keyboard->appendLayout(layout);
+
+    for (quint32 iter(0); iter < section_count and m_error_string.isEmpty(); ++iter) {
+        readSection(layout);
+    }
+}
+
+void LayoutBlobReader::readSection(const TagLayoutPtr &layout)
+{
+    const QString id(nextString());
+    const bool movable(nextBool());
+    const TagSection::SectionType type(nextEnum(TagSection::Nonsloppy));
+    const QString style(nextString());
+    const TagSectionPtr section(new TagSection(id, movable, type, style));
+
+    layout->appendSection(section);
+    readRows(section);
+}
+
+void LayoutBlobReader::readRows(const TagRowContainerPtr &row_container)
+{
+    const quint32 row_count(next());
+
+    for (quint32 iter(0); iter < row_count and m_error_string.isEmpty(); ++iter) {
+        const TagRow::Height height(nextEnum(TagRow::XXLarge));
+        const TagRowPtr row(new TagRow(height));
+        const quint32 element_count(next());
+
+        row_container->appendRow(row);
+
+        for (quint32 index(0); index < element_count and m_error_string.isEmpty(); ++index) {
+            const TagRowElement::ElementType type(nextEnum(TagRowElement::Spacer));
+
+            if (type == TagRowElement::Key) {
+                readKey(row);
+            } else {
+                row->appendElement(TagSpacerPtr(new TagSpacer));
+            }
+        }
+    }
+}
+
+void LayoutBlobReader::readKey(const TagRowPtr &row)
+{
+    const TagKey::Style style(nextEnum(TagKey::Activated));
+    const TagKey::Width width(nextEnum(TagKey::Stretched));
+    const bool rtl(nextBool());
+    const QString id(nextString());
+    const TagKeyPtr key(new TagKey(style, width, rtl, id));
+
+    row->appendElement(key);
+    key->setBinding(readBinding());
+
+    if (nextBool()) {
+        const TagExtendedPtr extended(new TagExtended);
+
+        key->setExtended(extended);
+        readRows(extended);
+    }
+}
+
+TagBindingPtr LayoutBlobReader::readBinding()
+{
+    if (not nextBool()) {
+        return TagBindingPtr();
+    }
+
+    const TagBinding::Action action(nextEnum(TagBinding::Command));
+    const QString label(nextString());
+    const QString secondary_label(nextString());
+    const QString accents(nextString());
+    const QString accented_labels(nextString());
+    const QString cycle_set(nextString());
+    const QString sequence(nextString());
+    const QString icon(nextString());
+    const bool dead(nextBool());
+    const bool quick_pick(nextBool());
+    const bool rtl(nextBool());
+    const bool enlarge(nextBool());
+    const TagBindingPtr binding(new TagBinding(action, label, secondary_label, accents,
+                                               accented_labels, cycle_set, sequence, icon,
+                                               dead, quick_pick, rtl, enlarge));
+    const quint32 modifiers_count(next());
+
+    for (quint32 iter(0); iter < modifiers_count and m_error_string.isEmpty(); ++iter) {
+        const TagModifiers::Keys keys(nextEnum(TagModifiers::AltShift));
+        const TagModifiersPtr modifiers(new TagModifiers(keys));
+
+        modifiers->setBinding(readBinding());
+        binding->appendModifiers(modifiers);
+    }
+
+    return binding;
+}
+
+quint32 LayoutBlobReader::next()
+{
+    if (m_pos + 4 > m_size) {
+        error(QString::fromLatin1("Unexpected end of blob."));
+        return 0;
+    }
+
+    const quint32 value(qFromLittleEndian<quint32>(m_data + m_pos));
+
+    m_pos += 4;
+    return value;
+}
+
+bool LayoutBlobReader::nextBool()
+{
+    return (next() != 0);
+}
+
+const QString LayoutBlobReader::nextString()
+{
+    const quint32 id(next());
+
+    if (id >= static_cast<quint32>(m_strings.size())) {
+        error(QString::fromLatin1("Invalid string id %1.").arg(id));
+        return QString();
+    }
+
+    return m_strings.at(id);
+}
+
+const QStringList LayoutBlobReader::nextStringList()
+{
+    QStringList list;
+    const quint32 count(next());
+
+    for (quint32 iter(0); iter < count and m_error_string.isEmpty(); ++iter) {
+        list.append(nextString());
+    }
+
+    return list;
+}
+
+void LayoutBlobReader::error(const QString &message)
+{
+    if (m_error_string.isEmpty()) {
+        m_error_string = QString::number(m_pos) + " - " + message;
+    }
+}
+
+} // namespace MaliitKeyboard
@@ -0,0 +1,122 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef MALIIT_KEYBOARD_LAYOUTBLOB_H
+#define MALIIT_KEYBOARD_LAYOUTBLOB_H
+
+#include <QByteArray>
+#include <QStringList>
+#include <QVector>
+
+#include "alltagtypes.h"
+
+namespace MaliitKeyboard {
+
+class LayoutParser;
+
+//! \brief Compiled binary form of a language layout file.
+//!
+//! A blob holds the fully resolved tag tree of a parsed layout file together
+//! with its imports. All strings are interned in a string table, so each
+//! distinct label is decoded only once when loading. Integers are stored as
+//! little endian 32 bit words.
+class LayoutBlob
+{
+public:
+    enum {
+        Magic = 0x424c4b4d, // "MKLB"
+        Version = 1
+    };
+
+    //! \brief Serializes a successfully parsed layout file.
+    static QByteArray compile(const LayoutParser &parser);
+    //! @returns file name suffix of compiled layout files.
+    static QString fileSuffix();
+};
+
+//! \brief Reads a compiled layout, usually from a memory mapped file.
+//!
+//! Provides the same results as LayoutParser does for the source file.
+class LayoutBlobReader
+{
+    Q_DISABLE_COPY(LayoutBlobReader)
+
+public:
+    //! \param data Compiled layout. Needs to stay valid only during read().
+    //! \param size Size of data in bytes.
+    explicit LayoutBlobReader(const uchar *data,
+                              qint64 size);
+
+    bool read();
+
+    const QString errorString() const;
+
+    const TagKeyboardPtr keyboard() const;
+    const QStringList imports() const;
+    const QStringList symviews() const;
+    const QStringList numbers() const;
+    const QStringList phonenumbers() const;
+
+private:
+    const uchar *m_data;
+    const qint64 m_size;
+    qint64 m_pos;
+    QVector<QString> m_strings;
+    QString m_error_string;
+    TagKeyboardPtr m_keyboard;
+    QStringList m_imports;
+    QStringList m_symviews;
+    QStringList m_numbers;
+    QStringList m_phonenumbers;
+
+    bool readStrings(quint32 count);
+    void readKeyboard();
+    void readLayout(const TagKeyboardPtr &keyboard);
+    void readSection(const TagLayoutPtr &layout);
+    void readRows(const TagRowContainerPtr &row_container);
+    void readKey(const TagRowPtr &row);
+    TagBindingPtr readBinding();
+
+    quint32 next();
+    bool nextBool();
+    const QString nextString();
+    const QStringList nextStringList();
+
+    template <class E>
+    E nextEnum(E last);
+
+    void error(const QString &message);
+};
+
+} // namespace MaliitKeyboard
+
+#endif // MALIIT_KEYBOARD_LAYOUTBLOB_H
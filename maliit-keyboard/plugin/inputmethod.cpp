@@ -43,6 +43,8 @@
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
 #include "logic/wordengine.h"
+#include "logic/dawgwordengine.h"
+#include "logic/chinesewordengine.h"
 #include "logic/style.h"
 #include "logic/languagefeatures.h"
 #include "logic/eventhandler.h"
@@ -76,6 +78,8 @@ namespace {
 
 const int AutoRepeatDelayDefault = 500;
 const int AutoRepeatIntervalDefault = 50;
+const int CandidatesQuietPeriodDefault = 60;
+const int CandidatesMaxLatencyDefault = 200;
 
 void makeQuickViewTransparent(QQuickView *view)
 {
@@ -137,6 +141,7 @@ public:
     ScopedSetting word_engine;
     ScopedSetting hide_word_ribbon_in_portrait_mode;
     ScopedSetting auto_repeat_behaviour;
+    ScopedSetting swipe_typing;
 };
 
 class LayoutGroup
@@ -164,7 +169,9 @@ public:
     QScopedPointer<QQuickView> surface;
     QScopedPointer<QQuickView> extended_surface;
     QScopedPointer<QQuickView> magnifier_surface;
+    Logic::ChineseWordEngine conversion_engine;
     Editor editor;
+    Logic::AbstractWordEngine *const word_engine;
     DefaultFeedback feedback;
     SharedStyle style;
     UpdateNotifier notifier;
@@ -179,6 +186,8 @@ public:
                                 MAbstractInputMethodHost *host);
     void setLayoutOrientation(Logic::LayoutHelper::Orientation orientation);
     void syncWordEngine(Logic::LayoutHelper::Orientation orientation);
+    void syncMaxCandidates(Logic::LayoutHelper::Orientation orientation);
+    void syncSwipeTyping();
 
     void connectToNotifier();
     void setContextProperties(QQmlContext *qml_context);
@@ -190,7 +199,13 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     : surface(getSurface(host))
     , extended_surface(getOverlaySurface(host, surface.data()))
     , magnifier_surface(getOverlaySurface(host, surface.data()))
+    , conversion_engine()
+#ifdef HAVE_DAWG
+    , editor(new Model::Text, new Logic::DawgWordEngine, new Logic::LanguageFeatures)
+#else
     , editor(new Model::Text, new Logic::WordEngine, new Logic::LanguageFeatures)
+#endif
+    , word_engine(editor.wordEngine())
     , feedback()
     , style(new Style)
     , notifier()
@@ -207,6 +222,15 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
     editor.setPreeditEnabled(true);
 #endif
 
+    // Keep slow word prediction or error correction off the GUI thread:
+    word_engine->setAsynchronous(true);
+    word_engine->setCoalescing(CandidatesQuietPeriodDefault,
+                               CandidatesMaxLatencyDefault);
+
+    // Layout switches parse and convert layouts off the GUI thread, too:
+    layout.updater.setAsynchronous(true);
+    extended_layout.updater.setAsynchronous(true);
+
     layout.updater.setLayout(&layout.helper);
     extended_layout.updater.setLayout(&extended_layout.helper);
 
@@ -249,6 +273,7 @@ InputMethodPrivate::InputMethodPrivate(InputMethod *const q,
 void InputMethodPrivate::setLayoutOrientation(Logic::LayoutHelper::Orientation orientation)
 {
     syncWordEngine(orientation);
+    syncMaxCandidates(orientation);
     layout.updater.setOrientation(orientation);
     extended_layout.updater.setOrientation(orientation);
 }
@@ -265,9 +290,29 @@ void InputMethodPrivate::syncWordEngine(Logic::LayoutHelper::Orientation orienta
     const bool override_activation = true;
 #endif
 
-    editor.wordEngine()->setEnabled(override_activation
-                                    ? false
-                                    : settings.word_engine->value().toBool());
+    word_engine->setEnabled(override_activation
+                            ? false
+                            : settings.word_engine->value().toBool());
+    syncSwipeTyping();
+}
+
+void InputMethodPrivate::syncMaxCandidates(Logic::LayoutHelper::Orientation orientation)
+{
+    // Styles that do not tell get the default:
+    const int max_candidates(style->attributes()->maxCandidates(orientation));
+
+    word_engine->setMaxCandidates(max_candidates);
+    conversion_engine.setMaxCandidates(max_candidates);
+}
+
+void InputMethodPrivate::syncSwipeTyping()
+{
+    // Without an enabled decoder, a swipe would swallow the touched key and
+    // produce no word:
+    layout.event_handler.setSwipeEnabled(not settings.swipe_typing.isNull()
+                                         && settings.swipe_typing->value().toBool()
+                                         && editor.wordEngine()->supportsSwipe()
+                                         && editor.wordEngine()->isEnabled());
 }
 
 void InputMethodPrivate::connectToNotifier()
@@ -275,6 +320,9 @@ void InputMethodPrivate::connectToNotifier()
     QObject::connect(&notifier, SIGNAL(cursorPositionChanged(int, QString)),
                      &editor,   SLOT(onCursorPositionChanged(int, QString)));
 
+    QObject::connect(&notifier, SIGNAL(contentTypeChanged(Model::Text::ContentType)),
+                     &editor,   SLOT(setContentType(Model::Text::ContentType)));
+
     QObject::connect(&notifier,      SIGNAL(keysOverriden(Logic::KeyOverrides, bool)),
                      &layout.helper, SLOT(onKeysOverriden(Logic::KeyOverrides, bool)));
 }
@@ -305,6 +353,9 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(&d->layout.helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
             &d->layout.model, SLOT(setKeyArea(KeyArea)));
 
+    connect(&d->layout.helper, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)),
+            d->word_engine,    SLOT(setKeyArea(KeyArea)));
+
     connect(&d->extended_layout.helper, SIGNAL(extendedPanelChanged(KeyArea,Logic::KeyOverrides)),
             &d->extended_layout.model, SLOT(setKeyArea(KeyArea)));
 
@@ -320,6 +371,9 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     connect(&d->layout.updater, SIGNAL(keyboardTitleChanged(QString)),
             &d->layout.model,   SLOT(setTitle(QString)));
 
+    connect(&d->layout.updater, SIGNAL(keyboardLanguageChanged(QString)),
+            this,               SLOT(onKeyboardLanguageChanged(QString)));
+
     connect(&d->extended_layout.model, SIGNAL(widthChanged(int)),
             this,                      SLOT(onExtendedLayoutWidthChanged(int)));
 
@@ -354,6 +408,7 @@ InputMethod::InputMethod(MAbstractInputMethodHost *host)
     registerWordEngineSetting(host);
     registerHideWordRibbonInPortraitModeSetting(host);
     registerAutoRepeatBehaviour(host);
+    registerSwipeTypingSetting(host);
 
     // Setting layout orientation depends on word engine and hide word ribbon
     // settings to be initialized first:
@@ -563,9 +618,9 @@ void InputMethod::registerWordEngineSetting(MAbstractInputMethodHost *host)
             this,                           SLOT(onWordEngineSettingChanged()));
 
 #ifndef DISABLE_PREEDIT
-    d->editor.wordEngine()->setEnabled(d->settings.word_engine->value().toBool());
+    d->word_engine->setEnabled(d->settings.word_engine->value().toBool());
 #else
-    d->editor.wordEngine()->setEnabled(false);
+    d->word_engine->setEnabled(false);
 #endif
 }
 
@@ -609,6 +664,31 @@ void InputMethod::registerAutoRepeatBehaviour(MAbstractInputMethodHost *host)
 }
 
 
+void InputMethod::registerSwipeTypingSetting(MAbstractInputMethodHost *host)
+{
+    Q_D(InputMethod);
+
+    // Only offered if the word engine can decode swipes. Swiping takes over
+    // horizontal flicks on letter keys, see Keyboard.qml:
+    if (not d->word_engine->supportsSwipe()) {
+        return;
+    }
+
+    QVariantMap attributes;
+    attributes[Maliit::SettingEntryAttributes::defaultValue] = false;
+
+    d->settings.swipe_typing.reset(host->registerPluginSetting("swipe_typing_enabled",
+                                                               QT_TR_NOOP("Swipe typing enabled (flick from space to switch layouts)"),
+                                                               Maliit::BoolType,
+                                                               attributes));
+
+    connect(d->settings.swipe_typing.data(), SIGNAL(valueChanged()),
+            this,                            SLOT(onSwipeTypingSettingChanged()));
+
+    d->syncSwipeTyping();
+}
+
+
 void InputMethod::onLeftLayoutSelected()
 {
     // This API smells real bad.
@@ -651,6 +731,7 @@ void InputMethod::onStyleSettingChanged()
     d->layout.model.setImageDirectory(d->style->directory(Style::Images));
     d->extended_layout.model.setImageDirectory(d->style->directory(Style::Images));
     d->magnifier_layout.setImageDirectory(d->style->directory(Style::Images));
+    d->syncMaxCandidates(d->layout.helper.orientation());
 }
 
 void InputMethod::onKeyboardClosed()
@@ -699,6 +780,25 @@ void InputMethod::onAutoRepeatBehaviourChanged()
                                      list.length() > 1 ? list.at(1).toInt() : AutoRepeatIntervalDefault);
 }
 
+void InputMethod::onSwipeTypingSettingChanged()
+{
+    Q_D(InputMethod);
+    d->syncSwipeTyping();
+}
+
+void InputMethod::onKeyboardLanguageChanged(const QString &language)
+{
+    Q_D(InputMethod);
+
+    d->word_engine->setActiveLanguage(language);
+    d->conversion_engine.setActiveLanguage(language);
+
+    // Chinese layouts only type input codes, which always need conversion,
+    // regardless of the word engine setting:
+    d->editor.setWordEngine(d->conversion_engine.isEnabled() ? &d->conversion_engine : 0);
+    d->syncSwipeTyping();
+}
+
 
 void InputMethod::setKeyOverrides(const QMap<QString, QSharedPointer<MKeyOverride> > &overrides)
 {
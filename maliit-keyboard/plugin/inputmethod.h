@@ -81,6 +81,7 @@ private:
     void registerWordEngineSetting(MAbstractInputMethodHost *host);
     void registerHideWordRibbonInPortraitModeSetting(MAbstractInputMethodHost *host);
     void registerAutoRepeatBehaviour(MAbstractInputMethodHost *host);
+    void registerSwipeTypingSetting(MAbstractInputMethodHost *host);
 
     Q_SLOT void onScreenSizeChange(const QRect &rect);
     Q_SLOT void onStyleSettingChanged();
@@ -91,6 +92,8 @@ private:
     Q_SLOT void onWordEngineSettingChanged();
     Q_SLOT void onHideWordRibbonInPortraitModeSettingChanged();
     Q_SLOT void onAutoRepeatBehaviourChanged();
+    Q_SLOT void onSwipeTypingSettingChanged();
+    Q_SLOT void onKeyboardLanguageChanged(const QString &language);
     Q_SLOT void updateKey(const QString &key_id,
                           const MKeyOverride::KeyOverrideAttributes changed_attributes);
 
@@ -32,6 +32,7 @@
 #include "updatenotifier.h"
 
 #include <maliit/plugins/updateevent.h>
+#include <maliit/namespace.h>
 
 namespace MaliitKeyboard {
 
@@ -42,6 +43,20 @@ const char* const g_surrounding_text_property("surroundingText");
 const char* const g_cursor_position_property("cursorPosition");
 const char* const g_anchor_position_property("anchorPosition");
 const char* const g_has_selection("hasSelection");
+const char* const g_content_type_property("contentType");
+
+MaliitKeyboard::Model::Text::ContentType contentType(int maliit_content_type)
+{
+    using MaliitKeyboard::Model::Text;
+
+    switch (maliit_content_type) {
+    case Maliit::NumberContentType: return Text::NumberContent;
+    case Maliit::PhoneNumberContentType: return Text::PhoneNumberContent;
+    case Maliit::EmailContentType: return Text::EmailContent;
+    case Maliit::UrlContentType: return Text::UrlContent;
+    default: return Text::FreeTextContent;
+    }
+}
 
 } // unnamed namespace
 
@@ -71,6 +86,10 @@ void UpdateNotifier::notify(MImUpdateEvent* event)
 
     const QStringList properties_changed(event->propertiesChanged());
 
+    if (properties_changed.contains(g_content_type_property)) {
+        Q_EMIT contentTypeChanged(contentType(event->value(g_content_type_property).toInt()));
+    }
+
     if (properties_changed.contains(g_has_selection)) {
         const bool has_selection(event->value(g_has_selection).toBool());
 
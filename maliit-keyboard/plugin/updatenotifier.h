@@ -36,6 +36,7 @@
 #include <maliit/plugins/keyoverride.h>
 
 #include "logic/layouthelper.h"
+#include "models/text.h"
 
 class MImUpdateEvent;
 
@@ -61,6 +62,7 @@ public:
 
     Q_SIGNAL void cursorPositionChanged(int cursor_position,
                                         const QString &surrounding_text);
+    Q_SIGNAL void contentTypeChanged(Model::Text::ContentType content_type);
     Q_SIGNAL void keysOverriden(const Logic::KeyOverrides &overriden_keys,
                                 bool update);
 
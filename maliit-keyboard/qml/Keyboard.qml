@@ -105,6 +105,7 @@ Item {
             MouseArea {
                 property real start_x
                 property real start_y
+                property bool swiping: false
 
                 Timer {
                     id: gesture_timeout
@@ -126,17 +127,44 @@ Item {
                     event_handler.onPressed(index)
                 }
 
-                onReleased: event_handler.onReleased(index)
+                onReleased: {
+                    if (swiping) {
+                        swiping = false
+                        event_handler.onSwipeFinished()
+                    } else {
+                        event_handler.onReleased(index)
+                    }
+                }
+
                 onPressAndHold: event_handler.onPressAndHold(index)
 
                 // TODO: Move logic into EventHandler because gestures should depend on style?
                 // Hide keyboard on flick-down gesture (but only if there is an event_handler)
-                // or switch to left/right layout:
+                // or switch to left/right layout. With swipe typing, sliding
+                // off a key by half its size starts a swipe instead. Paths are
+                // streamed in key area coordinates. Flicking down still hides
+                // the keyboard and cancels the swipe, but horizontal flicks
+                // cannot be told apart from swiped words, so they only switch
+                // layouts from keys that do not start a swipe, such as space:
                 onPositionChanged: {
                     if (event_handler
                         && gesture_timeout.running
                         && (mouse.y - start_y > (layout.height * 0.3))) {
+                        if (swiping) {
+                            swiping = false
+                            event_handler.onSwipeCancelled()
+                        }
+
                         maliit.hide()
+                    } else if (swiping) {
+                        event_handler.onSwipeMoved(parent.x + mouse.x, parent.y + mouse.y)
+                    } else if (event_handler
+                               && event_handler.swipeEnabled
+                               && (Math.abs(mouse.x - start_x) > width / 2
+                                   || Math.abs(mouse.y - start_y) > height / 2)
+                               && event_handler.onSwipeStarted(index, parent.x + start_x, parent.y + start_y)) {
+                        swiping = true
+                        event_handler.onSwipeMoved(parent.x + mouse.x, parent.y + mouse.y)
                     } else if (event_handler
                                && gesture_timeout.running
                                && (mouse.x - start_x > (layout.width * 0.2))) {
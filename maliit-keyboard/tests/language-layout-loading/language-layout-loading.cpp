@@ -37,9 +37,12 @@
 #include "models/keyboard.h"
 #include "models/styleattributes.h"
 #include "logic/keyboardloader.h"
+#include "logic/layoutmanifest.h"
 #include "logic/keyareaconverter.h"
 #include "logic/style.h"
 #include "logic/layouthelper.h"
+#include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
 
 #include <QtCore>
 #include <QtTest>
@@ -206,6 +209,99 @@ Key getKey(const QString &text,
     return key;
 }
 
+void describeRows(const TagRowPtrs &rows,
+                  QStringList *description);
+
+void describeBinding(const TagBindingPtr &binding,
+                     QStringList *description)
+{
+    if (not binding) {
+        description->append("no binding");
+        return;
+    }
+
+    description->append(QString("binding %1 '%2' '%3' '%4' '%5' '%6' %7%8%9%10")
+                        .arg(binding->action())
+                        .arg(binding->label())
+                        .arg(binding->accents())
+                        .arg(binding->accented_labels())
+                        .arg(binding->sequence())
+                        .arg(binding->icon())
+                        .arg(binding->dead())
+                        .arg(binding->quick_pick())
+                        .arg(binding->rtl())
+                        .arg(binding->enlarge()));
+
+    Q_FOREACH (const TagModifiersPtr &modifiers, binding->modifiers()) {
+        description->append(QString("modifiers %1").arg(modifiers->keys()));
+        describeBinding(modifiers->binding(), description);
+    }
+}
+
+void describeRows(const TagRowPtrs &rows,
+                  QStringList *description)
+{
+    Q_FOREACH (const TagRowPtr &row, rows) {
+        description->append(QString("row %1").arg(row->height()));
+
+        Q_FOREACH (const TagRowElementPtr &element, row->elements()) {
+            if (element->element_type() == TagRowElement::Spacer) {
+                description->append("spacer");
+                continue;
+            }
+
+            const TagKeyPtr key(element.staticCast<TagKey>());
+
+            description->append(QString("key %1 %2 %3 '%4'")
+                                .arg(key->style())
+                                .arg(key->width())
+                                .arg(key->rtl())
+                                .arg(key->id()));
+            describeBinding(key->binding(), description);
+
+            if (key->extended()) {
+                description->append("extended");
+                describeRows(key->extended()->rows(), description);
+            }
+        }
+    }
+}
+
+// Flattens a tag tree, so that trees can be compared.
+QStringList describeTags(const TagKeyboardPtr &keyboard)
+{
+    QStringList description;
+
+    if (not keyboard) {
+        return description;
+    }
+
+    description.append(QString("keyboard '%1' '%2' '%3' '%4' %5")
+                       .arg(keyboard->version())
+                       .arg(keyboard->title())
+                       .arg(keyboard->language())
+                       .arg(keyboard->catalog())
+                       .arg(keyboard->autocapitalization()));
+
+    Q_FOREACH (const TagLayoutPtr &layout, keyboard->layouts()) {
+        description.append(QString("layout %1 %2 %3")
+                           .arg(layout->type())
+                           .arg(layout->orientation())
+                           .arg(layout->uniform_font_size()));
+
+        Q_FOREACH (const TagSectionPtr &section, layout->sections()) {
+            description.append(QString("section '%1' %2 %3 '%4'")
+                               .arg(section->id())
+                               .arg(section->movable())
+                               .arg(section->type())
+                               .arg(section->style()));
+            describeRows(section->rows(), &description);
+        }
+    }
+
+    return description;
+}
+
 } // unnamed namespace
 
 class TestLanguageLayoutLoading
@@ -552,6 +648,197 @@ private:
         COMPARE_KEYBOARDS(loader->extendedKeyboard(pressed_key), stringToKeyboard(expected_keyboard));
     }
 
+    Q_SLOT void testLayoutCache()
+    {
+        KeyboardLoader::clearCache();
+
+        KeyboardLoader::CacheStatistics statistics(KeyboardLoader::cacheStatistics());
+        QCOMPARE(statistics.hits, 0);
+        QCOMPARE(statistics.misses, 0);
+        QCOMPARE(statistics.entries, 0);
+
+        // Activation parses the layout and its symbols, number and phone
+        // number imports once.
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+
+        statistics = KeyboardLoader::cacheStatistics();
+        QCOMPARE(statistics.misses, 4);
+        QCOMPARE(statistics.entries, 4);
+
+        // Shifted, dead and imported keyboards are looked up, not rebuilt.
+        const int hits(statistics.hits);
+        Key dead_key;
+        Label dead_label;
+
+        dead_label.setText(";");
+        dead_key.setLabel(dead_label);
+
+        loader->keyboard();
+        loader->shiftedKeyboard();
+        loader->deadKeyboard(dead_key);
+        loader->shiftedDeadKeyboard(dead_key);
+        loader->symbolsKeyboard(1);
+        loader->numberKeyboard();
+
+        statistics = KeyboardLoader::cacheStatistics();
+        QCOMPARE(statistics.hits, hits);
+        QCOMPARE(statistics.misses, 4);
+
+        // Activating the same layout again only validates the cached files.
+        SharedKeyboardLoader other_loader(getLoader("general_test1"));
+
+        statistics = KeyboardLoader::cacheStatistics();
+        QVERIFY(statistics.hits > hits);
+        QCOMPARE(statistics.misses, 4);
+        QCOMPARE(statistics.entries, 4);
+        COMPARE_KEYBOARDS(other_loader->keyboard(), loader->keyboard());
+
+        KeyboardLoader::clearCache();
+        statistics = KeyboardLoader::cacheStatistics();
+        QCOMPARE(statistics.entries, 0);
+    }
+
+    Q_SLOT void testLayoutVariants()
+    {
+        SharedKeyboardLoader loader(getLoader("general_test1"));
+        const LayoutVariantSet &variants(loader->variants());
+        QStringList accents(variants.dead.keys());
+        QStringList expected_accents;
+
+        accents.sort();
+        expected_accents << QString::fromUtf8("´") << ";" << "'";
+        expected_accents.sort();
+
+        QCOMPARE(accents, expected_accents);
+        QCOMPARE(variants.shifted_dead.size(), expected_accents.size());
+        QCOMPARE(variants.symbols.size(), 2);
+        COMPARE_KEYBOARDS(variants.shifted, loader->shiftedKeyboard());
+
+        // Labels without accents give back the plain variants.
+        Key dead_key;
+        Label dead_label;
+
+        dead_label.setText("x");
+        dead_key.setLabel(dead_label);
+        COMPARE_KEYBOARDS(loader->deadKeyboard(dead_key), variants.base);
+        COMPARE_KEYBOARDS(loader->shiftedDeadKeyboard(dead_key), variants.shifted);
+    }
+
+    Q_SLOT void testLayoutManifest()
+    {
+        QTemporaryDir cache_dir;
+        QVERIFY(cache_dir.isValid());
+
+        const QString languages_dir(QString::fromLatin1(TEST_DATADIR) + "/languages");
+        const QString cache_file(cache_dir.path() + "/layouts.manifest");
+        QStringList expected_ids;
+
+        expected_ids << "action_test1" << "action_test2" << "action_test3"
+                     << "extended_test" << "general_test1"
+                     << "icon_test1" << "icon_test2" << "icon_test3"
+                     << "styling_profile_test";
+
+        LayoutManifest built(languages_dir, cache_file);
+        QVERIFY(not built.isFromCache());
+        QVERIFY(QFile::exists(cache_file));
+        QCOMPARE(built.ids(), expected_ids);
+        QVERIFY(not built.contains("general_test1_numbers"));
+        QVERIFY(not built.contains("style_test1"));
+
+        LayoutManifest loaded(languages_dir, cache_file);
+        QVERIFY(loaded.isFromCache());
+        QVERIFY(not loaded.update());
+        QCOMPARE(loaded.ids(), expected_ids);
+
+        const LayoutManifest::Entry entry(loaded.entry("general_test1"));
+        QCOMPARE(entry.title, QString("GeneralTest1"));
+        QCOMPARE(entry.language, QString("general_test1"));
+        QCOMPARE(entry.symviews, QStringList() << "general_test1_symbols.xml");
+        QCOMPARE(entry.numbers, QStringList() << "general_test1_numbers.xml");
+        QCOMPARE(entry.phonenumbers, QStringList() << "general_test1_phonenumbers.xml");
+
+        KeyboardLoader loader;
+        QCOMPARE(loader.ids(), expected_ids);
+        QCOMPARE(loader.title("general_test1"), QString("GeneralTest1"));
+    }
+
+    Q_SLOT void testLayoutManifestUpdate()
+    {
+        QTemporaryDir languages_dir;
+        QTemporaryDir cache_dir;
+        QVERIFY(languages_dir.isValid());
+        QVERIFY(cache_dir.isValid());
+
+        const QString layout_file(languages_dir.path() + "/general_test1.xml");
+        const QString cache_file(cache_dir.path() + "/layouts.manifest");
+        QVERIFY(QFile::copy(QString::fromLatin1(TEST_DATADIR) + "/languages/general_test1.xml",
+                            layout_file));
+
+        LayoutManifest manifest(languages_dir.path(), cache_file);
+        QCOMPARE(manifest.ids(), QStringList() << "general_test1");
+        QCOMPARE(manifest.entry("general_test1").title, QString("GeneralTest1"));
+
+        // Editing a layout in place keeps the modification time of the
+        // directory, but must not leave a stale entry:
+        QFile file(layout_file);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        QByteArray contents(file.readAll());
+        file.close();
+        contents.replace("title=\"GeneralTest1\"", "title=\"GeneralTest1Edited\"");
+        QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+        QCOMPARE(file.write(contents), qint64(contents.size()));
+        file.close();
+
+        QVERIFY(manifest.update());
+        QCOMPARE(manifest.entry("general_test1").title, QString("GeneralTest1Edited"));
+        QVERIFY(not manifest.update());
+
+        LayoutManifest loaded(languages_dir.path(), cache_file);
+        QVERIFY(loaded.isFromCache());
+        QCOMPARE(loaded.entry("general_test1").title, QString("GeneralTest1Edited"));
+
+        // Removed layouts are dropped:
+        QVERIFY(QFile::remove(layout_file));
+        QVERIFY(loaded.update());
+        QCOMPARE(loaded.ids(), QStringList());
+    }
+
+    Q_SLOT void testCompiledLayout_data()
+    {
+        QTest::addColumn<QString>("keyboard_id");
+
+        QTest::newRow("General test") << "general_test1";
+        QTest::newRow("Extended keys") << "extended_test";
+        QTest::newRow("Icons") << "icon_test2";
+        QTest::newRow("Style") << "style_test2";
+    }
+
+    Q_SLOT void testCompiledLayout()
+    {
+        QFETCH(QString, keyboard_id);
+
+        QFile file(QString::fromLatin1(TEST_DATADIR) + "/languages/" + keyboard_id + ".xml");
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        LayoutParser parser(&file);
+        QVERIFY(parser.parse());
+
+        const QByteArray blob(LayoutBlob::compile(parser));
+        QVERIFY(not blob.isEmpty());
+
+        LayoutBlobReader reader(reinterpret_cast<const uchar *>(blob.constData()), blob.size());
+        QVERIFY(reader.read());
+        QCOMPARE(reader.imports(), parser.imports());
+        QCOMPARE(reader.symviews(), parser.symviews());
+        QCOMPARE(reader.numbers(), parser.numbers());
+        QCOMPARE(reader.phonenumbers(), parser.phonenumbers());
+        QCOMPARE(describeTags(reader.keyboard()), describeTags(parser.keyboard()));
+
+        LayoutBlobReader truncated_reader(reinterpret_cast<const uchar *>(blob.constData()), blob.size() - 4);
+        QVERIFY(not truncated_reader.read());
+        QVERIFY(not truncated_reader.keyboard());
+    }
+
     Q_SLOT void testStylingProfile()
     {
         const Logic::LayoutHelper::Orientation orientation(Logic::LayoutHelper::Landscape);
@@ -579,6 +866,47 @@ private:
         QCOMPARE(style.directory(Style::Sounds), test_profile_dir + "/sounds");
     }
 
+    Q_SLOT void testResolvedStyle()
+    {
+        const QString main_file_name(QString::fromLatin1(TEST_MALIIT_KEYBOARD_DATADIR)
+                                     + "/styles/test-profile/main.ini");
+        const QSettings store(main_file_name, QSettings::IniFormat);
+        StyleAttributes attributes(new QSettings(main_file_name, QSettings::IniFormat));
+
+        // Resolved values must match what the INI file contains, for known
+        // and unknown style names alike.
+        QStringList style_names;
+        style_names << QString() << "default" << "invalid_style_name";
+
+        Q_FOREACH (const QString &style_name, style_names) {
+            attributes.setStyleName(style_name);
+            QCOMPARE(attributes.styleName(), style_name);
+
+            QCOMPARE(attributes.fontSize(Logic::LayoutHelper::Landscape),
+                     store.value("default/landscape/font-size").toReal());
+            QCOMPARE(attributes.fontSize(Logic::LayoutHelper::Portrait),
+                     store.value("default/portrait/font-size").toReal());
+            QCOMPARE(attributes.fontColor(Logic::LayoutHelper::Portrait),
+                     store.value("default/portrait/font-color").toByteArray());
+            QCOMPARE(attributes.keyWidth(Logic::LayoutHelper::Landscape, KeyDescription::XLarge),
+                     store.value("default/landscape/key-width-xlarge").toReal());
+            QCOMPARE(attributes.keyWidth(Logic::LayoutHelper::Portrait, KeyDescription::Medium),
+                     store.value("default/portrait/key-width").toReal());
+            QCOMPARE(attributes.keyMargin(Logic::LayoutHelper::Landscape),
+                     store.value("default/landscape/key-margins").toReal());
+            QCOMPARE(attributes.fontName(Logic::LayoutHelper::Landscape), QByteArray("Nokia Pure"));
+        }
+
+        QCOMPARE(attributes.keyBackground(Key::StyleNormalKey, KeyDescription::PressedState),
+                 store.value("background/normal-pressed").toByteArray());
+        QCOMPARE(attributes.keyBackgroundBorders(), QMargins(2, 2, 2, 2));
+        QCOMPARE(attributes.icon(KeyDescription::ShiftLatchedIcon, KeyDescription::NormalState),
+                 store.value("icon/shift-latched").toByteArray());
+        QCOMPARE(attributes.customIcon("square-smiley"), store.value("icon/square-smiley").toByteArray());
+        QCOMPARE(attributes.customIcon("invalid_icon_name"), QByteArray());
+        QCOMPARE(attributes.keyPressSound(), store.value("sound/key-press").toByteArray());
+    }
+
     Q_SLOT void testKeyGeometryStyling_data()
     {
         QTest::addColumn<int>("key_index");
@@ -33,6 +33,7 @@
 #include "utils.h"
 #include "models/key.h"
 #include "models/keyarea.h"
+#include "logic/hitlogic.h"
 #include "logic/layouthelper.h"
 #include "plugin/editor.h"
 #include "logic/layoutupdater.h"
@@ -45,6 +46,32 @@
 
 using namespace MaliitKeyboard;
 
+namespace {
+
+// Reference for Logic::keyHit(): the first key in the list that contains pos
+// and passes the filter.
+Key linearKeyHit(const QVector<Key> &keys,
+                 const QRect &geometry,
+                 const QPoint &pos,
+                 const QVector<Key> &filtered_keys,
+                 Logic::FilterBehaviour behaviour)
+{
+    if (not geometry.contains(pos)) {
+        return Key();
+    }
+
+    Q_FOREACH (const Key &key, keys) {
+        if (key.rect().contains(pos - geometry.topLeft())
+            && (filtered_keys.contains(key) == (behaviour == Logic::AcceptIfInFilter))) {
+            return key;
+        }
+    }
+
+    return Key();
+}
+
+} // namespace
+
 class TestLanguageLayoutSwitching
     : public QObject
 {
@@ -86,6 +113,138 @@ private:
         QCOMPARE(layout.activeKeyArea().keys().count(), expected_key_count);
     }
 
+    Q_SLOT void testKeyAreaCache_data()
+    {
+        QTest::addColumn<int>("budget");
+
+        QTest::newRow("Default budget") << -1;
+        QTest::newRow("Cache disabled") << 0;
+    }
+
+    Q_SLOT void testKeyAreaCache()
+    {
+        QFETCH(int, budget);
+
+        Logic::LayoutUpdater layout_updater;
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        if (budget >= 0) {
+            layout_updater.setKeyAreaCacheBudget(budget);
+            QCOMPARE(layout_updater.keyAreaCacheBudget(), budget);
+        } else {
+            QVERIFY(layout_updater.keyAreaCacheBudget() > 0);
+        }
+
+        layout_updater.setActiveKeyboardId("en_gb");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        const KeyArea first(layout.centerPanel());
+
+        layout_updater.setActiveKeyboardId("de");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+
+        // Switching back is served from the cache, unless it is disabled.
+        layout_updater.setActiveKeyboardId("en_gb");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        const KeyArea second(layout.centerPanel());
+
+        QCOMPARE(second.keys().count(), first.keys().count());
+        QCOMPARE(second.rect(), first.rect());
+
+        for (int index(0); index < first.keys().count(); ++index) {
+            QCOMPARE(second.keys().at(index).label().text(), first.keys().at(index).label().text());
+            QCOMPARE(second.keys().at(index).rect(), first.keys().at(index).rect());
+        }
+
+        // Changing the style profile must not serve stale key areas.
+        style->setProfile(style->profile());
+        layout_updater.setActiveKeyboardId("de");
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QCOMPARE(layout.activeKeyArea().keys().count(), 36);
+    }
+
+    Q_SLOT void testAsynchronousLayouts()
+    {
+        Logic::LayoutUpdater layout_updater;
+        layout_updater.setAsynchronous(true);
+        QVERIFY(layout_updater.isAsynchronous());
+
+        Logic::LayoutHelper layout(new Logic::LayoutHelper);
+        layout_updater.setLayout(&layout);
+
+        SharedStyle style(new Style);
+        layout_updater.setStyle(style);
+
+        // The requested layout is reported right away, but only swapped in
+        // once it got loaded.
+        layout_updater.setActiveKeyboardId("en_gb");
+        QCOMPARE(layout_updater.activeKeyboardId(), QString("en_gb"));
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QCOMPARE(layout.activeKeyArea().keys().count(), 33);
+
+        // Superseded requests are dropped, only the latest one is shown.
+        layout_updater.setActiveKeyboardId("de");
+        layout_updater.setActiveKeyboardId("invalid_language_layout_id");
+        layout_updater.setActiveKeyboardId("de");
+        layout_updater.waitForLayout();
+        QCOMPARE(layout_updater.activeKeyboardId(), QString("de"));
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QCOMPARE(layout.activeKeyArea().keys().count(), 36);
+
+        // Switching to synchronous mode activates the pending layout.
+        layout_updater.setActiveKeyboardId("en_gb");
+        layout_updater.setAsynchronous(false);
+        QCOMPARE(layout_updater.activeKeyboardId(), QString("en_gb"));
+        TestUtils::waitForSignal(&layout, SIGNAL(centerPanelChanged(KeyArea,Logic::KeyOverrides)));
+        QCOMPARE(layout.activeKeyArea().keys().count(), 33);
+    }
+
+    Q_SLOT void testKeyHit()
+    {
+        // Keys of varying width, overlapping their neighbours and the row
+        // below, plus a wide key covering the middle of both rows:
+        QVector<Key> keys;
+
+        for (int row = 0; row < 2; ++row) {
+            for (int column = 0; column < 8; ++column) {
+                Key key;
+                key.rLabel().setText(QString("%1%2").arg(row).arg(column));
+                key.setOrigin(QPoint(column * 10 + row * 5, row * 8));
+                key.rArea().setSize(QSize(12 + column % 3, 10));
+                keys.append(key);
+            }
+        }
+
+        Key wide;
+        wide.rLabel().setText("wide");
+        wide.setOrigin(QPoint(20, 4));
+        wide.rArea().setSize(QSize(40, 8));
+        keys.append(wide);
+
+        QVector<Key> filtered;
+        filtered << keys.at(2) << keys.at(11) << wide;
+
+        const QRect geometry(5, 5, 100, 30);
+
+        for (int behaviour = Logic::IgnoreIfInFilter; behaviour <= Logic::AcceptIfInFilter; ++behaviour) {
+            for (int y = 0; y < 40; ++y) {
+                for (int x = 0; x < 110; ++x) {
+                    const QPoint pos(x, y);
+                    const Logic::FilterBehaviour filter_behaviour(static_cast<Logic::FilterBehaviour>(behaviour));
+
+                    QCOMPARE(Logic::keyHit(keys, geometry, pos, filtered, filter_behaviour),
+                             linearKeyHit(keys, geometry, pos, filtered, filter_behaviour));
+                    QCOMPARE(Logic::keyHit(keys, geometry, pos, QVector<Key>(), filter_behaviour),
+                             linearKeyHit(keys, geometry, pos, QVector<Key>(), filter_behaviour));
+                }
+            }
+        }
+    }
+
     // This test is very trivial. It's required however because none of the
     // current mainline layouts feature layout switch keys, thus making
     // regressions impossible to spot.
@@ -205,6 +205,34 @@ private:
         QCOMPARE(host.commitStringHistory(), expected_commit_history);
         QCOMPARE(auto_caps_activated_spy.count(), expected_auto_caps_activated_count);
     }
+
+    Q_SLOT void testContentTypeChange()
+    {
+        Logic::WordEngineProbe *word_engine = new Logic::WordEngineProbe;
+        Editor editor(new Model::Text, word_engine, new Logic::LanguageFeatures);
+        QSignalSpy spy(&editor, SIGNAL(wordCandidatesChanged(WordCandidateList)));
+
+        InputMethodHostProbe host;
+        editor.setHost(&host);
+
+        initializeWordEngine(word_engine);
+
+        editor.wordEngine()->setEnabled(true);
+        editor.setPreeditEnabled(true);
+
+        appendInput(&editor, "Hel");
+        QCOMPARE(editor.text()->preedit(), QString("Hel"));
+        spy.clear();
+
+        // The focus moved to another field already, which must not get the
+        // preedit of the previous one:
+        editor.setContentType(Model::Text::UrlContent);
+        QCOMPARE(editor.text()->preedit(), QString());
+        QCOMPARE(editor.text()->contentType(), Model::Text::UrlContent);
+        QCOMPARE(host.commitStringHistory(), QString());
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().first().value<WordCandidateList>(), WordCandidateList());
+    }
 };
 
 QTEST_MAIN(TestEditor)
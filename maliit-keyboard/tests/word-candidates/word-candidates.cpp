@@ -36,7 +36,21 @@
 #include "plugin/editor.h"
 #include "models/key.h"
 #include "models/text.h"
+#include "logic/addressindex.h"
+#include "logic/cachingpredictionbackend.h"
+#include "logic/candidateranker.h"
+#include "logic/chineselexicon.h"
+#include "logic/chinesewordengine.h"
+#include "logic/conversionlattice.h"
+#include "logic/dawg.h"
+#include "logic/dawgwordengine.h"
 #include "logic/languagefeatures.h"
+#include "logic/ngrammodel.h"
+#include "logic/proximitycorrector.h"
+#include "logic/spellchecker.h"
+#include "logic/swipedecoder.h"
+#include "logic/userdictionary.h"
+#include "logic/wordenginebackend.h"
 #include "logic/layouthelper.h"
 #include "logic/layoutupdater.h"
 #include "logic/style.h"
@@ -68,6 +82,178 @@ void enforceCommit(Editor *editor)
     editor->onKeyReleased(space);
 }
 
+
+// Two rows of 10x10 keys, the second one shifted by half a key.
+KeyArea createKeyArea()
+{
+    const QString rows[] = {"qwertyuiop", "asdfghjkl"};
+    QVector<Key> keys;
+
+    for (int row = 0; row < 2; ++row) {
+        for (int column = 0; column < rows[row].length(); ++column) {
+            Key key;
+            key.setAction(Key::ActionInsert);
+            key.rLabel().setText(rows[row].at(column));
+            key.setOrigin(QPoint(column * 10 + row * 5, row * 10));
+            key.rArea().setSize(QSize(10, 10));
+            keys.append(key);
+        }
+    }
+
+    KeyArea key_area;
+    key_area.setKeys(keys);
+    return key_area;
+}
+
+
+QPointF keyCenter(const KeyArea &key_area,
+                  const QChar &character)
+{
+    Q_FOREACH (const Key &key, key_area.keys()) {
+        if (key.label().text() == QString(character)) {
+            return QRectF(key.rect()).center();
+        }
+    }
+
+    return QPointF();
+}
+
+
+// Writes a tiny Hunspell dictionary into directory, and returns its path
+// without the .aff and .dic suffixes.
+QString writeDictionary(const QString &directory)
+{
+    const QString path(directory + "/test");
+
+    QFile aff(path + ".aff");
+    aff.open(QIODevice::WriteOnly);
+    aff.write("SET UTF-8\nTRY esianrtolcdugmphbyfvkwz\n");
+
+    QFile dic(path + ".dic");
+    dic.open(QIODevice::WriteOnly);
+    dic.write("3\nhello\nhelp\nworld\n");
+
+    return path;
+}
+
+
+// Predicts the last committed word, prefixed by "after-", as next word.
+class NextWordEngineProbe
+    : public Logic::WordEngineProbe
+{
+public:
+    virtual ~NextWordEngineProbe()
+    {
+        waitForCandidates();
+    }
+
+private:
+    virtual WordCandidateList fetchNextWordCandidates(Model::Text *text)
+    {
+        WordCandidateList result;
+
+        if (not text->context().isEmpty()) {
+            result.append(WordCandidate(WordCandidate::SourcePrediction,
+                                        "after-" + text->context().last()));
+        }
+
+        return result;
+    }
+};
+
+
+// Completes the preedit with a fixed suffix, after an optional delay.
+class CompletionBackend
+    : public Logic::WordEngineBackend
+{
+private:
+    const QString m_suffix;
+    const int m_cost;
+    const unsigned long m_delay;
+
+public:
+    explicit CompletionBackend(CostClass cost_class,
+                               const QString &suffix,
+                               int cost,
+                               unsigned long delay = 0)
+        : Logic::WordEngineBackend(cost_class)
+        , m_suffix(suffix)
+        , m_cost(cost)
+        , m_delay(delay)
+    {}
+
+    virtual Verdict fetchCandidates(const Model::Text &text,
+                                    Logic::CandidateRanker *ranker)
+    {
+        QThread::msleep(m_delay);
+        ranker->add(WordCandidate::SourcePrediction, text.preedit() + m_suffix, m_cost);
+        return NoVerdict;
+    }
+};
+
+
+// Predicts words of a fixed vocabulary, and counts how often it got asked.
+class CountingPredictionBackend
+    : public Logic::CachingPredictionBackend
+{
+public:
+    QStringList words;
+    int context_count;
+    int predict_count;
+
+    explicit CountingPredictionBackend()
+        : Logic::CachingPredictionBackend(Cheap)
+        , words()
+        , context_count(0)
+        , predict_count(0)
+    {}
+
+    virtual Verdict fetchCandidates(const Model::Text &,
+                                    Logic::CandidateRanker *)
+    {
+        return NoVerdict;
+    }
+
+protected:
+    virtual void setPredictionContext(const QStringList &)
+    {
+        ++context_count;
+    }
+
+    virtual QStringList predict(const QString &preedit,
+                                int pool_size)
+    {
+        ++predict_count;
+        QStringList result;
+
+        Q_FOREACH (const QString &word, words) {
+            if (result.count() < pool_size && word.startsWith(preedit)) {
+                result.append(word);
+            }
+        }
+
+        return result;
+    }
+};
+
+
+// Runs a cheap backend next to a slow, expensive one with better candidates.
+class BackendWordEngine
+    : public Logic::AbstractWordEngine
+{
+public:
+    explicit BackendWordEngine()
+    {
+        addBackend(new CompletionBackend(Logic::WordEngineBackend::Expensive, "p", 0, 200));
+        addBackend(new CompletionBackend(Logic::WordEngineBackend::Cheap, "lo", 1));
+    }
+
+    virtual ~BackendWordEngine()
+    {
+        waitForCandidates();
+    }
+};
+
 } // namespace
 
 class TestWordCandidates
@@ -196,6 +382,801 @@ private:
         QCOMPARE(host.commitStringHistory(), QString("ab c "));
     }
 
+    Q_SLOT void testAsynchronousPrediction()
+    {
+        Editor editor(new Model::Text, new Logic::WordEngineProbe, new Logic::LanguageFeatures);
+        QSignalSpy spy(&editor, SIGNAL(wordCandidatesChanged(WordCandidateList)));
+
+        InputMethodHostProbe host;
+        editor.setHost(&host);
+
+        editor.wordEngine()->setEnabled(true);
+        editor.wordEngine()->setAsynchronous(true);
+        QCOMPARE(editor.wordEngine()->isAsynchronous(), true);
+
+        // Candidates are delivered through the event loop, and only for the
+        // latest preedit:
+        appendToPreedit(&editor, "a");
+        appendToPreedit(&editor, "b");
+        appendToPreedit(&editor, "c");
+        QCOMPARE(spy.count(), 0);
+        QCOMPARE(editor.text()->primaryCandidate(), QString());
+
+        QTRY_COMPARE(spy.count(), 1);
+        QTest::qWait(50);
+        QCOMPARE(spy.count(), 1);
+
+        WordCandidateList expected_word_candidate_list;
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "cba"));
+        QCOMPARE(spy.first().first().value<WordCandidateList>(), expected_word_candidate_list);
+        QCOMPARE(editor.text()->primaryCandidate(), QString("cba"));
+        QCOMPARE(host.lastPreeditString(), QString("abc"));
+
+        // Results for a committed preedit are dropped:
+        appendToPreedit(&editor, "d");
+        enforceCommit(&editor);
+        QCOMPARE(spy.count(), 2);
+        QTest::qWait(50);
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(spy.last().first().value<WordCandidateList>(), WordCandidateList());
+        QCOMPARE(host.commitStringHistory(), QString("abcd "));
+    }
+
+    Q_SLOT void testNextWordPrediction()
+    {
+        Editor editor(new Model::Text, new NextWordEngineProbe, new Logic::LanguageFeatures);
+        QSignalSpy spy(&editor, SIGNAL(wordCandidatesChanged(WordCandidateList)));
+
+        InputMethodHostProbe host;
+        editor.setHost(&host);
+        editor.wordEngine()->setEnabled(true);
+
+        // Committing clears the candidates, then predicts the next word,
+        // without a primary candidate for auto-correction:
+        appendToPreedit(&editor, "a");
+        spy.clear();
+        enforceCommit(&editor);
+        QCOMPARE(spy.count(), 2);
+        QCOMPARE(spy.first().first().value<WordCandidateList>(), WordCandidateList());
+
+        WordCandidateList expected_word_candidate_list;
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "after-a"));
+        QCOMPARE(spy.last().first().value<WordCandidateList>(), expected_word_candidate_list);
+        QCOMPARE(editor.text()->primaryCandidate(), QString());
+
+        // Another space commits nothing:
+        enforceCommit(&editor);
+        QCOMPARE(host.commitStringHistory(), QString("a  "));
+
+        // Predictions get computed in the background:
+        editor.wordEngine()->setAsynchronous(true);
+        appendToPreedit(&editor, "b");
+        QTRY_COMPARE(editor.text()->primaryCandidate(), QString("b"));
+        spy.clear();
+        enforceCommit(&editor);
+        QCOMPARE(spy.count(), 1);
+        QTRY_COMPARE(spy.count(), 2);
+
+        expected_word_candidate_list.clear();
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "after-b"));
+        QCOMPARE(spy.last().first().value<WordCandidateList>(), expected_word_candidate_list);
+
+        // ... and get dropped once typing the next word starts:
+        appendToPreedit(&editor, "c");
+        enforceCommit(&editor);
+        appendToPreedit(&editor, "d");
+        spy.clear();
+        QTRY_COMPARE(spy.count(), 1);
+        QTest::qWait(50);
+        QCOMPARE(spy.count(), 1);
+
+        expected_word_candidate_list.clear();
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "d"));
+        QCOMPARE(spy.last().first().value<WordCandidateList>(), expected_word_candidate_list);
+        QCOMPARE(host.commitStringHistory(), QString("a  b c "));
+
+        // Dropped predictions do not count as coalesced requests:
+        const Logic::AbstractWordEngine::SchedulerStatistics
+            statistics(editor.wordEngine()->schedulerStatistics());
+        QCOMPARE(statistics.requests, statistics.coalesced + statistics.computations);
+    }
+
+    Q_SLOT void testCoalescing()
+    {
+        Editor editor(new Model::Text, new Logic::WordEngineProbe, new Logic::LanguageFeatures);
+        QSignalSpy spy(&editor, SIGNAL(wordCandidatesChanged(WordCandidateList)));
+
+        InputMethodHostProbe host;
+        editor.setHost(&host);
+
+        Logic::AbstractWordEngine *const engine(editor.wordEngine());
+        engine->setEnabled(true);
+        engine->setCoalescing(50, 0);
+        QCOMPARE(engine->quietPeriod(), 50);
+        QCOMPARE(engine->maxLatency(), 0);
+
+        // Fast typing: only the latest preedit gets computed, once typing
+        // pauses.
+        appendToPreedit(&editor, "a");
+        appendToPreedit(&editor, "b");
+        appendToPreedit(&editor, "c");
+        QCOMPARE(spy.count(), 0);
+
+        QTRY_COMPARE(spy.count(), 1);
+        QCOMPARE(editor.text()->primaryCandidate(), QString("cba"));
+
+        Logic::AbstractWordEngine::SchedulerStatistics statistics(engine->schedulerStatistics());
+        QCOMPARE(statistics.requests, 3);
+        QCOMPARE(statistics.coalesced, 2);
+        QCOMPARE(statistics.computations, 1);
+
+        // Continuous typing: the latency cap forces computations before
+        // typing pauses.
+        enforceCommit(&editor);
+        engine->resetSchedulerStatistics();
+        engine->setCoalescing(1000, 100);
+        spy.clear();
+
+        for (int count = 0; count < 10; ++count) {
+            appendToPreedit(&editor, "x");
+            QTest::qWait(30);
+        }
+
+        statistics = engine->schedulerStatistics();
+        QCOMPARE(statistics.requests, 10);
+        QVERIFY(statistics.computations >= 1);
+        QCOMPARE(spy.count(), statistics.computations);
+
+        // Disabling coalescing computes the held back request right away:
+        engine->setCoalescing(0, 0);
+        statistics = engine->schedulerStatistics();
+        QCOMPARE(statistics.requests, statistics.coalesced + statistics.computations);
+        QCOMPARE(editor.text()->primaryCandidate(), QString(10, 'x'));
+    }
+
+    Q_SLOT void testCandidateRanker()
+    {
+        Logic::CandidateRanker ranker(3);
+        QCOMPARE(ranker.limit(), 3);
+
+        ranker.add(WordCandidate::SourcePrediction, "hello", 4);
+        ranker.add(WordCandidate::SourcePrediction, "help", 2);
+        ranker.add(WordCandidate::SourceSpellChecking, "hell", 2);
+        // Duplicates keep their lowest cost:
+        ranker.add(WordCandidate::SourceSpellChecking, "hello", 6);
+        ranker.add(WordCandidate::SourceSpellChecking, "help", 0);
+        QCOMPARE(ranker.count(), 3);
+
+        // Only the best candidates are kept, equal costs in order of adding:
+        ranker.add(WordCandidate::SourcePrediction, "helm", 5);
+        ranker.add(WordCandidate::SourcePrediction, "helium", 3);
+
+        WordCandidateList expected_word_candidate_list;
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourceSpellChecking, "help"));
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourceSpellChecking, "hell"));
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "helium"));
+        QCOMPARE(ranker.candidates(), expected_word_candidate_list);
+
+        // Discarded words make room for others:
+        ranker.discard(WordCandidate::SourceSpellChecking);
+        ranker.add(WordCandidate::SourcePrediction, "hello", 4);
+
+        expected_word_candidate_list.clear();
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "helium"));
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "hello"));
+        QCOMPARE(ranker.candidates(), expected_word_candidate_list);
+
+        Logic::WordEngineProbe engine;
+        QCOMPARE(engine.maxCandidates(), int(Logic::AbstractWordEngine::DefaultMaxCandidates));
+        engine.setMaxCandidates(5);
+        QCOMPARE(engine.maxCandidates(), 5);
+        engine.setMaxCandidates(0);
+        QCOMPARE(engine.maxCandidates(), int(Logic::AbstractWordEngine::DefaultMaxCandidates));
+    }
+
+    Q_SLOT void testWordEngineBackends()
+    {
+        BackendWordEngine engine;
+        QCOMPARE(engine.backends().count(), 2);
+        engine.setEnabled(true);
+
+        QSignalSpy spy(&engine, SIGNAL(candidatesChanged(WordCandidateList)));
+        Model::Text text;
+        text.setPreedit("hel");
+
+        WordCandidateList cheap_word_candidate_list;
+        cheap_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "hello"));
+
+        WordCandidateList expected_word_candidate_list;
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "help"));
+        expected_word_candidate_list.append(WordCandidate(WordCandidate::SourcePrediction, "hello"));
+
+        // Synchronous requests wait for all backends:
+        engine.computeCandidates(&text);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().first().value<WordCandidateList>(), expected_word_candidate_list);
+        QCOMPARE(text.primaryCandidate(), QString("help"));
+        QCOMPARE(text.preeditFace(), Model::Text::PreeditActive);
+
+        // Asynchronous requests show the cheap candidates first:
+        spy.clear();
+        engine.setAsynchronous(true);
+        engine.computeCandidates(&text);
+        QTRY_COMPARE(spy.count(), 2);
+        QCOMPARE(spy.first().first().value<WordCandidateList>(), cheap_word_candidate_list);
+        QCOMPARE(spy.last().first().value<WordCandidateList>(), expected_word_candidate_list);
+
+        // Natural language backends do not run in URL fields:
+        spy.clear();
+        engine.setAsynchronous(false);
+        text.setContentType(Model::Text::UrlContent);
+        engine.computeCandidates(&text);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().first().value<WordCandidateList>(), WordCandidateList());
+        QCOMPARE(text.preeditFace(), Model::Text::PreeditDefault);
+    }
+
+    Q_SLOT void testPredictionCache()
+    {
+        CountingPredictionBackend backend;
+        backend.words << "hello" << "help" << "helmet" << "hero" << "heron" << "hull" << "world";
+        const QStringList context(QStringList() << QString() << "say");
+
+        const QStringList h(backend.predictions(context, "h", 2));
+        QCOMPARE(h, QStringList() << "hello" << "help" << "helmet" << "hero" << "heron" << "hull");
+        QCOMPARE(backend.context_count, 1);
+        QCOMPARE(backend.predict_count, 1);
+
+        // Appending to the preedit filters the previous pool:
+        QCOMPARE(backend.predictions(context, "he", 2),
+                 QStringList() << "hello" << "help" << "helmet" << "hero" << "heron");
+        QCOMPARE(backend.predictions(context, "hel", 2),
+                 QStringList() << "hello" << "help" << "helmet");
+        QCOMPARE(backend.predict_count, 1);
+
+        // ... unless too few predictions are left:
+        QCOMPARE(backend.predictions(context, "helm", 2), QStringList() << "helmet");
+        QCOMPARE(backend.predict_count, 2);
+
+        // Backspace to a cached preedit does not ask the predictor:
+        QCOMPARE(backend.predictions(context, "hel", 2),
+                 QStringList() << "hello" << "help" << "helmet");
+        QCOMPARE(backend.predictions(context, "h", 2), h);
+        QCOMPARE(backend.predict_count, 2);
+        QCOMPARE(backend.context_count, 1);
+
+        // Another left context invalidates the cache:
+        const QStringList other_context(QStringList() << QString() << "hi");
+        backend.predictions(other_context, "hel", 2);
+        QCOMPARE(backend.context_count, 2);
+        QCOMPARE(backend.predict_count, 3);
+        backend.predictions(other_context, "hel", 2);
+        QCOMPARE(backend.predict_count, 3);
+
+        // So does another number of candidates:
+        backend.predictions(other_context, "hel", 3);
+        QCOMPARE(backend.context_count, 3);
+        QCOMPARE(backend.predict_count, 4);
+
+        // New user words drop the cache:
+        backend.words.prepend("helium");
+        backend.addToUserDictionary("helium");
+        QCOMPARE(backend.predictions(other_context, "hel", 3),
+                 QStringList() << "helium" << "hello" << "help" << "helmet");
+        QCOMPARE(backend.predict_count, 5);
+    }
+
+    Q_SLOT void testDawg()
+    {
+        QHash<QString, quint32> frequencies;
+        frequencies.insert("the", 100);
+        frequencies.insert("that", 80);
+        frequencies.insert("there", 50);
+        frequencies.insert("then", 20);
+        frequencies.insert("house", 10);
+        frequencies.insert("horse", 5);
+
+        const QByteArray data(Logic::Dawg::compile(frequencies));
+        Logic::DawgReader reader(reinterpret_cast<const uchar *>(data.constData()), data.size());
+        QVERIFY2(reader.isValid(), qPrintable(reader.errorString()));
+        QCOMPARE(reader.wordCount(), 6);
+        QCOMPARE(reader.frequency("the"), 100u);
+        QCOMPARE(reader.frequency("th"), 0u);
+        QCOMPARE(reader.frequency("houses"), 0u);
+
+        Logic::DawgMatchList matches(reader.complete("th", 3));
+        QCOMPARE(matches.size(), 3);
+        QCOMPARE(matches.at(0).word, QString("the"));
+        QCOMPARE(matches.at(1).word, QString("that"));
+        QCOMPARE(matches.at(2).word, QString("there"));
+        QCOMPARE(reader.complete("x", 3).isEmpty(), true);
+
+        matches = reader.lookup("hosue", 2, -1);
+        QCOMPARE(matches.size(), 2);
+        QCOMPARE(matches.at(0).word, QString("house"));
+        QCOMPARE(matches.at(0).distance, 1);
+        QCOMPARE(matches.at(1).word, QString("horse"));
+        QCOMPARE(matches.at(1).distance, 2);
+
+        QByteArray corrupted(data);
+        corrupted.chop(4);
+        Logic::DawgReader corrupted_reader(reinterpret_cast<const uchar *>(corrupted.constData()),
+                                           corrupted.size());
+        QCOMPARE(corrupted_reader.isValid(), false);
+        QCOMPARE(corrupted_reader.complete("th", 3).isEmpty(), true);
+
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        QCOMPARE(file.write(data), qint64(data.size()));
+        file.close();
+
+        Logic::DawgWordEngine engine;
+        QVERIFY(engine.loadDictionary(file.fileName()));
+        engine.setEnabled(true);
+        QCOMPARE(engine.isEnabled(), true);
+
+        QSignalSpy spy(&engine, SIGNAL(candidatesChanged(WordCandidateList)));
+        Model::Text text;
+        text.setPreedit("Teh");
+        engine.computeCandidates(&text);
+
+        QCOMPARE(spy.count(), 1);
+        const WordCandidateList candidates(spy.takeFirst().at(0).value<WordCandidateList>());
+        QCOMPARE(candidates.isEmpty(), false);
+        QCOMPARE(candidates.first().label().text(), QString("The"));
+        QCOMPARE(text.primaryCandidate(), QString("The"));
+    }
+
+    Q_SLOT void testContext()
+    {
+        Model::Text text;
+        QCOMPARE(text.context(), QStringList() << "");
+
+        text.setPreedit("Hello ");
+        text.commitPreedit();
+        QCOMPARE(text.context(), QStringList() << "" << "Hello");
+
+        text.setPreedit("world! ");
+        text.commitPreedit();
+        QCOMPARE(text.context(), QStringList() << "" << "Hello" << "world" << "");
+
+        // Only the last words are kept:
+        text.setPreedit("It's ");
+        text.commitPreedit();
+        text.setPreedit("me, ");
+        text.commitPreedit();
+        QCOMPARE(text.context(), QStringList() << "world" << "" << "It's" << "me");
+
+        text.setContext("One sentence. Two three four five six ");
+        QCOMPARE(text.context(), QStringList() << "three" << "four" << "five" << "six");
+
+        text.setContext("One sentence. Two three", 14);
+        QCOMPARE(text.context(), QStringList() << "");
+
+        text.setContext("One sentence. Two three", 17);
+        QCOMPARE(text.context(), QStringList() << "" << "Two");
+    }
+
+    Q_SLOT void testNgramModel()
+    {
+        Logic::NgramModelBuilder builder;
+        builder.addText("The cat sat on the mat. The cat ate.");
+        builder.addText("A dog sat on the cat.");
+        QCOMPARE(builder.wordCount(), 8);
+
+        const QByteArray data(builder.compile(1));
+        Logic::NgramModelReader reader(reinterpret_cast<const uchar *>(data.constData()), data.size());
+        QVERIFY2(reader.isValid(), qPrintable(reader.errorString()));
+        QCOMPARE(reader.wordCount(), 8);
+        QCOMPARE(reader.word(reader.wordId("dog")), QString("dog"));
+        QCOMPARE(reader.wordId("cow"), Logic::NgramModel::UnknownWord);
+
+        Model::Text text;
+        text.setContext("The dog sat on the ");
+        const QVector<quint32> context(reader.context(text.context()));
+        QCOMPARE(context.size(), 2);
+        QCOMPARE(context.at(0), reader.wordId("on"));
+        QCOMPARE(context.at(1), reader.wordId("the"));
+
+        QStringList predictions(reader.predict(context, QString(), 2));
+        QCOMPARE(predictions, QStringList() << "cat" << "mat");
+        QCOMPARE(reader.predict(context, "M", 3), QStringList() << "mat");
+
+        text.setContext("Hello. ");
+        const QVector<quint32> sentence_start(reader.context(text.context()));
+        QCOMPARE(sentence_start.size(), 1);
+        QCOMPARE(sentence_start.at(0), Logic::NgramModel::SentenceBoundary);
+        QCOMPARE(reader.predict(sentence_start, QString(), 1), QStringList() << "the");
+
+        QByteArray corrupted(data);
+        corrupted.chop(4);
+        Logic::NgramModelReader corrupted_reader(reinterpret_cast<const uchar *>(corrupted.constData()),
+                                                 corrupted.size());
+        QCOMPARE(corrupted_reader.isValid(), false);
+        QCOMPARE(corrupted_reader.predict(context, QString(), 2).isEmpty(), true);
+    }
+
+    Q_SLOT void testProximityCorrector()
+    {
+        const KeyArea key_area(createKeyArea());
+
+        Logic::ProximityCorrector corrector;
+        QCOMPARE(corrector.substitutionCost('h', 'j'), int(Logic::ProximityCorrector::EditCost));
+
+        corrector.setKeyArea(key_area);
+        QCOMPARE(corrector.substitutionCost('h', 'H'), 0);
+        QCOMPARE(corrector.substitutionCost('h', 'j'), 4);
+        QCOMPARE(corrector.substitutionCost('q', 'p'), int(Logic::ProximityCorrector::EditCost));
+        QCOMPARE(corrector.substitutionCost('h', '!'), int(Logic::ProximityCorrector::EditCost));
+
+        // More candidates than fit into one batch, of different lengths:
+        const QStringList candidates(QStringList() << "the" << "tje" << "" << "t" << "them"
+                                                   << "tjex" << "toe" << "tqe" << "the" << "THE");
+        const QVector<int> distances(corrector.distances("tje", candidates));
+        QCOMPARE(distances, QVector<int>() << 4 << 0 << 24 << 16 << 12 << 8 << 7 << 8 << 4 << 4);
+    }
+
+    Q_SLOT void testSwipeDecoder()
+    {
+        QHash<QString, quint32> frequencies;
+        frequencies.insert("the", 100);
+        frequencies.insert("they", 50);
+        frequencies.insert("tie", 40);
+        frequencies.insert("toe", 10);
+        frequencies.insert("tee", 5);
+
+        const QByteArray data(Logic::Dawg::compile(frequencies));
+        Logic::DawgReader reader(reinterpret_cast<const uchar *>(data.constData()), data.size());
+        QVERIFY(reader.isValid());
+
+        const KeyArea key_area(createKeyArea());
+        QVector<QPointF> path;
+        const QString keys("the");
+
+        for (int index = 1; index < keys.length(); ++index) {
+            const QPointF from(keyCenter(key_area, keys.at(index - 1)));
+            const QPointF to(keyCenter(key_area, keys.at(index)));
+
+            for (int step = 0; step < 10; ++step) {
+                path.append(from + (to - from) * step / 10);
+            }
+        }
+
+        path.append(keyCenter(key_area, keys.at(keys.length() - 1)));
+
+        Logic::SwipeDecoder decoder;
+        QCOMPARE(decoder.decode(reader, path, 3).isEmpty(), true);
+
+        decoder.setKeyArea(key_area);
+        const QStringList words(decoder.decode(reader, path, 3));
+        QCOMPARE(words.isEmpty(), false);
+        QCOMPARE(words.first(), QString("the"));
+        QCOMPARE(words.contains("they"), false);
+
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        QCOMPARE(file.write(data), qint64(data.size()));
+        file.close();
+
+        // Engines without a decoder must not get swipes:
+        QCOMPARE(BackendWordEngine().supportsSwipe(), false);
+
+        Logic::DawgWordEngine engine;
+        QVERIFY(engine.supportsSwipe());
+        QVERIFY(engine.loadDictionary(file.fileName()));
+        engine.setEnabled(true);
+        engine.setKeyArea(key_area);
+
+        QSignalSpy spy(&engine, SIGNAL(candidatesChanged(WordCandidateList)));
+        Model::Text text;
+        engine.computeSwipeCandidates(&text, path);
+
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(text.preedit(), QString("the"));
+        QCOMPARE(text.primaryCandidate(), QString("the"));
+    }
+
+    Q_SLOT void testConversion()
+    {
+        QHash<QString, QHash<QString, quint32> > frequencies;
+        frequencies["ni"].insert(QString::fromUtf8("你"), 1000);
+        frequencies["ni"].insert(QString::fromUtf8("泥"), 100);
+        frequencies["hao"].insert(QString::fromUtf8("好"), 1000);
+        frequencies["hao"].insert(QString::fromUtf8("号"), 200);
+        frequencies["nihao"].insert(QString::fromUtf8("你好"), 2000);
+        frequencies["ma"].insert(QString::fromUtf8("吗"), 500);
+        frequencies["zhong"].insert(QString::fromUtf8("中"), 300);
+        frequencies["zhongguo"].insert(QString::fromUtf8("中国"), 800);
+        frequencies["guo"].insert(QString::fromUtf8("国"), 300);
+
+        const QByteArray data(Logic::ChineseLexicon::compile(frequencies));
+        Logic::ChineseLexiconReader reader(reinterpret_cast<const uchar *>(data.constData()), data.size());
+        QVERIFY(reader.isValid());
+        QCOMPARE(reader.codeCount(), 7);
+        QCOMPARE(reader.maxCodeLength(), 8);
+
+        const QString nihao("nihao");
+        const int code(reader.findCode(nihao.constData(), nihao.length()));
+        QVERIFY(code >= 0);
+        QCOMPARE(reader.codeText(code), nihao);
+        QCOMPARE(reader.entryText(reader.firstEntry(code)), QString::fromUtf8("你好"));
+        QCOMPARE(reader.findCode(nihao.constData(), 3), -1);
+
+        // Typing one unit at a time only computes the new positions:
+        Logic::ConversionLattice lattice;
+
+        for (int length = 1; length <= nihao.length(); ++length) {
+            lattice.setInput(&reader, nihao.left(length));
+        }
+
+        QCOMPARE(lattice.computedPositions(), 5);
+        QCOMPARE(lattice.conversion(), QString::fromUtf8("你好"));
+        QCOMPARE(lattice.candidates(3), QStringList() << QString::fromUtf8("你好")
+                                                      << QString::fromUtf8("你号"));
+
+        lattice.setInput(&reader, "nihaoma");
+        QCOMPARE(lattice.computedPositions(), 7);
+        QCOMPARE(lattice.conversion(), QString::fromUtf8("你好吗"));
+
+        lattice.setInput(&reader, "nihaom");
+        QCOMPARE(lattice.computedPositions(), 7);
+
+        // Partially typed input codes are completed:
+        lattice.setInput(&reader, "zhongg");
+        QCOMPARE(lattice.conversion(), QString::fromUtf8("中g"));
+        QCOMPARE(lattice.candidates(2), QStringList() << QString::fromUtf8("中国")
+                                                      << QString::fromUtf8("中g"));
+
+        QCOMPARE(Logic::ChineseWordEngine::lexiconFile("en_gb").isEmpty(), true);
+        QCOMPARE(Logic::ChineseWordEngine::lexiconFile("zh@pinyin").endsWith("/dictionaries/zh_pinyin.lexicon"), true);
+
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        QCOMPARE(file.write(data), qint64(data.size()));
+        file.close();
+
+        Logic::ChineseWordEngine engine;
+        engine.setEnabled(true);
+        QCOMPARE(engine.isEnabled(), false);
+
+        QVERIFY(engine.loadLexicon(file.fileName()));
+        engine.setEnabled(true);
+        QCOMPARE(engine.isEnabled(), true);
+
+        QSignalSpy spy(&engine, SIGNAL(candidatesChanged(WordCandidateList)));
+        Model::Text text;
+        text.setPreedit("nihao");
+        engine.computeCandidates(&text);
+
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(text.primaryCandidate(), QString::fromUtf8("你好"));
+        QCOMPARE(text.preeditFace(), Model::Text::PreeditActive);
+
+        engine.setActiveLanguage("en_gb");
+        QCOMPARE(engine.isEnabled(), false);
+        QCOMPARE(engine.hasLexicon(), false);
+    }
+
+    Q_SLOT void testFindDictionary()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QStringList files(QStringList() << "de_AT.aff" << "de_AT.dic" << "de_CH.aff" << "de_CH.dic"
+                                              << "en_GB.aff" << "en_GB.dic" << "en_US.aff" << "fr_FR.dic");
+
+        Q_FOREACH (const QString &name, files) {
+            QFile file(dir.path() + "/" + name);
+            QVERIFY(file.open(QIODevice::WriteOnly));
+        }
+
+        QCOMPARE(Logic::SpellChecker::findDictionary("en_gb", dir.path()), dir.path() + "/en_GB");
+        // Incomplete dictionaries are skipped:
+        QCOMPARE(Logic::SpellChecker::findDictionary("en_us", dir.path()), dir.path() + "/en_GB");
+        QCOMPARE(Logic::SpellChecker::findDictionary("de", dir.path()), dir.path() + "/de_AT");
+        QCOMPARE(Logic::SpellChecker::findDictionary("de_CH", dir.path()), dir.path() + "/de_CH");
+        QCOMPARE(Logic::SpellChecker::findDictionary("fr", dir.path()), QString());
+        QCOMPARE(Logic::SpellChecker::findDictionary("zh@pinyin", dir.path()), QString());
+    }
+
+    Q_SLOT void testSpellCheckerCache()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        Logic::SpellChecker checker(writeDictionary(dir.path()), dir.path() + "/userwords.txt");
+
+        if (checker.spell("maliit")) {
+            QSKIP("Spell checking is disabled, built without Hunspell?");
+        }
+
+        Logic::SpellChecker::CacheStatistics statistics(checker.cacheStatistics());
+        QCOMPARE(statistics.spell_hits, 0);
+        QCOMPARE(statistics.spell_misses, 1);
+
+        // Repeated checks are served from the cache:
+        QCOMPARE(checker.spell("maliit"), false);
+        QCOMPARE(checker.spell("hello"), true);
+        QCOMPARE(checker.spell("hello"), true);
+        statistics = checker.cacheStatistics();
+        QCOMPARE(statistics.spell_hits, 2);
+        QCOMPARE(statistics.spell_misses, 2);
+
+        const QStringList suggestions(checker.suggest("helo"));
+        QVERIFY(suggestions.count() > 1);
+        QCOMPARE(checker.suggest("helo"), suggestions);
+        statistics = checker.cacheStatistics();
+        QCOMPARE(statistics.suggest_hits, 1);
+        QCOMPARE(statistics.suggest_misses, 1);
+
+        // The limit applies to the cached, unlimited suggestions:
+        QCOMPARE(checker.suggest("helo", 1), suggestions.mid(0, 1));
+        QCOMPARE(checker.cacheStatistics().suggest_hits, 2);
+
+        // New user words drop cached verdicts:
+        checker.addToUserWordlist("maliit");
+        QCOMPARE(checker.spell("maliit"), true);
+        statistics = checker.cacheStatistics();
+        QCOMPARE(statistics.spell_misses, 3);
+
+        QCOMPARE(checker.suggest("helo"), suggestions);
+        QCOMPARE(checker.cacheStatistics().suggest_misses, 2);
+
+        // So do ignored words:
+        QCOMPARE(checker.spell("hello"), true);
+        QCOMPARE(checker.cacheStatistics().spell_misses, 4);
+        checker.ignoreWord("wrld");
+        QCOMPARE(checker.spell("wrld"), true);
+        QCOMPARE(checker.spell("hello"), true);
+        statistics = checker.cacheStatistics();
+        QCOMPARE(statistics.spell_hits, 2);
+        QCOMPARE(statistics.spell_misses, 5);
+    }
+
+    Q_SLOT void testSpellCheckerDeadline()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        Logic::SpellChecker checker(writeDictionary(dir.path()), dir.path() + "/userwords.txt");
+
+        if (checker.spell("helo")) {
+            QSKIP("Spell checking is disabled, built without Hunspell?");
+        }
+
+        // Without deadline, suggestions are computed right away:
+        QVERIFY(checker.suggest("wrld").contains("world"));
+
+        // A deadline of 0 does not wait for the worker:
+        QCOMPARE(checker.suggest("helo", -1, 0), QStringList());
+        QCOMPARE(checker.cacheStatistics().suggest_timeouts, 1);
+
+        // The late result still gets cached, for the next call:
+        checker.waitForSuggestions();
+        const Logic::SpellChecker::CacheStatistics before(checker.cacheStatistics());
+        QVERIFY(checker.suggest("helo", -1, 0).contains("hello"));
+        QCOMPARE(checker.cacheStatistics().suggest_hits, before.suggest_hits + 1);
+        QCOMPARE(checker.cacheStatistics().suggest_timeouts, 1);
+
+        // Deadlines that are met return the suggestions:
+        QVERIFY(checker.suggest("hepl", -1, 5000).contains("help"));
+    }
+
+    Q_SLOT void testUserDictionary()
+    {
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        // Files of older versions are unsorted snapshots:
+        const QString file_name(dir.path() + "/maliit/userwords.txt");
+        QVERIFY(QDir().mkpath(QFileInfo(file_name).absolutePath()));
+        QFile file(file_name);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("hello\r\nabc\nhello\n");
+        file.close();
+
+        {
+            Logic::UserDictionary dictionary(file_name);
+            QCOMPARE(dictionary.load(), QStringList() << "hello" << "abc" << "hello");
+
+            dictionary.append("z\xc3\xbcrich");
+            dictionary.append("abc");
+            dictionary.flush();
+            QVERIFY(QFile::exists(dictionary.journalFileName()));
+        }
+
+        Logic::UserDictionary dictionary(file_name);
+        QCOMPARE(dictionary.load(), QStringList() << "hello" << "abc" << "hello"
+                                                  << QString::fromUtf8("z\xc3\xbcrich") << "abc");
+
+        dictionary.compact();
+        QVERIFY(not QFile::exists(dictionary.journalFileName()));
+        QCOMPARE(dictionary.load(), QStringList() << "abc" << "hello" << QString::fromUtf8("z\xc3\xbcrich"));
+
+        // Long journals get compacted by the writer:
+        for (int index = 0; index < Logic::UserDictionary::CompactionThreshold; ++index) {
+            dictionary.append(QString("word%1").arg(index));
+        }
+
+        dictionary.flush();
+        QVERIFY(not QFile::exists(dictionary.journalFileName()));
+        QCOMPARE(dictionary.load().count(), 3 + Logic::UserDictionary::CompactionThreshold);
+
+        // Instances for the same file share their writer, so compactions
+        // keep the words journaled through another instance:
+        {
+            Logic::UserDictionary other(file_name);
+            other.append("shared");
+            dictionary.compact();
+            QVERIFY(not QFile::exists(dictionary.journalFileName()));
+        }
+
+        QVERIFY(dictionary.load().contains("shared"));
+    }
+
+    Q_SLOT void testAddressIndex()
+    {
+        QCOMPARE(Logic::AddressIndex::kind("https://maliit.org/wiki"), Logic::AddressIndex::WebAddress);
+        QCOMPARE(Logic::AddressIndex::kind("Someone@Example.com"), Logic::AddressIndex::EmailAddress);
+        QCOMPARE(Logic::AddressIndex::kind("hello"), Logic::AddressIndex::NoAddress);
+        QCOMPARE(Logic::AddressIndex::kind("the end."), Logic::AddressIndex::NoAddress);
+        QCOMPARE(Logic::AddressIndex::hostName("https://me@www.maliit.org:8080/wiki?page=1"),
+                 QString("www.maliit.org"));
+        QCOMPARE(Logic::AddressIndex::hostName("Someone@Example.com"), QString("example.com"));
+
+        QTemporaryDir dir;
+        QVERIFY(dir.isValid());
+
+        const QString file_name(dir.path() + "/maliit/addresses.idx");
+        const QDateTime now(QDateTime::currentDateTimeUtc());
+        const int web_kinds(Logic::AddressIndex::WebAddress | Logic::AddressIndex::HostName);
+
+        {
+            Logic::AddressIndex index(file_name);
+            index.learn("https://maliit.org/wiki", now);
+            index.learn("https://maliit.org/wiki", now);
+            index.learn("someone@example.com", now);
+            index.learn("old.example.org", now.addDays(-365));
+
+            // Uses of two months ago count a quarter:
+            for (int count = 0; count < 3; ++count) {
+                index.learn("Mail.Example.com", now.addDays(-60));
+            }
+
+            QCOMPARE(index.count(), 6);
+            QCOMPARE(index.complete("MA", web_kinds, 5, now), QStringList() << "maliit.org" << "mail.example.com");
+            QCOMPARE(index.complete("ma", web_kinds, 1, now.addDays(-60)), QStringList() << "mail.example.com");
+            QCOMPARE(index.complete("https://m", web_kinds, 5, now), QStringList() << "https://maliit.org/wiki");
+            QCOMPARE(index.complete("some", Logic::AddressIndex::EmailAddress, 5, now),
+                     QStringList() << "someone@example.com");
+            QCOMPARE(index.complete("ex", Logic::AddressIndex::HostName, 5, now), QStringList() << "example.com");
+        }
+
+        // Rarely used entries do not survive compaction:
+        QVERIFY(QFile::exists(file_name));
+        Logic::AddressIndex index(file_name);
+        QCOMPARE(index.count(), 5);
+        QCOMPARE(index.complete("ma", web_kinds, 5, now), QStringList() << "maliit.org" << "mail.example.com");
+
+        // Learned entries shadow the stored ones:
+        for (int count = 0; count < 2; ++count) {
+            index.learn("mail.example.com", now);
+        }
+
+        QCOMPARE(index.complete("ma", web_kinds, 5, now), QStringList() << "mail.example.com" << "maliit.org");
+        QCOMPARE(index.count(), 5);
+
+        // Compactions run on the writer, learned entries stay visible:
+        for (int count = 0; count < Logic::AddressIndex::CompactionThreshold; ++count) {
+            index.learn(QString("host%1.example.net").arg(count), now);
+        }
+
+        QCOMPARE(index.complete("host0.", web_kinds, 5, now), QStringList() << "host0.example.net");
+        index.flush();
+        QCOMPARE(index.count(), 5 + Logic::AddressIndex::CompactionThreshold);
+        QCOMPARE(index.complete("ma", web_kinds, 5, now), QStringList() << "mail.example.com" << "maliit.org");
+    }
+
     Q_SLOT void testWordRibbonVisible()
     {
         Editor editor(new Model::Text, new Logic::WordEngineProbe, new Logic::LanguageFeatures);
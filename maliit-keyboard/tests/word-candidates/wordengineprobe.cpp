@@ -46,7 +46,9 @@ WordEngineProbe::WordEngineProbe(QObject *parent)
 
 
 WordEngineProbe::~WordEngineProbe()
-{}
+{
+    waitForCandidates();
+}
 
 
 //! \brief Returns new candidates.
@@ -0,0 +1,122 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+// Compiles word lists into a DAWG dictionary that can be memory mapped by
+// the keyboard, see lib/logic/dawg.h.
+//
+// Word lists are UTF-8 text files with one word per line, optionally
+// followed by whitespace and a frequency. Words without frequency count as
+// 1, frequencies of words listed several times are summed up. Empty lines
+// and lines starting with '#' are ignored.
+//
+// Usage: maliit-keyboard-build-dawg output.dawg wordlist.txt...
+
+#include "logic/dawg.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHash>
+#include <QRegExp>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QDebug>
+
+using namespace MaliitKeyboard;
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments(app.arguments());
+
+    arguments.removeFirst();
+    if (arguments.size() < 2) {
+        qWarning("Usage: maliit-keyboard-build-dawg output.dawg wordlist.txt...");
+        return 1;
+    }
+
+    const QString output_path(arguments.takeFirst());
+    const QRegExp separator("\\s+");
+    QHash<QString, quint32> frequencies;
+
+    Q_FOREACH (const QString &path, arguments) {
+        QFile file(path);
+
+        if (not file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning() << "Could not open file:" << path;
+            return 1;
+        }
+
+        QTextStream stream(&file);
+        stream.setCodec("UTF-8");
+        int line_number(0);
+
+        while (not stream.atEnd()) {
+            const QString line(stream.readLine().trimmed());
+            ++line_number;
+
+            if (line.isEmpty() or line.startsWith('#')) {
+                continue;
+            }
+
+            const QStringList fields(line.split(separator));
+            quint32 frequency(1);
+
+            if (fields.size() > 1) {
+                bool ok(false);
+                frequency = fields.at(1).toUInt(&ok);
+
+                if (not ok) {
+                    qWarning() << "Skipping" << path << "line" << line_number << "- invalid frequency:" << fields.at(1);
+                    continue;
+                }
+            }
+
+            quint32 &total(frequencies[fields.first()]);
+            total = (total > 0xffffffffu - frequency ? 0xffffffffu : total + frequency);
+        }
+    }
+
+    QSaveFile output(output_path);
+
+    if (not output.open(QIODevice::WriteOnly)
+        or output.write(Logic::Dawg::compile(frequencies)) < 0
+        or not output.commit()) {
+        qWarning() << "Could not write file:" << output_path;
+        return 1;
+    }
+
+    qDebug("Compiled %d words.", frequencies.size());
+    return 0;
+}
@@ -0,0 +1,118 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+// Compiles plain text corpora into a trigram language model that can be
+// memory mapped by the keyboard, see lib/logic/ngrammodel.h.
+//
+// Corpora are UTF-8 text files. Sentences end at '.', '!' or '?', at empty
+// lines and at the end of each file. Bi- and trigrams seen less than
+// min_count times (default: 1) are left out of the model.
+//
+// Usage: maliit-keyboard-build-ngram [--min-count N] output.ngram corpus.txt...
+
+#include "logic/ngrammodel.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QSaveFile>
+#include <QStringList>
+#include <QTextStream>
+#include <QDebug>
+
+using namespace MaliitKeyboard;
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments(app.arguments());
+    quint32 min_count(1);
+
+    arguments.removeFirst();
+    if (arguments.size() >= 2 and arguments.first() == "--min-count") {
+        bool ok(false);
+        min_count = arguments.at(1).toUInt(&ok);
+
+        if (not ok) {
+            qWarning() << "Invalid minimal count:" << arguments.at(1);
+            return 1;
+        }
+
+        arguments.removeFirst();
+        arguments.removeFirst();
+    }
+
+    if (arguments.size() < 2) {
+        qWarning("Usage: maliit-keyboard-build-ngram [--min-count N] output.ngram corpus.txt...");
+        return 1;
+    }
+
+    const QString output_path(arguments.takeFirst());
+    Logic::NgramModelBuilder builder;
+
+    Q_FOREACH (const QString &path, arguments) {
+        QFile file(path);
+
+        if (not file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            qWarning() << "Could not open file:" << path;
+            return 1;
+        }
+
+        QTextStream stream(&file);
+        stream.setCodec("UTF-8");
+
+        while (not stream.atEnd()) {
+            const QString line(stream.readLine());
+
+            if (line.trimmed().isEmpty()) {
+                builder.endSentence();
+            } else {
+                builder.addText(line);
+            }
+        }
+
+        builder.endSentence();
+    }
+
+    QSaveFile output(output_path);
+
+    if (not output.open(QIODevice::WriteOnly)
+        or output.write(builder.compile(min_count)) < 0
+        or not output.commit()) {
+        qWarning() << "Could not write file:" << output_path;
+        return 1;
+    }
+
+    qDebug("Compiled %d words.", builder.wordCount());
+    return 0;
+}
@@ -0,0 +1,104 @@
+// -*- mode: C++; c-basic-offset: 4; indent-tabs-mode: nil; c-file-offsets: ((innamespace . 0)); -*-
+/*
+ * This file is part of Maliit Plugins
+ *
+ * Copyright (C) 2012-2013 Canonical Ltd
+ *
+ * Contact: maliit-discuss@lists.maliit.org
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * Redistributions of source code must retain the above copyright notice, this list
+ * of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list
+ * of conditions and the following disclaimer in the documentation and/or other materials
+ * provided with the distribution.
+ * Neither the name of Nokia Corporation nor the names of its contributors may be
+ * used to endorse or promote products derived from this software without specific
+ * prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL
+ * THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// Compiles language layout files into binary blobs that can be memory mapped
+// by the keyboard instead of being parsed at runtime.
+//
+// Usage: maliit-keyboard-compile-layouts output_dir layout.xml...
+
+#include "parser/layoutparser.h"
+#include "parser/layoutblob.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDebug>
+
+using namespace MaliitKeyboard;
+
+int main(int argc,
+         char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QStringList arguments(app.arguments());
+
+    arguments.removeFirst();
+    if (arguments.size() < 2) {
+        qWarning("Usage: maliit-keyboard-compile-layouts output_dir layout.xml...");
+        return 1;
+    }
+
+    const QString output_dir(arguments.takeFirst());
+
+    if (not QDir().mkpath(output_dir)) {
+        qWarning() << "Could not create output directory:" << output_dir;
+        return 1;
+    }
+
+    int compiled(0);
+
+    Q_FOREACH (const QString &path, arguments) {
+        QFile file(path);
+
+        if (not file.open(QIODevice::ReadOnly)) {
+            qWarning() << "Could not open file:" << path;
+            return 1;
+        }
+
+        LayoutParser parser(&file);
+
+        // Layouts which cannot be parsed are skipped, the keyboard will fall
+        // back to the XML file and report the error at runtime.
+        if (not parser.parse()) {
+            qWarning() << "Skipping" << path << "- could not parse file, error:" << parser.errorString();
+            continue;
+        }
+
+        const QString output_path(output_dir + "/" + QFileInfo(path).completeBaseName()
+                                  + LayoutBlob::fileSuffix());
+        QSaveFile output(output_path);
+
+        if (not output.open(QIODevice::WriteOnly)
+            or output.write(LayoutBlob::compile(parser)) < 0
+            or not output.commit()) {
+            qWarning() << "Could not write file:" << output_path;
+            return 1;
+        }
+
+        ++compiled;
+    }
+
+    qDebug("Compiled %d of %d layout files.", compiled, arguments.size());
+    return 0;
+}